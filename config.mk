@@ -29,6 +29,50 @@ SIZE=$(GCC_PATH)/arm-none-eabi-size
 STRIP=$(GCC_PATH)/arm-none-eabi-strip
 READELF=$(GCC_PATH)/arm-none-eabi-readelf
 
+# Compiler for tools and benchmarks that run on the host
+HOST_CC=g++
+HOST_FLAGS=-std=c++17 -O2 -Wall
+
+# Set to 1 to time calls to bluenet, interrupt handlers and loop, see include/Profiler.h
+PROFILING=0
+
+# Set to 1 to be able to send calls to bluenet in batches, see beginBatch() in include/microapp.h
+BATCHING=0
+
+# Set to 1 to be able to defer low priority calls to the next tick, see reserveCallsPerTick() in include/microapp.h
+DEFERRED_CALLS=0
+
+# Set to 1 to be able to defer interrupts to the main loop, see deferInterrupts() in include/microapp.h
+DEFERRED_INTERRUPTS=0
+
+# Set to 1 to record the messages between microapp and bluenet, see include/Trace.h
+TRACING=0
+
+# Set to 1 to keep scans in a queue until they are polled with BLE.available(), see include/BleScanQueue.h.
+# Otherwise, only the last scan is kept.
+BLE_SCAN_QUEUE=0
+
+# Set to 1 to drop duplicate advertisements when scanning without duplicates, see BLE.setDuplicateFilter().
+# Note that BLE.scan() scans without duplicates by default.
+BLE_DUPLICATE_FILTER=0
+
+# Set to 1 to track the presence of scanned devices by their filtered RSSI, see BLE.trackDevices()
+BLE_DEVICE_TRACKER=0
+
+# Set to 1 to be able to merge advertisements with their scan response, see BLE.mergeScanResponses(). This doubles
+# MAX_BLE_SCAN_DATA_LENGTH, and so the RAM of every copy of scan data.
+BLE_MERGE_SCAN_RESPONSES=0
+
+# Set to 1 to keep every discovered service and characteristic of a peripheral, see BleDevice::attribute().
+BLE_ATTRIBUTE_POOL=0
+
+# CSV file with MAC addresses to generate the table of the allowlist from, see include/BleMacAllowlist.h
+# The size of its Bloom filter is generated too, set MAC_ALLOWLIST_BLOOM_BYTES to override it.
+MAC_ALLOWLIST_CSV=
+
+# RAM budget of the Bloom filter of the allowlist in bytes, out of the 4 kB of RAM of the microapp
+MAC_ALLOWLIST_BLOOM_MAX_BYTES=256
+
 # The build directory
 BUILD_PATH=build
 
@@ -0,0 +1,41 @@
+#include <Arduino.h>
+
+/**
+ * Test batches: build with `make BATCHING=1`.
+ * Makes more calls in setup than fit in a tick, and sets all LEDs with a single call every loop.
+ */
+
+const uint8_t CALL_LIMIT = 8;
+
+const uint8_t LED_PINS[] = {LED1_PIN, LED2_PIN, LED3_PIN};
+
+void setup() {
+	Serial.println("Batch test");
+
+	for (uint8_t i = 0; i < sizeof(LED_PINS); i++) {
+		pinMode(LED_PINS[i], OUTPUT);
+	}
+
+	// Make more calls than are allowed in a tick, but send them as one batch
+	beginBatch();
+	for (int i = 0; i <= CALL_LIMIT; i++) {
+		Serial.println(i);
+	}
+	microapp_sdk_result_t result = commitBatch();
+	Serial.print("Batch of ");
+	Serial.print(batchSize());
+	Serial.print(" calls, result ");
+	Serial.println((int)result);
+}
+
+int counter = 0;
+
+void loop() {
+	// Set all LEDs in the same roundtrip
+	beginBatch();
+	for (uint8_t i = 0; i < sizeof(LED_PINS); i++) {
+		digitalWrite(LED_PINS[i], (counter >> i) & 1);
+	}
+	commitBatch();
+	counter++;
+}
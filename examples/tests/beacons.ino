@@ -0,0 +1,60 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+#include <BleBeacon.h>
+
+/**
+ * Test the beacon decoders: every scan is classified in a single pass, and only the decoded fields are handled.
+ */
+
+struct BeaconHandler {
+	void operator()(const ble_ibeacon_t& beacon) {
+		Serial.print("iBeacon major: ");
+		Serial.print(beacon.major);
+		Serial.print(" minor: ");
+		Serial.println(beacon.minor);
+	}
+
+	void operator()(const ble_eddystone_uid_t& beacon) {
+		Serial.print("Eddystone UID instance: ");
+		Serial.println(beacon.instanceId[5]);
+	}
+
+	void operator()(const ble_eddystone_tlm_t& beacon) {
+		Serial.print("Eddystone TLM battery: ");
+		Serial.println(beacon.batteryMv);
+	}
+
+	void operator()(const ble_thermometer_t& thermometer) {
+		Serial.print("Thermometer temperature: ");
+		Serial.print(thermometer.temperature);
+		Serial.print(" humidity: ");
+		Serial.println(thermometer.humidity);
+	}
+};
+
+typedef BeaconDispatcher<
+		IBeaconDecoder,
+		EddystoneUidDecoder,
+		EddystoneTlmDecoder,
+		AtcThermometerDecoder,
+		PvvxThermometerDecoder>
+		Beacons;
+
+BeaconHandler beaconHandler;
+
+void onScannedView(BleScanView& view) {
+	if (Beacons::dispatch(view.data(), view.size(), beaconHandler) == 0) {
+		Serial.print("Unknown: ");
+		Serial.println(view.address());
+	}
+}
+
+void setup() {
+	Serial.println("Beacons test");
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScannedView, onScannedView);
+	BLE.scan(true);
+}
+
+void loop() {}
@@ -0,0 +1,89 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * A microapp example with the crownstone as a BLE central, using non-blocking requests.
+ * The loop keeps running while connecting and reading, instead of blocking until bluenet returns the result.
+ */
+
+const char* peripheralAddress = "A4:C1:38:9A:45:E3";
+
+BleDevice* peripheral = nullptr;
+BleFuture connectFuture;
+BleFuture readFuture;
+uint8_t buffer[2];
+uint8_t readCounter = 0;
+
+void onRead(microapp_sdk_result_t result) {
+	Serial.print("   Microapp read callback with result ");
+	Serial.println((int)result);
+}
+
+// Start over with scanning for the peripheral
+void reset() {
+	peripheral    = nullptr;
+	connectFuture = BleFuture();
+	readFuture    = BleFuture();
+	readCounter   = 0;
+}
+
+// The Arduino setup function.
+void setup() {
+	Serial.println("   BLE central async example");
+
+	if (!BLE.begin()) {
+		Serial.println("   BLE.begin failed");
+		return;
+	}
+	BLE.scanForAddress(peripheralAddress);
+	Serial.println("   End of setup");
+}
+
+// The Arduino loop function.
+void loop() {
+	if (peripheral == nullptr) {
+		// Poll for scanned devices
+		BleDevice& device = BLE.available();
+		if (!device) {
+			return;
+		}
+		Serial.println("   Peripheral available:");
+		Serial.println(device.address());
+		peripheral    = &device;
+		connectFuture = peripheral->connectAsync();
+		return;
+	}
+	if (!connectFuture.ready()) {
+		// Still connecting, meanwhile the loop can do other things
+		return;
+	}
+	if (!peripheral->connected()) {
+		Serial.println("   Not connected");
+		reset();
+		return;
+	}
+	// We are looking for service with uuid 181A 'Environmental Sensing'
+	if (!peripheral->discoverService("181A") || !peripheral->hasCharacteristic("2A1F")) {
+		Serial.println("   No temperature char found");
+		peripheral->disconnect();
+		reset();
+		return;
+	}
+	if (!readFuture.ready()) {
+		// Still reading
+		return;
+	}
+	if (readFuture.result() == CS_MICROAPP_SDK_ACK_SUCCESS) {
+		Serial.println(buffer, 2);
+		// Disconnect after 10 reads
+		if (readCounter++ > 10) {
+			Serial.println("   Attempting disconnect");
+			peripheral->disconnect();
+			reset();
+			return;
+		}
+	}
+	BleCharacteristic& temperatureCharacteristic = peripheral->characteristic("2A1F");
+	readFuture                                   = temperatureCharacteristic.readValueAsync(buffer, sizeof(buffer));
+	readFuture.onComplete(onRead);
+}
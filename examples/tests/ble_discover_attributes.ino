@@ -0,0 +1,61 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * A microapp example that connects to a peripheral, and lists all its services and characteristics after a single
+ * discovery: build with `make BLE_ATTRIBUTE_POOL=1`.
+ */
+
+const char* peripheralAddress = "A4:C1:38:9A:45:E3";
+
+// The Arduino setup function.
+void setup() {
+	Serial.println("   BLE discover attributes example");
+
+	if (!BLE.begin()) {
+		Serial.println("   BLE.begin failed");
+		return;
+	}
+	BLE.scanForAddress(peripheralAddress);
+	Serial.println("   End of setup");
+}
+
+// The Arduino loop function.
+void loop() {
+	// Poll for scanned devices
+	BleDevice& peripheral = BLE.available();
+
+	if (!peripheral) {
+		return;
+	}
+
+	Serial.println("   Peripheral available:");
+	Serial.println(peripheral.address());
+	// Try to connect
+	if (!peripheral.connect(10000)) {
+		Serial.println("   Connecting failed");
+		return;
+	}
+	if (!peripheral.discoverAttributes()) {
+		Serial.println("   Discovery failed");
+		peripheral.disconnect();
+		return;
+	}
+	// Print the services with their handle range, and the characteristics with their value and CCCD handle
+	for (uint8_t i = 0; i < peripheral.attributeCount(); i++) {
+		const ble_attribute_t* attribute = peripheral.attribute(i);
+		bool isService                   = (attribute->service == i);
+		Serial.print(isService ? "   Service " : "      Characteristic ");
+		Serial.print(Uuid(attribute->uuid.uuid, attribute->uuid.type).string());
+		Serial.print(" handles ");
+		Serial.print(attribute->handle);
+		Serial.print(isService ? " to " : " cccd ");
+		Serial.print(attribute->endHandle);
+		if (!isService) {
+			Serial.print(" properties ");
+			Serial.print(attribute->properties);
+		}
+		Serial.println("");
+	}
+	peripheral.disconnect();
+}
@@ -26,11 +26,11 @@ void onScannedDevice(BleDevice& device) {
 	Serial.println(device.address().c_str());
 	Serial.println(device.rssi());
 
-	// parse service data of beacon advertisement if available
-	ble_ad_t serviceData;
-	if (device.findAdvertisementDataType(GapAdvType::ServiceData16BitUuid, &serviceData)) {
-		if (serviceData.len == 15) { // service data length of the ATC service data advertisements
-			uint16_t temperature = (serviceData.data[8] << 8) | serviceData.data[9];
+	// parse environmental sensing service data of beacon advertisement if available
+	ble_service_data_t serviceData;
+	if (device.findServiceData(0x181A, &serviceData)) {
+		if (serviceData.len == 13) { // service data length of the ATC service data advertisements
+			uint16_t temperature = (serviceData.data[6] << 8) | serviceData.data[7];
 			Serial.println(temperature);
 		}
 	}
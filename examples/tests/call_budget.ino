@@ -0,0 +1,28 @@
+#include <Arduino.h>
+#include <CrownstoneSwitch.h>
+
+/**
+ * Test the call budget per tick: build with `make DEFERRED_CALLS=1`.
+ * Logs should be deferred, so that switching is never throttled.
+ */
+
+const uint8_t RESERVED_CALLS = 2;
+
+void setup() {
+	Serial.println("Call budget test");
+	reserveCallsPerTick(RESERVED_CALLS);
+}
+
+void loop() {
+	// Make more logs than are allowed in a tick
+	for (int i = 0; i < MAX_CALLS_PER_TICK; i++) {
+		Serial.println(i);
+	}
+	Serial.println((int)deferredCallCount());
+	// These calls use the reserved calls, and are made in this tick
+	CrownstoneSwitch.toggle();
+	CrownstoneSwitch.toggle();
+	if (remainingCallsThisTick() != 0) {
+		Serial.println("Unexpected number of remaining calls");
+	}
+}
@@ -0,0 +1,44 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+#include <Mesh.h>
+
+/**
+ * Test deferred interrupts: build with `make DEFERRED_INTERRUPTS=1`.
+ * Scans and mesh messages are queued, and handled at the start of each tick.
+ * The number of handled and dropped interrupts is printed every loop.
+ */
+
+uint16_t scanCount = 0;
+uint16_t meshCount = 0;
+
+void onScannedDevice(BleDevice& device) {
+	scanCount++;
+}
+
+void onMeshMsg(MeshMsg msg) {
+	meshCount++;
+}
+
+void setup() {
+	Serial.println("Deferred interrupts test");
+
+	deferInterrupts(CS_MICROAPP_SDK_TYPE_BLE, 16);
+	deferInterrupts(CS_MICROAPP_SDK_TYPE_MESH, 4);
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+	BLE.scan(true);
+	Mesh.setIncomingMeshMsgHandler(onMeshMsg);
+	Mesh.listen();
+}
+
+void loop() {
+	Serial.print("Scans: ");
+	Serial.print(scanCount);
+	Serial.print(" dropped: ");
+	Serial.println(droppedInterruptCount(CS_MICROAPP_SDK_TYPE_BLE));
+	Serial.print("Mesh messages: ");
+	Serial.print(meshCount);
+	Serial.print(" dropped: ");
+	Serial.println(droppedInterruptCount(CS_MICROAPP_SDK_TYPE_MESH));
+}
@@ -0,0 +1,42 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test the device tracker: build with `make BLE_DEVICE_TRACKER=1`.
+ * Devices enter when they are near, and leave when they move away or are not seen anymore.
+ */
+
+void onPresence(const ble_tracked_device_t& device, BleTrackerTransition transition) {
+	MacAddress address(device.address, MAC_ADDRESS_LENGTH, device.addressType);
+	Serial.print((transition == BleTrackerEnter) ? "Entered: " : "Left: ");
+	Serial.print(address.string());
+	Serial.print(" rssi: ");
+	Serial.print(device.rssi);
+	Serial.print(" hits: ");
+	Serial.println(device.hits);
+}
+
+uint8_t lastCount = 0;
+
+void setup() {
+	Serial.println("Device tracker test");
+
+	BLE.begin();
+	// Take the median, so that single outliers do not make a device leave, and time out after 2 seconds
+	BLE.trackDevices(BleRssiFilterMedian, -70, -80, 2000 / MICROAPP_LOOP_INTERVAL_MS);
+	if (!BLE.setEventHandler(BLEDevicePresence, onPresence)) {
+		Serial.println("Setting presence handler failed");
+	}
+	BLE.scan(true);
+}
+
+void loop() {
+	// Check for devices that timed out
+	BLE.poll();
+	uint8_t count = BLE.trackedDeviceCount();
+	if (count != lastCount) {
+		Serial.print("Present devices: ");
+		Serial.println(count);
+		lastCount = count;
+	}
+}
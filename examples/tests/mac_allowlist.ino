@@ -0,0 +1,37 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test the MAC allowlist: only devices in examples/tests/mac_allowlist.csv are handled.
+ * Build with MAC_ALLOWLIST_CSV=examples/tests/mac_allowlist.csv to generate the table.
+ */
+
+void onScannedDevice(BleDevice& device) {
+	Serial.print("Scanned: ");
+	Serial.print(device.address());
+	Serial.print(" rssi: ");
+	Serial.println(device.rssi());
+}
+
+void setup() {
+	Serial.println("MAC allowlist test");
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+
+	Serial.print("Allowlist size: ");
+	Serial.println(macAllowlistSize);
+	if (!BLE.setAllowlist(macAllowlist, macAllowlistSize)) {
+		Serial.println("Setting allowlist failed");
+	}
+	BLE.scan(true);
+}
+
+int counter = 0;
+
+void loop() {
+	if (++counter % 10 == 0) {
+		Serial.print("False positives: ");
+		Serial.println(BLE.allowlistFalsePositiveCount());
+	}
+}
@@ -0,0 +1,26 @@
+#include <Arduino.h>
+#include <Profiler.h>
+
+/**
+ * Test profiling: build with `make PROFILING=1`.
+ * Makes some calls every loop, and sends the histograms via Message every 10 loops.
+ */
+
+uint8_t counter = 0;
+
+void setup() {
+	Serial.println("Profiling test");
+	pinMode(LED1_PIN, OUTPUT);
+}
+
+void loop() {
+	digitalWrite(LED1_PIN, counter & 1);
+	Serial.println(counter);
+
+	if (++counter % 10 == 0) {
+		uint8_t reports = profilerDump();
+		Serial.print("Sent reports: ");
+		Serial.println(reports);
+		profilerReset();
+	}
+}
@@ -0,0 +1,36 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test scanning without duplicates: build with `make BLE_DUPLICATE_FILTER=1`.
+ * Repeated advertisements of a device are dropped for 5 ticks.
+ * Advertisements with other data than the previous one of the device are still handled.
+ * The number of handled and dropped advertisements is printed every 10 loops.
+ */
+
+uint16_t scanCount = 0;
+uint8_t counter    = 0;
+
+void onScannedDevice(BleDevice& device) {
+	scanCount++;
+	Serial.print("Scanned: ");
+	Serial.println(device.address());
+}
+
+void setup() {
+	Serial.println("Scan duplicates test");
+
+	BLE.begin();
+	BLE.setDuplicateFilter(5);
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+	BLE.scan();
+}
+
+void loop() {
+	if (++counter % 10 == 0) {
+		Serial.print("Scans: ");
+		Serial.print(scanCount);
+		Serial.print(" duplicates: ");
+		Serial.println(BLE.duplicateScanCount());
+	}
+}
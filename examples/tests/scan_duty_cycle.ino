@@ -0,0 +1,33 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test the scan schedule: scan 4 seconds every 10 seconds, with a budget of 1 scan per second. The window shrinks while
+ * more scans come in than the budget allows, and grows back when there are fewer.
+ */
+
+uint16_t scanned = 0;
+
+void onScannedDevice(BleDevice& device) {
+	scanned++;
+}
+
+void setup() {
+	Serial.println("Scan duty cycle test");
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+	BLE.setScanDutyCycle(4000, 10000, 1);
+	BLE.scan(true);
+}
+
+int counter = 0;
+void loop() {
+	if (++counter % 10 == 0) {
+		Serial.print("Scanned: ");
+		Serial.print(scanned);
+		Serial.print(" window: ");
+		Serial.println(BLE.scanWindowMs());
+		scanned = 0;
+	}
+}
@@ -0,0 +1,28 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test a scan filter with several criteria: nearby ATC thermometers, or any device with Apple manufacturer data.
+ */
+
+void onScannedDevice(BleDevice& device) {
+	Serial.print("Scanned: ");
+	Serial.print(device.address());
+	Serial.print(" rssi: ");
+	Serial.println(device.rssi());
+}
+
+void setup() {
+	Serial.println("Scan filter test");
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+
+	BleScanFilter filter;
+	filter.macPrefix("A4:C1:38").serviceDataUuid(0x181A).minRssi(-70).orElse().manufacturerId(0x004C);
+	if (!BLE.scanWithFilter(filter, true)) {
+		Serial.println("Setting scan filter failed");
+	}
+}
+
+void loop() {}
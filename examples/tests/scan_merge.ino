@@ -0,0 +1,42 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test merging advertisements with their scan response: build with `make BLE_MERGE_SCAN_RESPONSES=1`.
+ * A thermometer advertises its service data, and sends its name in the scan response. The handler gets both in one
+ * scan.
+ */
+
+void onScannedDevice(BleDevice& device) {
+	Serial.print("Scanned: ");
+	Serial.print(device.address());
+	Serial.print(" name: ");
+	Serial.print(device.hasLocalName() ? device.localName().c_str() : "-");
+	ble_service_data_t serviceData;
+	Serial.print(" service data: ");
+	Serial.println(device.findServiceData(0x181A, &serviceData) ? serviceData.len : 0);
+}
+
+void setup() {
+	Serial.println("Scan merge test");
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+	BLE.mergeScanResponses();
+	BLE.scan(true);
+}
+
+int counter = 0;
+
+void loop() {
+	BLE.poll();
+	if (++counter % 10 == 0) {
+		ble_scan_stats_t stats = BLE.scanStats();
+		Serial.print("Received: ");
+		Serial.print(stats.received);
+		Serial.print(" merged: ");
+		Serial.print(stats.merged);
+		Serial.print(" delivered: ");
+		Serial.println(stats.delivered);
+	}
+}
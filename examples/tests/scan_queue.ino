@@ -0,0 +1,36 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test the scan queue: build with `make BLE_SCAN_QUEUE=1`.
+ * Scanned devices are polled via BLE.available() once per loop.
+ * Keeps the strongest scans when more devices are scanned than fit in the queue.
+ */
+
+void setup() {
+	Serial.println("Scan queue test");
+
+	BLE.begin();
+	BLE.setScanOverflowPolicy(BleScanKeepStrongest);
+	BLE.scan(true);
+}
+
+void loop() {
+	uint8_t count = 0;
+	while (true) {
+		BleDevice& device = BLE.available();
+		if (!device) {
+			break;
+		}
+		count++;
+		Serial.print(device.address());
+		Serial.print(" rssi: ");
+		Serial.println(device.rssi());
+	}
+	if (count > 0) {
+		Serial.print("Polled: ");
+		Serial.print(count);
+		Serial.print(" dropped: ");
+		Serial.println(BLE.droppedScanCount());
+	}
+}
@@ -0,0 +1,47 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test the scan counters: scans for ATC thermometers without duplicates, and reports how many scans were filtered,
+ * deduplicated and delivered. The same counters are sent via Message every 10 ticks.
+ * Build with `make BLE_DUPLICATE_FILTER=1` to see duplicates dropped, and with `make PROFILING=1` to see how long the
+ * handler takes.
+ */
+
+void onScannedDevice(BleDevice& device) {
+	Serial.print("Scanned: ");
+	Serial.println(device.address());
+}
+
+void setup() {
+	Serial.println("Scan stats test");
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+	BLE.setScanStatsInterval(10);
+	BleScanFilter filter;
+	filter.namePrefix("ATC");
+	BLE.scanWithFilter(filter);
+}
+
+int counter = 0;
+
+void loop() {
+	BLE.poll();
+	if (++counter % 10 != 0) {
+		return;
+	}
+	ble_scan_stats_t stats = BLE.scanStats();
+	Serial.print("Received: ");
+	Serial.print(stats.received);
+	Serial.print(" filtered: ");
+	Serial.print(stats.filtered);
+	Serial.print(" deduplicated: ");
+	Serial.print(stats.deduplicated);
+	Serial.print(" delivered: ");
+	Serial.print(stats.delivered);
+	Serial.print(" busy: ");
+	Serial.println(stats.busyDropped);
+	Serial.print("Handler us max: ");
+	Serial.println(stats.handlerMax / stats.ticksPerUs);
+}
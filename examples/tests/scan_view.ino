@@ -0,0 +1,40 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+
+/**
+ * Test the scan view handler: scans are inspected in place, and only copied into a BleDevice when they are of interest.
+ */
+
+void onScannedView(BleScanView& view) {
+	ble_ad_t name = view.localName();
+	if (name.len == 0) {
+		return;
+	}
+	Serial.print("Scanned: ");
+	Serial.print(view.address());
+	Serial.print(" rssi: ");
+	Serial.print(view.rssi());
+	Serial.print(" name length: ");
+	Serial.println(name.len);
+
+	if (view.hasAdvertisedServiceUuid(0x181A)) {
+		// The device would be connected to here
+		BleDevice& device = view.device();
+		Serial.print("Selected: ");
+		Serial.println(device.localName());
+	}
+}
+
+void setup() {
+	Serial.println("Scan view test");
+
+	BLE.begin();
+	if (!BLE.setEventHandler(BLEDeviceScannedView, onScannedView)) {
+		Serial.println("Setting scan view handler failed");
+	}
+	BLE.scan(true);
+}
+
+void loop() {
+	// Scans are only kept for BLE.available() once it is called, which this test does not
+}
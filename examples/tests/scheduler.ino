@@ -0,0 +1,87 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+#include <CrownstoneSwitch.h>
+#include <Mesh.h>
+#include <Scheduler.h>
+
+/**
+ * A microapp example that runs scanning, switching and mesh reporting side by side with the cooperative scheduler.
+ * None of the tasks block the others.
+ */
+
+const char* peripheralAddress = "A4:C1:38:9A:45:E3";
+
+// Set by the scan handler, cleared by the scan task
+volatile bool scanned = false;
+int8_t lastRssi       = 0;
+uint16_t scanCount    = 0;
+
+void onScannedDevice(BleDevice& device) {
+	lastRssi = device.rssi();
+	scanned  = true;
+}
+
+// Counts the scanned devices, and waits until the next one is scanned
+void scanTask(Task& task) {
+	TASK_BEGIN(task);
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+	BLE.scanForAddress(peripheralAddress);
+	while (true) {
+		TASK_WAIT_UNTIL(task, scanned);
+		scanned = false;
+		scanCount++;
+	}
+	TASK_END(task);
+}
+
+// Toggles the switch every 10 seconds
+void switchTask(Task& task) {
+	TASK_BEGIN(task);
+	while (true) {
+		TASK_SLEEP(task, 10000);
+		CrownstoneSwitch.toggle();
+	}
+	TASK_END(task);
+}
+
+// Sends the number of scanned devices over the mesh every 5 seconds
+void meshTask(Task& task) {
+	TASK_BEGIN(task);
+	while (true) {
+		TASK_SLEEP(task, 5000);
+		uint8_t msg[3] = {(uint8_t)(scanCount >> 8), (uint8_t)scanCount, (uint8_t)lastRssi};
+		Mesh.sendMeshMsg(msg, sizeof(msg), 0);
+	}
+	TASK_END(task);
+}
+
+// Runs a few times, then ends
+void countdownTask(Task& task) {
+	static uint8_t count;
+	TASK_BEGIN(task);
+	for (count = 3; count > 0; count--) {
+		Serial.println(count);
+		TASK_SLEEP(task, 1000);
+	}
+	Serial.println("   Countdown task done");
+	TASK_END(task);
+}
+
+// The Arduino setup function.
+void setup() {
+	Serial.println("   Scheduler example");
+
+	if (!BLE.begin()) {
+		Serial.println("   BLE.begin failed");
+	}
+	Scheduler.add(scanTask);
+	Scheduler.add(switchTask);
+	Scheduler.add(meshTask);
+	Scheduler.add(countdownTask);
+	Serial.println("   End of setup");
+}
+
+// The Arduino loop function.
+void loop() {
+	Scheduler.run();
+}
@@ -17,12 +17,19 @@ void foo(uint32_t i) {
 	bla[0] = i;
 	Serial.println((unsigned int)&bla);
 	Serial.println((unsigned int)i);
+	// The free stack shrinks by the same amount every iteration
+	Serial.print("Free stack: ");
+	Serial.println((unsigned int)stackFree());
 	Serial.println("------");
 	foo(i+1);
 }
 
 void setup() {
 	Serial.println("Stack overflow test");
+	Serial.print("Stack size: ");
+	Serial.println((unsigned int)stackSize());
+	Serial.print("Peak stack usage so far: ");
+	Serial.println((unsigned int)stackPeakUsage());
 
 	uint32_t i = 0;
 	foo(i);
@@ -0,0 +1,41 @@
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+#include <Trace.h>
+
+/**
+ * Test tracing: build with `make TRACING=1`.
+ * Scans and toggles an LED every loop, and sends the recorded trace via Message every 10 loops.
+ * On the host, record with `--trace <file>` and replay the recording with `--replay <file>`.
+ */
+
+uint8_t counter    = 0;
+uint16_t scanCount = 0;
+
+void onScannedDevice(BleDevice& device) {
+	scanCount++;
+	Serial.print("Scanned: ");
+	Serial.println(device.rssi());
+}
+
+void setup() {
+	Serial.println("Tracing test");
+	pinMode(LED1_PIN, OUTPUT);
+
+	BLE.begin();
+	BLE.setEventHandler(BLEDeviceScanned, onScannedDevice);
+	BLE.scan(true);
+}
+
+void loop() {
+	digitalWrite(LED1_PIN, counter & 1);
+	Serial.print("Scans: ");
+	Serial.println(scanCount);
+
+	if (++counter % 10 == 0) {
+		uint8_t messages = traceDump();
+		Serial.print("Sent trace messages: ");
+		Serial.print(messages);
+		Serial.print(" dropped records: ");
+		Serial.println(traceDroppedCount());
+	}
+}
@@ -0,0 +1,1003 @@
+#include "Simulator.h"
+
+#include <ipc/cs_IpcRamData.h>
+#include <ucontext.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*
+ * Main function of the microapp, see src/main.c. It is renamed for the host build.
+ */
+extern "C" int microapp_main();
+
+/*
+ * The microapp gets a much larger stack than on the target, as host code uses more of it.
+ */
+static const size_t MICROAPP_STACK_SIZE = 256 * 1024;
+static uint8_t microappStack[MICROAPP_STACK_SIZE];
+
+static ucontext_t bluenetContext;
+static ucontext_t microappContext;
+
+static Simulator* simulator = nullptr;
+
+static microapp_sdk_result_t microappCallback(uint8_t opcode, bluenet_io_buffers_t* buffers) {
+	return simulator->callback(opcode, buffers);
+}
+
+/*
+ * Replaces the IPC RAM data of bluenet: the only data the microapp reads from it is the callback.
+ */
+uint8_t getRamData(uint8_t index, uint8_t* data, uint8_t* size, uint8_t maxSize) {
+	if (index != IPC_INDEX_BLUENET_TO_MICROAPP || maxSize < sizeof(bluenet2microapp_ipcdata_t)) {
+		return 1;
+	}
+	bluenet2microapp_ipcdata_t ipcData;
+	memset(&ipcData, 0, sizeof(ipcData));
+	ipcData.dataProtocol     = MICROAPP_IPC_DATA_PROTOCOL;
+	ipcData.microappCallback = microappCallback;
+	memcpy(data, &ipcData, sizeof(ipcData));
+	*size = sizeof(ipcData);
+	return 0;
+}
+
+/*
+ * Returns the key of a MAC address in the map of peripherals.
+ */
+static uint64_t macKey(const uint8_t* address) {
+	uint64_t key = 0;
+	for (uint8_t i = 0; i < MAC_ADDRESS_LENGTH; ++i) {
+		key = (key << 8) | address[i];
+	}
+	return key;
+}
+
+static void printMac(const uint8_t* address) {
+	printf("%02X:%02X:%02X:%02X:%02X:%02X", address[5], address[4], address[3], address[2], address[1], address[0]);
+}
+
+static bool microappReturned = false;
+
+static void microappEntry() {
+	microapp_main();
+	// Not expected, the microapp keeps looping
+	microappReturned = true;
+}
+
+Simulator::Simulator(const std::vector<sim_event_t>& events, uint8_t stoneId) : _events(events), _stoneId(stoneId) {
+	simulator = this;
+}
+
+microapp_sdk_result_t Simulator::callback(uint8_t opcode, bluenet_io_buffers_t* buffers) {
+	_buffers = buffers;
+	if (opcode == CS_MICROAPP_CALLBACK_SIGNAL) {
+		// Yield to bluenet, until it resumes the microapp
+		swapcontext(&microappContext, &bluenetContext);
+	}
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+/*
+ * Switch to the microapp, until it signals bluenet.
+ */
+void Simulator::resume() {
+	if (_finished) {
+		return;
+	}
+	swapcontext(&bluenetContext, &microappContext);
+	_finished = microappReturned;
+}
+
+/*
+ * Resume the microapp, delivering the next pending interrupt if there is one.
+ * When an interrupt handler makes a call, the next pending interrupt thus nests in it.
+ */
+void Simulator::resumeMicroapp() {
+	if (!_pendingInterrupts.empty()) {
+		deliverInterrupt();
+		return;
+	}
+	resume();
+}
+
+void Simulator::start() {
+	getcontext(&microappContext);
+	microappContext.uc_stack.ss_sp   = microappStack;
+	microappContext.uc_stack.ss_size = sizeof(microappStack);
+	// When the microapp returns from main, continue in the simulator as if it signalled
+	microappContext.uc_link          = &bluenetContext;
+	makecontext(&microappContext, microappEntry, 0);
+	resume();
+}
+
+bool Simulator::run(uint32_t ticks) {
+	for (_tick = 0; _tick < ticks && !_finished; ++_tick) {
+		if (_tick == 0) {
+			// Runs setup(), until it yields
+			_calls = 0;
+			queueEvents();
+			start();
+			serve(0);
+			if (_buffers == nullptr) {
+				printf("The microapp did not call bluenet\n");
+				return false;
+			}
+			continue;
+		}
+		tick();
+	}
+	if (_logLineOpen) {
+		printf("\n");
+	}
+	printf("Ran %u ticks: %u interrupts, %u dropped as busy, %u times throttled, %u unknown requests\n", _tick,
+		   _interruptCount, _busyCount, _throttleCount, _unknownCount);
+	if (_finished) {
+		printf("The microapp returned from main\n");
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Resume the microapp for the next tick.
+ */
+void Simulator::tick() {
+	_calls = 0;
+	queueEvents();
+	// First deliver the events that happened since the last tick, each until it is handled
+	while (!_pendingInterrupts.empty() && !_finished) {
+		size_t depth = _interrupts.size() + 1;
+		deliverInterrupt();
+		if (serve(depth)) {
+			// The interrupt handler yielded, it continues next tick
+			return;
+		}
+	}
+	microapp_sdk_header_t* outgoing = reinterpret_cast<microapp_sdk_header_t*>(_buffers->microapp2bluenet.payload);
+	if (outgoing->messageType != CS_MICROAPP_SDK_TYPE_YIELD && outgoing->ack == CS_MICROAPP_SDK_ACK_REQUEST) {
+		// The microapp was throttled during the previous tick, handle the call it was waiting for
+		_calls++;
+		handleRequest(outgoing);
+	}
+	microapp_sdk_header_t* incoming = reinterpret_cast<microapp_sdk_header_t*>(_buffers->bluenet2microapp.payload);
+	incoming->messageType           = CS_MICROAPP_SDK_TYPE_CONTINUE;
+	incoming->ack                   = CS_MICROAPP_SDK_ACK_NO_REQUEST;
+	resume();
+	serve(0);
+}
+
+/*
+ * Handle the calls of the microapp.
+ *
+ * @param[in] depth      Return when fewer interrupts than this are being handled.
+ *
+ * @return true when the microapp yielded, or is throttled. The microapp then continues next tick.
+ */
+bool Simulator::serve(size_t depth) {
+	while (!_finished) {
+		while (!_interrupts.empty() && _interrupts.back()->ack != CS_MICROAPP_SDK_ACK_REQUEST
+			   && _interrupts.back()->ack != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
+			// The microapp is done with the interrupt
+			if (_interrupts.back()->ack == CS_MICROAPP_SDK_ACK_ERR_BUSY) {
+				_busyCount++;
+			}
+			_interrupts.pop_back();
+		}
+		if (_interrupts.size() < depth) {
+			return false;
+		}
+		microapp_sdk_header_t* outgoing = reinterpret_cast<microapp_sdk_header_t*>(_buffers->microapp2bluenet.payload);
+		if (outgoing->messageType == CS_MICROAPP_SDK_TYPE_YIELD) {
+			return true;
+		}
+		if (outgoing->ack == CS_MICROAPP_SDK_ACK_REQUEST) {
+			// Only calls from the main context count
+			if (_interrupts.empty()) {
+				if (_calls >= SIM_MAX_CALLS_PER_TICK) {
+					_throttleCount++;
+					return true;
+				}
+				_calls++;
+			}
+			handleRequest(outgoing);
+		}
+		resumeMicroapp();
+	}
+	return true;
+}
+
+bool Simulator::replay(const std::vector<sim_trace_record_t>& records) {
+	_records    = &records;
+	_nextRecord = 0;
+	start();
+	while (!_finished && !_diverged && _nextRecord < records.size()) {
+		replayStep();
+	}
+	if (_logLineOpen) {
+		printf("\n");
+	}
+	printf("Replayed %zu of %zu records, %u ticks, %u interrupts\n", _nextRecord, records.size(), _tick,
+		   _interruptCount);
+	if (_finished) {
+		printf("The microapp returned from main\n");
+		return false;
+	}
+	return !_diverged;
+}
+
+/*
+ * Answer the last signal of the microapp from the trace, and resume it.
+ */
+void Simulator::replayStep() {
+	bool interruptDone = false;
+	while (!_interrupts.empty() && _interrupts.back()->ack != CS_MICROAPP_SDK_ACK_REQUEST
+		   && _interrupts.back()->ack != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
+		const sim_trace_record_t* record = nextRecord(TRACE_INTERRUPT_RESULT);
+		if (record == nullptr) {
+			return;
+		}
+		auto recorded = reinterpret_cast<const microapp_sdk_header_t*>(record->data.data());
+		if (recorded->ack != _interrupts.back()->ack) {
+			diverge("different interrupt result");
+			return;
+		}
+		_interrupts.pop_back();
+		interruptDone = true;
+	}
+	microapp_sdk_header_t* incoming = reinterpret_cast<microapp_sdk_header_t*>(_buffers->bluenet2microapp.payload);
+	if (!interruptDone) {
+		// The microapp signalled with a request
+		const sim_trace_record_t* record = nextRecord(TRACE_REQUEST);
+		if (record == nullptr) {
+			return;
+		}
+		uint8_t* outgoing = _buffers->microapp2bluenet.payload;
+		if (memcmp(outgoing, record->data.data(), record->data.size()) != 0) {
+			diverge("different request");
+			return;
+		}
+		_tick       = record->tick;
+		auto header = reinterpret_cast<microapp_sdk_header_t*>(outgoing);
+		if (header->messageType == CS_MICROAPP_SDK_TYPE_YIELD) {
+			incoming->messageType = CS_MICROAPP_SDK_TYPE_CONTINUE;
+			incoming->ack         = CS_MICROAPP_SDK_ACK_NO_REQUEST;
+		}
+		else {
+			// Only to print what the microapp does, the response comes from the trace
+			handleRequest(header);
+			record = nextRecord(TRACE_RESPONSE);
+			if (record == nullptr) {
+				return;
+			}
+			memcpy(outgoing, record->data.data(), record->data.size());
+		}
+	}
+	if (_nextRecord < _records->size() && (*_records)[_nextRecord].kind == TRACE_INTERRUPT) {
+		const sim_trace_record_t& record = (*_records)[_nextRecord++];
+		_tick                            = record.tick;
+		memset(incoming, 0, MICROAPP_SDK_MAX_PAYLOAD);
+		memcpy(incoming, record.data.data(), record.data.size());
+		incoming->ack = CS_MICROAPP_SDK_ACK_REQUEST;
+		_interrupts.push_back(incoming);
+		_interruptCount++;
+	}
+	resume();
+}
+
+/*
+ * Returns the next record of the trace, or null when it is of another kind.
+ */
+const sim_trace_record_t* Simulator::nextRecord(TraceKind kind) {
+	if (_nextRecord >= _records->size()) {
+		// End of the trace
+		return nullptr;
+	}
+	const sim_trace_record_t& record = (*_records)[_nextRecord];
+	if (record.kind != kind) {
+		diverge("different kind of record");
+		return nullptr;
+	}
+	_nextRecord++;
+	return &record;
+}
+
+void Simulator::diverge(const char* reason) {
+	printTime();
+	printf("The microapp diverged from the trace at record %zu: %s\n", _nextRecord, reason);
+	_diverged = true;
+}
+
+/*
+ * Apply the events of this tick, and queue those that are interrupts the microapp registered for.
+ */
+void Simulator::queueEvents() {
+	// Events in response to requests of the previous tick
+	_pendingInterrupts.insert(_pendingInterrupts.end(), _nextTickInterrupts.begin(), _nextTickInterrupts.end());
+	_nextTickInterrupts.clear();
+
+	uint8_t message[MICROAPP_SDK_MAX_PAYLOAD];
+	while (_nextEvent < _events.size() && _events[_nextEvent].tick <= _tick) {
+		const sim_event_t& event = _events[_nextEvent++];
+		memset(message, 0, sizeof(message));
+		switch (event.type) {
+			case SIM_EVENT_SCAN: {
+				if (!_scanRegistered || !_scanning) {
+					break;
+				}
+				auto ble                 = reinterpret_cast<microapp_sdk_ble_t*>(message);
+				ble->header.messageType  = CS_MICROAPP_SDK_TYPE_BLE;
+				ble->type                = CS_MICROAPP_SDK_BLE_SCAN;
+				ble->scan.type           = CS_MICROAPP_SDK_BLE_SCAN_EVENT_SCAN;
+				auto scan                = &ble->scan.eventScan;
+				scan->address.type       = MICROAPP_SDK_BLE_ADDRESS_RANDOM_STATIC;
+				memcpy(scan->address.address, event.address, MAC_ADDRESS_LENGTH);
+				scan->rssi               = event.value;
+				scan->channel            = 37;
+				scan->size               = (event.size > MAX_BLE_ADV_DATA_LENGTH) ? MAX_BLE_ADV_DATA_LENGTH : event.size;
+				memcpy(scan->data, event.data, scan->size);
+				queueInterrupt(message);
+				break;
+			}
+			case SIM_EVENT_MESH: {
+				if (!_meshListening) {
+					break;
+				}
+				auto mesh                = reinterpret_cast<microapp_sdk_mesh_t*>(message);
+				mesh->header.messageType = CS_MICROAPP_SDK_TYPE_MESH;
+				mesh->type               = CS_MICROAPP_SDK_MESH_READ;
+				mesh->stoneId            = event.id;
+				mesh->size = (event.size > MAX_MICROAPP_MESH_PAYLOAD_SIZE) ? MAX_MICROAPP_MESH_PAYLOAD_SIZE : event.size;
+				memcpy(mesh->data, event.data, mesh->size);
+				queueInterrupt(message);
+				break;
+			}
+			case SIM_EVENT_PIN: {
+				uint8_t previous        = _pinLevels[event.id];
+				uint8_t level           = (event.value != 0);
+				_pinLevels[event.id]    = level;
+				uint8_t polarity        = _pinPolarity[event.id];
+				bool rising             = (previous == 0 && level == 1);
+				bool falling            = (previous == 1 && level == 0);
+				if ((polarity == CS_MICROAPP_SDK_PIN_CHANGE && (rising || falling))
+					|| (polarity == CS_MICROAPP_SDK_PIN_RISING && rising)
+					|| (polarity == CS_MICROAPP_SDK_PIN_FALLING && falling)) {
+					auto pin                = reinterpret_cast<microapp_sdk_pin_t*>(message);
+					pin->header.messageType = CS_MICROAPP_SDK_TYPE_PIN;
+					pin->pin                = event.id;
+					pin->type               = CS_MICROAPP_SDK_PIN_ACTION;
+					pin->action             = CS_MICROAPP_SDK_PIN_READ;
+					pin->value              = level;
+					queueInterrupt(message);
+				}
+				break;
+			}
+			case SIM_EVENT_MESSAGE: {
+				if (!_messageRegistered) {
+					break;
+				}
+				auto msg                     = reinterpret_cast<microapp_sdk_message_t*>(message);
+				msg->header.messageType      = CS_MICROAPP_SDK_TYPE_MESSAGE;
+				msg->type                    = CS_MICROAPP_SDK_MSG_EVENT_RECEIVED_MSG;
+				msg->receivedMessage.size    = (event.size > MICROAPP_SDK_MESSAGE_RECEIVED_MSG_MAX_SIZE)
+													   ? MICROAPP_SDK_MESSAGE_RECEIVED_MSG_MAX_SIZE
+													   : event.size;
+				memcpy(msg->receivedMessage.data, event.data, msg->receivedMessage.size);
+				queueInterrupt(message);
+				break;
+			}
+			case SIM_EVENT_POWER: {
+				_powerUsage = event.value;
+				break;
+			}
+			case SIM_EVENT_PRESENCE: {
+				_presence[event.id] = event.value;
+				break;
+			}
+			case SIM_EVENT_SERVICE:
+			case SIM_EVENT_CHARACTERISTIC: {
+				sim_attribute_t attribute;
+				attribute.serviceUuid = (event.type == SIM_EVENT_SERVICE) ? event.uuid : event.serviceUuid;
+				attribute.uuid        = event.uuid;
+				attribute.properties  = event.id;
+				attribute.valueHandle = event.valueHandle;
+				attribute.cccdHandle  = event.cccdHandle;
+				_peripherals[macKey(event.address)].push_back(attribute);
+				break;
+			}
+		}
+	}
+}
+
+void Simulator::queueInterrupt(const uint8_t* message) {
+	_pendingInterrupts.emplace_back(message, message + MICROAPP_SDK_MAX_PAYLOAD);
+}
+
+/*
+ * Deliver the first pending interrupt, by resuming the microapp with it in the incoming buffer.
+ */
+void Simulator::deliverInterrupt() {
+	uint8_t* incoming = _buffers->bluenet2microapp.payload;
+	memcpy(incoming, _pendingInterrupts.front().data(), MICROAPP_SDK_MAX_PAYLOAD);
+	_pendingInterrupts.erase(_pendingInterrupts.begin());
+	// Keep the header in these buffers: the microapp writes the result here, also after pointing bluenet elsewhere
+	microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(incoming);
+	header->ack                   = CS_MICROAPP_SDK_ACK_REQUEST;
+	_interrupts.push_back(header);
+	_interruptCount++;
+	resume();
+}
+
+void Simulator::handleRequest(microapp_sdk_header_t* header) {
+	microapp_sdk_result_t result = CS_MICROAPP_SDK_ACK_SUCCESS;
+	switch (header->messageType) {
+		case CS_MICROAPP_SDK_TYPE_LOG: {
+			handleLog(reinterpret_cast<microapp_sdk_log_header_t*>(header));
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_PIN: {
+			handlePin(reinterpret_cast<microapp_sdk_pin_t*>(header));
+			return;
+		}
+		case CS_MICROAPP_SDK_TYPE_SWITCH: {
+			auto request = reinterpret_cast<microapp_sdk_switch_t*>(header);
+			if (request->type == CS_MICROAPP_SDK_SWITCH_REQUEST_GET) {
+				request->get = _switchState;
+				break;
+			}
+			printTime();
+			printf("switch: %u\n", request->set);
+			if (request->set <= CS_MICROAPP_SDK_SWITCH_ON) {
+				_switchState.dimmer = request->set;
+				_switchState.relay  = (request->set != 0);
+			}
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_SERVICE_DATA: {
+			auto request = reinterpret_cast<microapp_sdk_service_data_t*>(header);
+			printTime();
+			printf("service data %04X:", request->appUuid);
+			printHex(request->data, request->size);
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_BLE: {
+			handleBle(reinterpret_cast<microapp_sdk_ble_t*>(header));
+			return;
+		}
+		case CS_MICROAPP_SDK_TYPE_MESH: {
+			handleMesh(reinterpret_cast<microapp_sdk_mesh_t*>(header));
+			return;
+		}
+		case CS_MICROAPP_SDK_TYPE_POWER_USAGE: {
+			auto request        = reinterpret_cast<microapp_sdk_power_usage_t*>(header);
+			request->powerUsage = _powerUsage;
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_PRESENCE: {
+			auto request             = reinterpret_cast<microapp_sdk_presence_t*>(header);
+			request->presenceBitmask = _presence[request->profileId];
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_MESSAGE: {
+			handleMessage(reinterpret_cast<microapp_sdk_message_t*>(header));
+			return;
+		}
+		case CS_MICROAPP_SDK_TYPE_BLUENET_EVENT: {
+			// Registering is fine, but there are no events to deliver
+			break;
+		}
+		default: {
+			// Includes TWI, control commands, and types bluenet does not know, like batches
+			_unknownCount++;
+			result = CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+			break;
+		}
+	}
+	header->ack = result;
+}
+
+void Simulator::handleLog(microapp_sdk_log_header_t* log) {
+	const uint8_t* value = reinterpret_cast<const uint8_t*>(log + 1);
+	if (!_logLineOpen) {
+		printTime();
+	}
+	switch (log->type) {
+		case CS_MICROAPP_SDK_LOG_CHAR: printf("%c", *value); break;
+		case CS_MICROAPP_SDK_LOG_SHORT: {
+			int16_t number;
+			memcpy(&number, value, sizeof(number));
+			printf("%d", number);
+			break;
+		}
+		case CS_MICROAPP_SDK_LOG_INT: {
+			int32_t number;
+			memcpy(&number, value, sizeof(number));
+			printf("%d", number);
+			break;
+		}
+		case CS_MICROAPP_SDK_LOG_UINT: {
+			uint32_t number;
+			memcpy(&number, value, sizeof(number));
+			printf("%u", number);
+			break;
+		}
+		case CS_MICROAPP_SDK_LOG_FLOAT: {
+			float number;
+			memcpy(&number, value, sizeof(number));
+			printf("%f", number);
+			break;
+		}
+		case CS_MICROAPP_SDK_LOG_DOUBLE: {
+			double number;
+			memcpy(&number, value, sizeof(number));
+			printf("%f", number);
+			break;
+		}
+		case CS_MICROAPP_SDK_LOG_STR: printf("%.*s", log->size, reinterpret_cast<const char*>(value)); break;
+		case CS_MICROAPP_SDK_LOG_ARR: {
+			for (uint8_t i = 0; i < log->size; ++i) {
+				printf("%s%02X", (i == 0) ? "" : " ", value[i]);
+			}
+			break;
+		}
+		default: printf("<log type %u>", log->type); break;
+	}
+	_logLineOpen = !(log->flags & CS_MICROAPP_SDK_LOG_FLAG_NEWLINE);
+	if (!_logLineOpen) {
+		printf("\n");
+	}
+}
+
+void Simulator::handlePin(microapp_sdk_pin_t* pin) {
+	switch (pin->type) {
+		case CS_MICROAPP_SDK_PIN_INIT: {
+			_pinPolarity[pin->pin] = pin->polarity;
+			break;
+		}
+		case CS_MICROAPP_SDK_PIN_ACTION: {
+			if (pin->action == CS_MICROAPP_SDK_PIN_READ) {
+				pin->value = _pinLevels[pin->pin] ? CS_MICROAPP_SDK_PIN_ON : CS_MICROAPP_SDK_PIN_OFF;
+				break;
+			}
+			uint8_t level = (pin->value != CS_MICROAPP_SDK_PIN_OFF);
+			if (level != _pinLevels[pin->pin]) {
+				printTime();
+				printf("pin %u: %u\n", pin->pin, level);
+			}
+			_pinLevels[pin->pin] = level;
+			break;
+		}
+		default: {
+			pin->header.ack = CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+			return;
+		}
+	}
+	pin->header.ack = CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+void Simulator::handleBle(microapp_sdk_ble_t* ble) {
+	microapp_sdk_result_t result = CS_MICROAPP_SDK_ACK_SUCCESS;
+	switch (ble->type) {
+		case CS_MICROAPP_SDK_BLE_UUID_REGISTER: {
+			// Bluenet returns the short uuid, and a type for the base uuid
+			auto& request = ble->requestUuidRegister;
+			memcpy(&request.uuid.uuid, request.customUuid + 12, sizeof(request.uuid.uuid));
+			request.uuid.type = CS_MICROAPP_SDK_BLE_UUID_STANDARD + 1 + _registeredUuids++;
+			break;
+		}
+		case CS_MICROAPP_SDK_BLE_MAC: {
+			static const uint8_t address[MAC_ADDRESS_LENGTH] = {0x01, 0x00, 0x00, 0x00, 0xAD, 0xDE};
+			ble->requestMac.address.type                      = MICROAPP_SDK_BLE_ADDRESS_RANDOM_STATIC;
+			memcpy(ble->requestMac.address.address, address, MAC_ADDRESS_LENGTH);
+			break;
+		}
+		case CS_MICROAPP_SDK_BLE_SCAN: {
+			switch (ble->scan.type) {
+				case CS_MICROAPP_SDK_BLE_SCAN_REQUEST_REGISTER_INTERRUPT: _scanRegistered = true; break;
+				case CS_MICROAPP_SDK_BLE_SCAN_REQUEST_START: _scanning = true; break;
+				case CS_MICROAPP_SDK_BLE_SCAN_REQUEST_STOP: _scanning = false; break;
+				// The SDK filters as well, so all scans are delivered
+				case CS_MICROAPP_SDK_BLE_SCAN_REQUEST_FILTER: break;
+				default: result = CS_MICROAPP_SDK_ACK_ERR_UNDEFINED; break;
+			}
+			break;
+		}
+		case CS_MICROAPP_SDK_BLE_CENTRAL: {
+			result = handleCentral(&ble->central);
+			break;
+		}
+		case CS_MICROAPP_SDK_BLE_PERIPHERAL: {
+			if (ble->peripheral.type == CS_MICROAPP_SDK_BLE_PERIPHERAL_REQUEST_DISCONNECT) {
+				// Bluenet disconnects by connection handle, whatever the role of the connection
+				result = disconnect(ble->peripheral.connectionHandle);
+				break;
+			}
+			// The peripheral role is not simulated
+			result = CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED;
+			break;
+		}
+		default: {
+			result = CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED;
+			break;
+		}
+	}
+	ble->header.ack = result;
+}
+
+/*
+ * Handle a request of the central role: connect to a peripheral of the script, and discover its services. The results
+ * come as events in the next tick.
+ */
+microapp_sdk_result_t Simulator::handleCentral(microapp_sdk_ble_central_t* central) {
+	microapp_sdk_ble_central_t event = {};
+	switch (central->type) {
+		case CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_REGISTER_INTERRUPT: {
+			_centralRegistered = true;
+			return CS_MICROAPP_SDK_ACK_SUCCESS;
+		}
+		case CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_CONNECT: {
+			if (_connectionHandle != 0) {
+				return CS_MICROAPP_SDK_ACK_ERR_BUSY;
+			}
+			const uint8_t* address = central->requestConnect.address.address;
+			printTime();
+			printf("connect ");
+			printMac(address);
+			printf("\n");
+			event.type = CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_CONNECT;
+			if (_peripherals.count(macKey(address)) == 0) {
+				// No peripheral with this address in the script
+				event.eventConnect.result = CS_MICROAPP_SDK_ACK_ERR_TIMEOUT;
+			}
+			else {
+				_connectionHandle         = ++_lastHandle;
+				_connectedAddress         = macKey(address);
+				event.connectionHandle    = _connectionHandle;
+				event.eventConnect.result = CS_MICROAPP_SDK_ACK_SUCCESS;
+			}
+			queueCentralEvent(event);
+			return CS_MICROAPP_SDK_ACK_IN_PROGRESS;
+		}
+		case CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_DISCONNECT: {
+			return disconnect(central->connectionHandle);
+		}
+		case CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_DISCOVER: {
+			if (_connectionHandle == 0 || central->connectionHandle != _connectionHandle) {
+				return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
+			}
+			auto& request = central->requestDiscover;
+			if (request.uuidCount == 0 || request.uuidCount > sizeof(request.uuids) / sizeof(request.uuids[0])) {
+				// Like bluenet, which requires a set of services to discover
+				return CS_MICROAPP_SDK_ACK_ERR_EMPTY;
+			}
+			printTime();
+			printf("discover");
+			for (uint8_t i = 0; i < request.uuidCount; ++i) {
+				printf(" %04X", request.uuids[i].uuid);
+			}
+			printf("\n");
+			event.connectionHandle = _connectionHandle;
+			event.type             = CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_DISCOVER;
+			for (const sim_attribute_t& attribute : _peripherals[_connectedAddress]) {
+				bool requested = false;
+				for (uint8_t i = 0; i < request.uuidCount; ++i) {
+					requested |= (request.uuids[i].type == CS_MICROAPP_SDK_BLE_UUID_STANDARD
+								  && request.uuids[i].uuid == attribute.serviceUuid);
+				}
+				if (!requested) {
+					continue;
+				}
+				auto& discover                   = event.eventDiscover;
+				discover.serviceUuid.type        = CS_MICROAPP_SDK_BLE_UUID_STANDARD;
+				discover.serviceUuid.uuid        = attribute.serviceUuid;
+				discover.uuid.type               = CS_MICROAPP_SDK_BLE_UUID_STANDARD;
+				discover.uuid.uuid               = attribute.uuid;
+				discover.options.read            = (attribute.properties & (1 << 1)) != 0;
+				discover.options.writeNoResponse = (attribute.properties & (1 << 2)) != 0;
+				discover.options.write           = (attribute.properties & (1 << 3)) != 0;
+				discover.options.notify          = (attribute.properties & (1 << 4)) != 0;
+				discover.options.indicate        = (attribute.properties & (1 << 5)) != 0;
+				discover.valueHandle             = attribute.valueHandle;
+				discover.cccdHandle              = attribute.cccdHandle;
+				queueCentralEvent(event);
+			}
+			event                          = {};
+			event.connectionHandle         = _connectionHandle;
+			event.type                     = CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_DISCOVER_DONE;
+			event.eventDiscoverDone.result = CS_MICROAPP_SDK_ACK_SUCCESS;
+			queueCentralEvent(event);
+			return CS_MICROAPP_SDK_ACK_IN_PROGRESS;
+		}
+		default: {
+			// Reading and writing characteristics are not simulated
+			return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED;
+		}
+	}
+}
+
+microapp_sdk_result_t Simulator::disconnect(uint16_t connectionHandle) {
+	if (_connectionHandle == 0 || connectionHandle != _connectionHandle) {
+		return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
+	}
+	printTime();
+	printf("disconnect\n");
+	microapp_sdk_ble_central_t event = {};
+	event.type                       = CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_DISCONNECT;
+	event.connectionHandle           = _connectionHandle;
+	_connectionHandle                = 0;
+	queueCentralEvent(event);
+	return CS_MICROAPP_SDK_ACK_IN_PROGRESS;
+}
+
+/*
+ * Queue a central event, to be delivered next tick, if the microapp registered for them.
+ */
+void Simulator::queueCentralEvent(const microapp_sdk_ble_central_t& central) {
+	if (!_centralRegistered) {
+		return;
+	}
+	uint8_t message[MICROAPP_SDK_MAX_PAYLOAD] = {};
+	auto ble                                  = reinterpret_cast<microapp_sdk_ble_t*>(message);
+	ble->header.messageType                   = CS_MICROAPP_SDK_TYPE_BLE;
+	ble->type                                 = CS_MICROAPP_SDK_BLE_CENTRAL;
+	ble->central                              = central;
+	_nextTickInterrupts.emplace_back(message, message + MICROAPP_SDK_MAX_PAYLOAD);
+}
+
+void Simulator::handleMesh(microapp_sdk_mesh_t* mesh) {
+	microapp_sdk_result_t result = CS_MICROAPP_SDK_ACK_SUCCESS;
+	switch (mesh->type) {
+		case CS_MICROAPP_SDK_MESH_SEND: {
+			printTime();
+			printf("mesh to %u:", mesh->stoneId);
+			printHex(mesh->data, mesh->size);
+			break;
+		}
+		case CS_MICROAPP_SDK_MESH_LISTEN: _meshListening = true; break;
+		case CS_MICROAPP_SDK_MESH_READ_CONFIG: mesh->stoneId = _stoneId; break;
+		default: result = CS_MICROAPP_SDK_ACK_ERR_UNDEFINED; break;
+	}
+	mesh->header.ack = result;
+}
+
+void Simulator::handleMessage(microapp_sdk_message_t* message) {
+	microapp_sdk_result_t result = CS_MICROAPP_SDK_ACK_SUCCESS;
+	switch (message->type) {
+		case CS_MICROAPP_SDK_MSG_REGISTER_INTERRUPT: _messageRegistered = true; break;
+		case CS_MICROAPP_SDK_MSG_REQUEST_SEND_MSG: {
+			printTime();
+			printf("message:");
+			printHex(message->sendMessage.data, message->sendMessage.size);
+			break;
+		}
+		default: result = CS_MICROAPP_SDK_ACK_ERR_UNDEFINED; break;
+	}
+	message->header.ack = result;
+}
+
+void Simulator::printTime() {
+	if (_logLineOpen) {
+		// Finish the log line first
+		printf("\n");
+		_logLineOpen = false;
+	}
+	uint32_t ms = _tick * MICROAPP_LOOP_INTERVAL_MS;
+	printf("[%6u.%03u] ", ms / 1000, ms % 1000);
+}
+
+void Simulator::printHex(const uint8_t* data, uint16_t size) {
+	for (uint16_t i = 0; i < size; ++i) {
+		printf(" %02X", data[i]);
+	}
+	printf("\n");
+}
+
+/*
+ * Parse hex data, like 0201AB, into data.
+ */
+static bool parseHex(const char* text, uint8_t* data, uint8_t* size) {
+	size_t length = strlen(text);
+	if (length % 2 != 0 || length / 2 > MICROAPP_SDK_MAX_PAYLOAD) {
+		return false;
+	}
+	for (size_t i = 0; i < length / 2; ++i) {
+		char byte[3] = {text[2 * i], text[2 * i + 1], 0};
+		char* end;
+		data[i] = strtoul(byte, &end, 16);
+		if (*end != 0) {
+			return false;
+		}
+	}
+	*size = length / 2;
+	return true;
+}
+
+/*
+ * Set the address of an event to a parsed MAC address, in the byte order of bluenet.
+ */
+static void setAddress(const unsigned int* mac, uint8_t* address) {
+	for (uint8_t i = 0; i < MAC_ADDRESS_LENGTH; ++i) {
+		address[MAC_ADDRESS_LENGTH - i - 1] = mac[i];
+	}
+}
+
+static bool parseLine(char* line, sim_event_t& event) {
+	memset(&event, 0, sizeof(event));
+	char type[16];
+	char arg[16];
+	char hex[2 * MICROAPP_SDK_MAX_PAYLOAD + 1] = "";
+	long long value;
+	unsigned int id;
+	if (sscanf(line, "%u %15s", &event.tick, type) != 2) {
+		return false;
+	}
+	if (strcmp(type, "scan") == 0) {
+		event.type = SIM_EVENT_SCAN;
+		unsigned int mac[MAC_ADDRESS_LENGTH];
+		if (sscanf(line, "%*u %*s %x:%x:%x:%x:%x:%x %lld %512s", &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5],
+				   &value, hex)
+			< 7) {
+			return false;
+		}
+		setAddress(mac, event.address);
+		event.value = value;
+		return parseHex(hex, event.data, &event.size);
+	}
+	if (strcmp(type, "service") == 0) {
+		event.type = SIM_EVENT_SERVICE;
+		unsigned int mac[MAC_ADDRESS_LENGTH];
+		unsigned int uuid;
+		if (sscanf(line, "%*u %*s %x:%x:%x:%x:%x:%x %x", &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5], &uuid)
+			!= 7) {
+			return false;
+		}
+		setAddress(mac, event.address);
+		event.uuid = uuid;
+		return true;
+	}
+	if (strcmp(type, "characteristic") == 0) {
+		event.type = SIM_EVENT_CHARACTERISTIC;
+		unsigned int mac[MAC_ADDRESS_LENGTH];
+		unsigned int serviceUuid;
+		unsigned int uuid;
+		unsigned int valueHandle;
+		unsigned int cccdHandle;
+		if (sscanf(line, "%*u %*s %x:%x:%x:%x:%x:%x %x %x %u %u %15s", &mac[0], &mac[1], &mac[2], &mac[3], &mac[4],
+				   &mac[5], &serviceUuid, &uuid, &valueHandle, &cccdHandle, arg)
+				!= 11
+			|| valueHandle == 0) {
+			return false;
+		}
+		setAddress(mac, event.address);
+		event.serviceUuid = serviceUuid;
+		event.uuid        = uuid;
+		event.valueHandle = valueHandle;
+		event.cccdHandle  = cccdHandle;
+		event.id          = strtoul(arg, nullptr, 0);
+		return true;
+	}
+	if (strcmp(type, "mesh") == 0) {
+		event.type = SIM_EVENT_MESH;
+		if (sscanf(line, "%*u %*s %u %512s", &id, hex) != 2) {
+			return false;
+		}
+		event.id = id;
+		return parseHex(hex, event.data, &event.size);
+	}
+	if (strcmp(type, "message") == 0) {
+		event.type = SIM_EVENT_MESSAGE;
+		if (sscanf(line, "%*u %*s %512s", hex) != 1) {
+			return false;
+		}
+		return parseHex(hex, event.data, &event.size);
+	}
+	if (strcmp(type, "pin") == 0 || strcmp(type, "presence") == 0) {
+		event.type = (type[0] == 'p' && type[1] == 'i') ? SIM_EVENT_PIN : SIM_EVENT_PRESENCE;
+		if (sscanf(line, "%*u %*s %u %15s", &id, arg) != 2) {
+			return false;
+		}
+		event.id    = id;
+		event.value = strtoull(arg, nullptr, 0);
+		return true;
+	}
+	if (strcmp(type, "power") == 0) {
+		event.type = SIM_EVENT_POWER;
+		if (sscanf(line, "%*u %*s %lld", &value) != 1) {
+			return false;
+		}
+		event.value = value;
+		return true;
+	}
+	return false;
+}
+
+bool parseScript(const char* path, std::vector<sim_event_t>& events) {
+	FILE* file = fopen(path, "r");
+	if (file == nullptr) {
+		printf("Cannot open %s\n", path);
+		return false;
+	}
+	char line[1024];
+	int lineNumber = 0;
+	bool success   = true;
+	sim_event_t event;
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		lineNumber++;
+		char* start = line + strspn(line, " \t");
+		if (*start == '#' || *start == '\n' || *start == '\r' || *start == 0) {
+			continue;
+		}
+		if (!parseLine(start, event)) {
+			printf("%s:%d: invalid event: %s", path, lineNumber, start);
+			success = false;
+			break;
+		}
+		if (!events.empty() && event.tick < events.back().tick) {
+			printf("%s:%d: events should be sorted by tick\n", path, lineNumber);
+			success = false;
+			break;
+		}
+		events.push_back(event);
+	}
+	fclose(file);
+	return success;
+}
+
+static FILE* traceFile = nullptr;
+
+/*
+ * Called by the microapp, see include/Trace.h. Declared here, as the simulator is not built with MICROAPP_HOST.
+ */
+extern "C" void traceOutput(const uint8_t* data, uint16_t size) {
+	if (traceFile != nullptr) {
+		fwrite(data, 1, size, traceFile);
+	}
+}
+
+static void closeTrace() {
+	fclose(traceFile);
+}
+
+bool openTrace(const char* path) {
+	traceFile = fopen(path, "wb");
+	if (traceFile == nullptr) {
+		printf("Cannot create %s\n", path);
+		return false;
+	}
+	atexit(closeTrace);
+	return true;
+}
+
+bool loadTrace(const char* path, std::vector<sim_trace_record_t>& records) {
+	FILE* file = fopen(path, "rb");
+	if (file == nullptr) {
+		printf("Cannot open %s\n", path);
+		return false;
+	}
+	bool success = true;
+	trace_record_header_t header;
+	size_t size;
+	while ((size = fread(&header, 1, sizeof(header), file)) != 0) {
+		if (size != sizeof(header)) {
+			success = false;
+			break;
+		}
+		sim_trace_record_t record;
+		record.kind = static_cast<TraceKind>(header.kind);
+		record.tick = header.tick;
+		record.data.resize(header.size);
+		if (header.kind < TRACE_REQUEST || header.kind > TRACE_INTERRUPT_RESULT
+			|| fread(record.data.data(), 1, header.size, file) != header.size) {
+			success = false;
+			break;
+		}
+		records.push_back(record);
+	}
+	if (!success) {
+		printf("%s: invalid record %zu\n", path, records.size());
+		success = false;
+	}
+	fclose(file);
+	return success;
+}
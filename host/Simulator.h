@@ -0,0 +1,241 @@
+/**
+ * Simulated bluenet, to run a microapp natively on the host.
+ *
+ * The microapp runs as a coroutine on its own stack (ucontext), just like it does in bluenet. Each time it calls the
+ * callback to signal bluenet, control switches back to the simulator, which handles the request in the outgoing
+ * buffer and resumes the microapp. Time is virtual: every tick advances the clock by MICROAPP_LOOP_INTERVAL_MS, so
+ * a run is deterministic and takes as long as the microapp code itself.
+ *
+ * Events, like scanned advertisements, mesh messages and pin edges, are injected from a script, see parseScript().
+ * The script also sets the services and characteristics of peripherals, which the microapp can connect to and
+ * discover. Reading and writing characteristics is not simulated.
+ *
+ * When the microapp is built with TRACING=1, its messages can be recorded to a file, see openTrace(), and replayed
+ * later, see Simulator::replay(). Only traces written by the simulator can be replayed.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <Trace.h>
+#include <cs_MicroappStructs.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/*
+ * Number of calls bluenet handles per tick, the microapp is paused until the next tick before it handles more.
+ * Should equal MAX_CALLS_PER_TICK of the SDK.
+ */
+const uint8_t SIM_MAX_CALLS_PER_TICK = 8;
+
+/*
+ * Types of events that can be injected.
+ */
+enum SimEventType {
+	//! Scanned advertisement: delivered as interrupt while the microapp is scanning.
+	SIM_EVENT_SCAN,
+	//! Mesh message: delivered as interrupt when the microapp listens to the mesh.
+	SIM_EVENT_MESH,
+	//! Pin level: read by digitalRead(), delivered as interrupt on an edge the microapp registered for.
+	SIM_EVENT_PIN,
+	//! Message from the user: delivered as interrupt when the microapp registered for it.
+	SIM_EVENT_MESSAGE,
+	//! Power usage in mW, as returned to the microapp from then on.
+	SIM_EVENT_POWER,
+	//! Presence bitmask of a profile, as returned to the microapp from then on.
+	SIM_EVENT_PRESENCE,
+	//! Service of a peripheral, discovered from then on.
+	SIM_EVENT_SERVICE,
+	//! Characteristic of a service of a peripheral, discovered from then on.
+	SIM_EVENT_CHARACTERISTIC,
+};
+
+struct sim_event_t {
+	//! Tick at which the event happens.
+	uint32_t tick;
+	SimEventType type;
+	//! Pin, stone id, profile id, or properties of a characteristic.
+	uint8_t id;
+	//! Pin level, RSSI, power usage or presence bitmask.
+	int64_t value;
+	//! MAC address of a scan or peripheral, in the byte order of bluenet (reversed).
+	uint8_t address[MAC_ADDRESS_LENGTH];
+	//! 16-bit UUID of a service or characteristic.
+	uint16_t uuid;
+	//! 16-bit UUID of the service of a characteristic.
+	uint16_t serviceUuid;
+	uint16_t valueHandle;
+	//! Handle of the CCCD of a characteristic, 0 if it has none.
+	uint16_t cccdHandle;
+	uint8_t size;
+	uint8_t data[MICROAPP_SDK_MAX_PAYLOAD];
+};
+
+/**
+ * Read events from a script file. Each line is an event, empty lines and lines starting with # are skipped:
+ *
+ *   <tick> scan <mac> <rssi> <hex data>       for example: 10 scan 01:23:45:67:89:AB -60 0201060303AAFE
+ *   <tick> mesh <stone id> <hex data>
+ *   <tick> pin <pin> <level>
+ *   <tick> message <hex data>
+ *   <tick> power <mW>
+ *   <tick> presence <profile id> <bitmask>
+ *   <tick> service <mac> <hex uuid>
+ *   <tick> characteristic <mac> <hex service uuid> <hex uuid> <value handle> <cccd handle> <properties>
+ *
+ * The properties of a characteristic are the BleCharacteristicProperties bits, for example 0x12 for read and notify.
+ *
+ * @param[in] path       Path of the script.
+ * @param[out] events    The events are appended to this, sorted by tick.
+ *
+ * @return false if the file cannot be read or a line is invalid, which is then printed.
+ */
+bool parseScript(const char* path, std::vector<sim_event_t>& events);
+
+/*
+ * A service or characteristic of a simulated peripheral.
+ */
+struct sim_attribute_t {
+	uint16_t serviceUuid;
+	//! UUID of the characteristic, or of the service when valueHandle is 0.
+	uint16_t uuid;
+	uint8_t properties;
+	uint16_t valueHandle;
+	uint16_t cccdHandle;
+};
+
+struct sim_trace_record_t {
+	TraceKind kind;
+	uint16_t tick;
+	std::vector<uint8_t> data;
+};
+
+/**
+ * Record the trace of the microapp to a file, as a sequence of records, see include/Trace.h.
+ *
+ * @return false if the file cannot be created.
+ */
+bool openTrace(const char* path);
+
+/**
+ * Read a trace file, as written by openTrace().
+ *
+ * @return false if the file cannot be read or ends in the middle of a record.
+ */
+bool loadTrace(const char* path, std::vector<sim_trace_record_t>& records);
+
+/**
+ * The simulated bluenet. There can be only one, as the microapp has a single set of globals.
+ */
+class Simulator {
+public:
+	/**
+	 * @param[in] events     Events to inject, sorted by tick.
+	 * @param[in] stoneId    Stone id that Mesh.id() returns.
+	 */
+	Simulator(const std::vector<sim_event_t>& events, uint8_t stoneId);
+
+	/**
+	 * Start the microapp and run it for the given number of ticks. The first tick runs setup().
+	 *
+	 * @return false if the microapp did not yield at the end of setup, or returned from main.
+	 */
+	bool run(uint32_t ticks);
+
+	/**
+	 * Start the microapp and answer its requests with the responses in the trace, instead of simulating bluenet.
+	 * Interrupts are delivered at the same points as they were recorded. Stops at the end of the trace, or when the
+	 * microapp does something else than it did in the trace.
+	 *
+	 * @return false if the microapp diverged from the trace.
+	 */
+	bool replay(const std::vector<sim_trace_record_t>& records);
+
+	/**
+	 * Called by the microapp via the callback in the IPC RAM data.
+	 */
+	microapp_sdk_result_t callback(uint8_t opcode, bluenet_io_buffers_t* buffers);
+
+private:
+	void start();
+	void tick();
+	void resume();
+	void resumeMicroapp();
+	bool serve(size_t depth);
+	void queueEvents();
+	void queueInterrupt(const uint8_t* message);
+	void deliverInterrupt();
+	void handleRequest(microapp_sdk_header_t* header);
+	void handleLog(microapp_sdk_log_header_t* log);
+	void handlePin(microapp_sdk_pin_t* pin);
+	void handleBle(microapp_sdk_ble_t* ble);
+	microapp_sdk_result_t handleCentral(microapp_sdk_ble_central_t* central);
+	microapp_sdk_result_t disconnect(uint16_t connectionHandle);
+	void queueCentralEvent(const microapp_sdk_ble_central_t& central);
+	void handleMesh(microapp_sdk_mesh_t* mesh);
+	void handleMessage(microapp_sdk_message_t* message);
+	void replayStep();
+	const sim_trace_record_t* nextRecord(TraceKind kind);
+	void diverge(const char* reason);
+	void printTime();
+	void printHex(const uint8_t* data, uint16_t size);
+
+	const std::vector<sim_event_t>& _events;
+	//! Index of the next event in _events.
+	size_t _nextEvent = 0;
+	//! Interrupt messages that are to be delivered.
+	std::vector<std::vector<uint8_t>> _pendingInterrupts;
+	//! Interrupt messages in response to requests, delivered next tick.
+	std::vector<std::vector<uint8_t>> _nextTickInterrupts;
+	//! Headers of the interrupts the microapp is handling, the last one is the most nested.
+	std::vector<microapp_sdk_header_t*> _interrupts;
+
+	//! The trace that is replayed, if any.
+	const std::vector<sim_trace_record_t>* _records = nullptr;
+	//! Index of the next record in _records.
+	size_t _nextRecord                              = 0;
+	bool _diverged                                  = false;
+
+	//! The buffers the microapp points bluenet at.
+	bluenet_io_buffers_t* _buffers = nullptr;
+	uint32_t _tick                 = 0;
+	//! Calls handled from the main context in the current tick.
+	uint8_t _calls                 = 0;
+	bool _finished                 = false;
+	//! Whether the last log did not end with a newline.
+	bool _logLineOpen              = false;
+
+	uint8_t _stoneId;
+	int32_t _powerUsage = 0;
+	std::map<uint8_t, uint64_t> _presence;
+	//! Level and registered interrupt polarity, indexed by pin.
+	uint8_t _pinLevels[256]                  = {};
+	uint8_t _pinPolarity[256]                = {};
+	microapp_sdk_switch_state_t _switchState = {};
+	uint8_t _registeredUuids                 = 0;
+	bool _scanRegistered                     = false;
+	bool _scanning                           = false;
+	bool _meshListening                      = false;
+	bool _messageRegistered                  = false;
+
+	//! Services and characteristics of the peripherals, by MAC address, see macKey().
+	std::map<uint64_t, std::vector<sim_attribute_t>> _peripherals;
+	bool _centralRegistered    = false;
+	//! Connection handle of the connection to a peripheral, 0 when not connected.
+	uint16_t _connectionHandle = 0;
+	uint64_t _connectedAddress = 0;
+	//! The last connection handle that was handed out.
+	uint16_t _lastHandle       = 0;
+
+	//! Statistics, printed at the end of a run.
+	uint32_t _interruptCount = 0;
+	uint32_t _busyCount      = 0;
+	uint32_t _throttleCount  = 0;
+	uint32_t _unknownCount   = 0;
+};
@@ -0,0 +1,179 @@
+/**
+ * Correctness and throughput benchmark of the MAC allowlist in src/BleMacAllowlist.cpp.
+ *
+ * Runs on the host, see the bench_allowlist target in the Makefile. Sorted tables of random addresses, up to 10k, are
+ * looked up with mixes of addresses that are in the table and addresses that are not, once with a binary search
+ * only, and once with the Bloom filter in front of it. Most scanned addresses are not in an allowlist, so the mix
+ * without hits is the one that matters.
+ *
+ * The Bloom filter has MAC_ALLOWLIST_BLOOM_BYTES bytes: once the table is much larger than its number of bits, most
+ * addresses pass it, and the binary search does the work. Build with a larger Bloom filter to compare, for example
+ * with about 10 bits per address for 10k addresses:
+ *   make -B bench-allowlist MAC_ALLOWLIST_BLOOM_BYTES=16384
+ * This measures the host only: a microapp has 16 kB of flash and 4 kB of RAM, so neither tables of 10k addresses nor
+ * such Bloom filters fit on a Crownstone.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <BleMacAllowlist.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static const int MAX_TABLE_SIZE = 10000;
+static const int QUERY_COUNT    = 4096;
+
+static uint8_t table[MAX_TABLE_SIZE][MAC_ADDRESS_LENGTH];
+static uint8_t queries[QUERY_COUNT][MAC_ADDRESS_LENGTH];
+
+static BleMacAllowlist allowlist;
+
+static uint32_t randomState = 0x12345678;
+
+// Xorshift, so that the runs are the same.
+static uint32_t randomNumber() {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void randomAddress(uint8_t* address) {
+	for (int i = 0; i < MAC_ADDRESS_LENGTH; ++i) {
+		address[i] = randomNumber();
+	}
+}
+
+static int compareAddresses(const void* a, const void* b) {
+	return memcmp(a, b, MAC_ADDRESS_LENGTH);
+}
+
+// Fill the table with sorted, unique, random addresses.
+static void fillTable(int size) {
+	for (int i = 0; i < size; ++i) {
+		randomAddress(table[i]);
+	}
+	qsort(table, size, MAC_ADDRESS_LENGTH, compareAddresses);
+	for (int i = 1; i < size; ++i) {
+		if (memcmp(table[i - 1], table[i], MAC_ADDRESS_LENGTH) == 0) {
+			// Collisions are rare enough to just make the entry larger than the previous one.
+			memcpy(table[i], table[i - 1], MAC_ADDRESS_LENGTH);
+			table[i][MAC_ADDRESS_LENGTH - 1]++;
+		}
+	}
+}
+
+// Fill the queries with addresses from the table for hitPercentage percent, and random addresses otherwise.
+static void fillQueries(int size, int hitPercentage) {
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		if ((int)(randomNumber() % 100) < hitPercentage) {
+			memcpy(queries[i], table[randomNumber() % size], MAC_ADDRESS_LENGTH);
+		}
+		else {
+			randomAddress(queries[i]);
+		}
+	}
+}
+
+static void check(bool condition, const char* what, int& failures) {
+	if (!condition) {
+		printf("FAIL %s\n", what);
+		failures++;
+	}
+}
+
+static int checkAllowlist() {
+	int failures = 0;
+	fillTable(MAX_TABLE_SIZE);
+	check(allowlist.set(table, MAX_TABLE_SIZE), "set sorted table", failures);
+	check(allowlist.enabled(), "enabled", failures);
+	bool allFound = true;
+	for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+		allFound = allFound && allowlist.mayContain(table[i]) && allowlist.contains(table[i]);
+	}
+	check(allFound, "all entries found", failures);
+	check(allowlist.falsePositiveCount() == 0, "no false positives on hits", failures);
+
+	// Addresses that are not in the table, next to the ones that are
+	bool noneFound = true;
+	for (int i = 0; i < MAX_TABLE_SIZE; ++i) {
+		uint8_t address[MAC_ADDRESS_LENGTH];
+		memcpy(address, table[i], MAC_ADDRESS_LENGTH);
+		address[MAC_ADDRESS_LENGTH - 1]++;
+		if (i + 1 < MAX_TABLE_SIZE && memcmp(address, table[i + 1], MAC_ADDRESS_LENGTH) == 0) {
+			continue;
+		}
+		noneFound = noneFound && !allowlist.search(address) && !allowlist.contains(address);
+	}
+	check(noneFound, "other addresses not found", failures);
+
+	// Unsorted table
+	uint8_t unsorted[2][MAC_ADDRESS_LENGTH] = {{2, 0, 0, 0, 0, 0}, {1, 0, 0, 0, 0, 0}};
+	check(!allowlist.set(unsorted, 2), "reject unsorted table", failures);
+	check(!allowlist.enabled(), "disabled after unsorted table", failures);
+
+	allowlist.set(table, 1);
+	check(allowlist.contains(table[0]) && !allowlist.contains(table[1]), "table of 1", failures);
+	allowlist.clear();
+	check(!allowlist.enabled(), "clear", failures);
+	return failures;
+}
+
+// Returns the number of lookups per second.
+static double measure(bool withBloom) {
+	const int rounds = 500;
+	uint32_t found   = 0;
+	auto start       = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round) {
+		for (int i = 0; i < QUERY_COUNT; ++i) {
+			found += withBloom ? allowlist.contains(queries[i]) : allowlist.search(queries[i]);
+			// Prevent the lookups from being optimized away
+			asm volatile("" : "+r"(found) : : "memory");
+		}
+	}
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return (double)rounds * QUERY_COUNT / duration.count();
+}
+
+int main() {
+	int failures = checkAllowlist();
+	if (failures) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+
+	printf("\nBloom filter of %d bytes, %d hashes\n", MAC_ALLOWLIST_BLOOM_BYTES, MAC_ALLOWLIST_BLOOM_HASHES);
+	printf("%8s %6s %14s %14s %8s %10s\n", "entries", "hits", "search M/s", "bloom M/s", "speedup", "false pos");
+	const int tableSizes[]     = {100, 1000, MAX_TABLE_SIZE};
+	const int hitPercentages[] = {0, 10, 100};
+	for (int tableSize : tableSizes) {
+		fillTable(tableSize);
+		allowlist.set(table, tableSize);
+		for (int hitPercentage : hitPercentages) {
+			fillQueries(tableSize, hitPercentage);
+			double search = measure(false);
+			allowlist.set(table, tableSize);
+			double bloom = measure(true);
+			// False positives of one pass over the queries, relative to the queries that are not in the table
+			allowlist.set(table, tableSize);
+			int misses = 0;
+			for (int i = 0; i < QUERY_COUNT; ++i) {
+				misses += !allowlist.contains(queries[i]);
+			}
+			printf("%8d %5d%% %14.1f %14.1f %7.1fx %9.1f%%\n",
+				   tableSize,
+				   hitPercentage,
+				   search / 1e6,
+				   bloom / 1e6,
+				   bloom / search,
+				   misses ? 100.0 * allowlist.falsePositiveCount() / misses : 0.0);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * Roundtrip benchmark of the request batches in src/microapp.c.
+ *
+ * Runs on the host, see the bench_batch target in the Makefile. Instead of bluenet, a fake callback handles the calls
+ * of the microapp and counts the roundtrips. A batch of pin writes is committed to a bluenet that supports batches,
+ * to one that is busy when the batch comes in, and to one that does not know batches. In each case, every write
+ * should be handled exactly once, and the number of roundtrips is compared with sending the writes one by one.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <ipc/cs_IpcRamData.h>
+#include <microapp.h>
+
+#include <cstdio>
+
+enum fake_bluenet_mode_t {
+	//! Handles batches.
+	FAKE_BLUENET_BATCHES,
+	//! Refuses the first batch as busy, handles the ones after that.
+	FAKE_BLUENET_BUSY_ONCE,
+	//! Does not know the batch message type, like the simulator.
+	FAKE_BLUENET_NO_BATCHES,
+};
+
+static fake_bluenet_mode_t mode = FAKE_BLUENET_BATCHES;
+static int roundtrips           = 0;
+static bool busyDone            = false;
+
+//! Number of times each write was handled, indexed by the value written.
+static const int MAX_WRITES     = MAX_BATCH_ENTRIES;
+static int handledWrites[MAX_WRITES];
+
+//! Writes of this value fail, to check the ack of each request.
+static const uint8_t FAILING_VALUE = MAX_WRITES - 1;
+
+static microapp_sdk_result_t handleRequest(uint8_t* payload) {
+	microapp_sdk_pin_t* pin = reinterpret_cast<microapp_sdk_pin_t*>(payload);
+	if (pin->header.messageType != CS_MICROAPP_SDK_TYPE_PIN || pin->value >= MAX_WRITES) {
+		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+	}
+	handledWrites[pin->value]++;
+	return (pin->value == FAILING_VALUE) ? CS_MICROAPP_SDK_ACK_ERR_BUSY : CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+static void handleBatch(uint8_t* payload) {
+	microapp_sdk_batch_header_t* batchHeader = reinterpret_cast<microapp_sdk_batch_header_t*>(payload);
+	if (mode == FAKE_BLUENET_NO_BATCHES) {
+		// Unknown message types are left as they are
+		return;
+	}
+	if (mode == FAKE_BLUENET_BUSY_ONCE && !busyDone) {
+		busyDone                 = true;
+		batchHeader->header.ack = CS_MICROAPP_SDK_ACK_ERR_BUSY;
+		return;
+	}
+	microapp_size_t offset = sizeof(microapp_sdk_batch_header_t);
+	for (uint8_t i = 0; i < batchHeader->count; ++i) {
+		uint8_t* entry                = &payload[offset + 1];
+		microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(entry);
+		header->ack                   = handleRequest(entry);
+		offset += 1 + payload[offset];
+	}
+	batchHeader->header.ack = CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+static microapp_sdk_result_t fakeCallback(uint8_t opcode, bluenet_io_buffers_t* buffers) {
+	if (opcode != CS_MICROAPP_CALLBACK_SIGNAL) {
+		return CS_MICROAPP_SDK_ACK_SUCCESS;
+	}
+	roundtrips++;
+	uint8_t* payload              = buffers->microapp2bluenet.payload;
+	microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(payload);
+	if (header->messageType == MICROAPP_SDK_TYPE_BATCH) {
+		handleBatch(payload);
+	}
+	else {
+		header->ack = handleRequest(payload);
+	}
+	// No interrupts
+	microapp_sdk_header_t* incoming = reinterpret_cast<microapp_sdk_header_t*>(buffers->bluenet2microapp.payload);
+	incoming->ack                   = CS_MICROAPP_SDK_ACK_NO_REQUEST;
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+/*
+ * Replaces the IPC RAM data of bluenet: the only data the microapp reads from it is the callback.
+ */
+uint8_t getRamData(uint8_t index, uint8_t* data, uint8_t* size, uint8_t maxSize) {
+	if (index != IPC_INDEX_BLUENET_TO_MICROAPP || maxSize < sizeof(bluenet2microapp_ipcdata_t)) {
+		return 1;
+	}
+	bluenet2microapp_ipcdata_t* ipcData = reinterpret_cast<bluenet2microapp_ipcdata_t*>(data);
+	*ipcData                            = bluenet2microapp_ipcdata_t();
+	ipcData->dataProtocol               = MICROAPP_IPC_DATA_PROTOCOL;
+	ipcData->microappCallback           = fakeCallback;
+	*size                               = sizeof(bluenet2microapp_ipcdata_t);
+	return 0;
+}
+
+static void writePin(uint8_t value) {
+	microapp_sdk_pin_t* pin = reinterpret_cast<microapp_sdk_pin_t*>(getOutgoingMessagePayload());
+	*pin                    = microapp_sdk_pin_t();
+	pin->header.messageType = CS_MICROAPP_SDK_TYPE_PIN;
+	pin->header.ack         = CS_MICROAPP_SDK_ACK_REQUEST;
+	pin->pin                = CS_MICROAPP_SDK_PIN_LED1;
+	pin->type               = CS_MICROAPP_SDK_PIN_ACTION;
+	pin->action             = CS_MICROAPP_SDK_PIN_WRITE;
+	pin->value              = value;
+	sendMessage();
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char* name, const char* what) {
+	if (!condition) {
+		printf("FAIL %s: %s\n", name, what);
+		failures++;
+	}
+}
+
+/*
+ * Commit a batch of writes, and check that each write is handled once, with the right ack.
+ */
+static void runBatch(const char* name, fake_bluenet_mode_t fakeMode, int expectedRoundtrips) {
+	mode       = fakeMode;
+	roundtrips = 0;
+	for (int i = 0; i < MAX_WRITES; ++i) {
+		handledWrites[i] = 0;
+	}
+	beginBatch();
+	for (int i = 0; i < MAX_WRITES; ++i) {
+		writePin(i);
+	}
+	check(roundtrips == 0, name, "writes are queued until the commit");
+	microapp_sdk_result_t result = commitBatch();
+	printf("%-22s %2d writes in %2d roundtrips\n", name, MAX_WRITES, roundtrips);
+
+	check(roundtrips == expectedRoundtrips, name, "number of roundtrips");
+	check(result == CS_MICROAPP_SDK_ACK_ERR_BUSY, name, "commit returns the first failed ack");
+	check(batchSize() == MAX_WRITES, name, "batch size");
+	for (int i = 0; i < MAX_WRITES; ++i) {
+		check(handledWrites[i] == 1, name, "each write is handled once");
+		microapp_sdk_result_t expected =
+				(i == FAILING_VALUE) ? CS_MICROAPP_SDK_ACK_ERR_BUSY : CS_MICROAPP_SDK_ACK_SUCCESS;
+		check(batchResult(i) == expected, name, "ack of each write");
+	}
+}
+
+int main() {
+	// Without a batch, each write is a roundtrip
+	roundtrips = 0;
+	for (int i = 0; i < MAX_WRITES; ++i) {
+		writePin(i);
+	}
+	printf("%-22s %2d writes in %2d roundtrips\n", "Without batch", MAX_WRITES, roundtrips);
+	check(roundtrips == MAX_WRITES, "Without batch", "number of roundtrips");
+
+	runBatch("Batches supported", FAKE_BLUENET_BATCHES, 1);
+	// The refused batch, and then each write
+	runBatch("Busy bluenet", FAKE_BLUENET_BUSY_ONCE, 1 + MAX_WRITES);
+	// The batch is still sent when bluenet was busy before
+	runBatch("Batches supported", FAKE_BLUENET_BATCHES, 1);
+	// The unknown batch, and then each write
+	runBatch("Batches not supported", FAKE_BLUENET_NO_BATCHES, 1 + MAX_WRITES);
+	// Once bluenet turned out not to know batches, they are no longer tried
+	runBatch("Batches not supported", FAKE_BLUENET_NO_BATCHES, MAX_WRITES);
+
+	if (failures != 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
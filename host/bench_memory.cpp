@@ -0,0 +1,214 @@
+/**
+ * Correctness and throughput benchmark of the memory functions in src/memory.c.
+ *
+ * Runs on the host, see the bench_memory target in the Makefile. The functions under test are compiled with a
+ * microapp_ prefix, so that they do not replace those of the C library, which are used as reference.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cs_MicroappStructs.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+typedef uint16_t microapp_size_t;
+
+extern "C" {
+uint8_t microapp_strlen(const char* str);
+int microapp_memcmp(const void* ptr1, const void* ptr2, microapp_size_t num);
+void* microapp_memcpy(void* dest, const void* src, microapp_size_t num);
+void* microapp_memset(void* dest, int value, microapp_size_t num);
+void* microapp_memmove(void* dest, const void* src, microapp_size_t num);
+}
+
+// Byte-by-byte implementation, as it was before, to compare the throughput against.
+__attribute__((noinline)) void* byteMemcpy(void* dest, const void* src, microapp_size_t num) {
+	const volatile uint8_t* p = (const uint8_t*)src;
+	volatile uint8_t* q       = (uint8_t*)dest;
+	for (microapp_size_t i = 0; i < num; ++i) {
+		q[i] = p[i];
+	}
+	return dest;
+}
+
+// Largest size that is tested, larger than the payload of a message.
+static const int MAX_SIZE    = 300;
+// Bytes around the tested range that should not be touched.
+static const int GUARD       = 16;
+static const int BUFFER_SIZE = MAX_SIZE + 2 * GUARD + 8;
+// Maximum string length, see MAX_STRING_SIZE.
+static const int MAX_STRING  = MICROAPP_SDK_MAX_STRING_LENGTH;
+
+static int failures = 0;
+
+static void fail(const char* function, int size, int destOffset, int srcOffset) {
+	if (failures < 20) {
+		printf("FAIL %s size=%d dest offset=%d src offset=%d\n", function, size, destOffset, srcOffset);
+	}
+	failures++;
+}
+
+static void fillPattern(uint8_t* buf, int size, int seed) {
+	for (int i = 0; i < size; ++i) {
+		buf[i] = (uint8_t)(i * 7 + seed * 13 + 1);
+	}
+}
+
+static void checkMemcpy() {
+	alignas(8) uint8_t src[BUFFER_SIZE];
+	alignas(8) uint8_t dest[BUFFER_SIZE];
+	alignas(8) uint8_t expected[BUFFER_SIZE];
+	for (int size = 0; size <= MAX_SIZE; ++size) {
+		for (int destOffset = 0; destOffset < 4; ++destOffset) {
+			for (int srcOffset = 0; srcOffset < 4; ++srcOffset) {
+				fillPattern(src, BUFFER_SIZE, 1);
+				fillPattern(dest, BUFFER_SIZE, 2);
+				memcpy(expected, dest, BUFFER_SIZE);
+				memcpy(expected + GUARD + destOffset, src + GUARD + srcOffset, size);
+				void* result = microapp_memcpy(dest + GUARD + destOffset, src + GUARD + srcOffset, size);
+				if (result != dest + GUARD + destOffset || memcmp(dest, expected, BUFFER_SIZE) != 0) {
+					fail("memcpy", size, destOffset, srcOffset);
+				}
+			}
+		}
+	}
+}
+
+static void checkMemset() {
+	alignas(8) uint8_t dest[BUFFER_SIZE];
+	alignas(8) uint8_t expected[BUFFER_SIZE];
+	for (int size = 0; size <= MAX_SIZE; ++size) {
+		for (int destOffset = 0; destOffset < 4; ++destOffset) {
+			fillPattern(dest, BUFFER_SIZE, 3);
+			memcpy(expected, dest, BUFFER_SIZE);
+			memset(expected + GUARD + destOffset, 0x1A5, size);
+			void* result = microapp_memset(dest + GUARD + destOffset, 0x1A5, size);
+			if (result != dest + GUARD + destOffset || memcmp(dest, expected, BUFFER_SIZE) != 0) {
+				fail("memset", size, destOffset, 0);
+			}
+		}
+	}
+}
+
+static void checkMemmove() {
+	alignas(8) uint8_t buf[BUFFER_SIZE];
+	alignas(8) uint8_t expected[BUFFER_SIZE];
+	for (int size = 0; size <= MAX_SIZE - GUARD; size += (size < 40) ? 1 : 7) {
+		for (int destOffset = 0; destOffset < 2 * GUARD; ++destOffset) {
+			for (int srcOffset = 0; srcOffset < 2 * GUARD; ++srcOffset) {
+				fillPattern(buf, BUFFER_SIZE, 4);
+				memcpy(expected, buf, BUFFER_SIZE);
+				memmove(expected + destOffset, expected + srcOffset, size);
+				void* result = microapp_memmove(buf + destOffset, buf + srcOffset, size);
+				if (result != buf + destOffset || memcmp(buf, expected, BUFFER_SIZE) != 0) {
+					fail("memmove", size, destOffset, srcOffset);
+				}
+			}
+		}
+	}
+}
+
+static int sign(int value) {
+	return (value > 0) - (value < 0);
+}
+
+static void checkMemcmp() {
+	alignas(8) uint8_t a[BUFFER_SIZE];
+	alignas(8) uint8_t b[BUFFER_SIZE];
+	for (int size = 0; size <= MAX_SIZE; size += (size < 40) ? 1 : 5) {
+		for (int offsetA = 0; offsetA < 4; ++offsetA) {
+			for (int offsetB = 0; offsetB < 4; ++offsetB) {
+				fillPattern(a, BUFFER_SIZE, 5);
+				fillPattern(b, BUFFER_SIZE, 6);
+				uint8_t* p = a + GUARD + offsetA;
+				uint8_t* q = b + GUARD + offsetB;
+				memcpy(q, p, size);
+				if (microapp_memcmp(p, q, size) != 0) {
+					fail("memcmp equal", size, offsetA, offsetB);
+				}
+				// Change every byte in turn, both up and down, including the sign bit
+				for (int i = 0; i < size; i += (size < 40) ? 1 : 3) {
+					uint8_t original = q[i];
+					const uint8_t values[] = {
+							(uint8_t)(original + 1), (uint8_t)(original - 1), (uint8_t)(original ^ 0x80)};
+					for (uint8_t value : values) {
+						q[i] = value;
+						if (microapp_memcmp(p, q, size) != sign(memcmp(p, q, size))) {
+							fail("memcmp", size, offsetA, offsetB);
+						}
+					}
+					q[i] = original;
+				}
+			}
+		}
+	}
+}
+
+static void checkStrlen() {
+	alignas(8) char str[MAX_STRING + 2 * GUARD];
+	for (int length = 0; length <= MAX_STRING + GUARD; ++length) {
+		for (int offset = 0; offset < 4; ++offset) {
+			memset(str, 'a', sizeof(str));
+			if (offset + length < (int)sizeof(str)) {
+				str[offset + length] = 0;
+			}
+			int expected = (length < MAX_STRING) ? length : MAX_STRING;
+			if (microapp_strlen(str + offset) != expected) {
+				fail("strlen", length, offset, 0);
+			}
+		}
+	}
+}
+
+typedef void* (*copyFunction)(void*, const void*, microapp_size_t);
+
+// Returns the throughput in MB/s.
+static double measureCopy(copyFunction function, int size, int destOffset, int srcOffset) {
+	alignas(8) static uint8_t src[BUFFER_SIZE];
+	alignas(8) static uint8_t dest[BUFFER_SIZE];
+	const int repetitions = 200000;
+	auto start            = std::chrono::steady_clock::now();
+	for (int i = 0; i < repetitions; ++i) {
+		function(dest + destOffset, src + srcOffset, size);
+		// Prevent the copies from being optimized away
+		asm volatile("" : : "r"(dest) : "memory");
+	}
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return (double)size * repetitions / duration.count() / 1e6;
+}
+
+static void benchmark() {
+	const int sizes[] = {4, 16, 64, 256};
+	printf("\n%-6s %-10s %12s %12s %8s\n", "size", "alignment", "bytes MB/s", "words MB/s", "speedup");
+	for (int size : sizes) {
+		const int offsets[][2] = {{0, 0}, {1, 1}, {0, 1}, {3, 2}};
+		for (auto& offset : offsets) {
+			double byteRate = measureCopy(byteMemcpy, size, offset[0], offset[1]);
+			double wordRate = measureCopy(microapp_memcpy, size, offset[0], offset[1]);
+			char alignment[16];
+			snprintf(alignment, sizeof(alignment), "%d/%d", offset[0], offset[1]);
+			printf("%-6d %-10s %12.0f %12.0f %7.1fx\n", size, alignment, byteRate, wordRate, wordRate / byteRate);
+		}
+	}
+}
+
+int main() {
+	checkMemcpy();
+	checkMemset();
+	checkMemmove();
+	checkMemcmp();
+	checkStrlen();
+	if (failures) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	benchmark();
+	return 0;
+}
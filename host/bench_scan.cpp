@@ -0,0 +1,370 @@
+/**
+ * Correctness and throughput benchmark of the advertisement queries in src/BleScan.cpp.
+ *
+ * Runs on the host, see the bench_scan target in the Makefile. A handler that queries the name, the service UUIDs,
+ * the service data and the manufacturer data of a scan is run over a corpus of advertisements, once by parsing the
+ * scan data for each query like before, and once with an index of the scan data that is built on the first query.
+ * The accessors for service data, manufacturer data and service uuids of all sizes are checked on known values.
+ *
+ * Next, the beacon formats in the corpus are decoded by a BeaconDispatcher, and by a chain of ifs that tests the
+ * formats one after the other.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <BleBeacon.h>
+#include <BleScan.h>
+
+#include <chrono>
+#include <cstdio>
+
+struct advertisement_t {
+	const char* name;
+	const char* hex;
+};
+
+// Advertisements as they are seen in an office, by type of device.
+static const advertisement_t corpus[] = {
+		{"iBeacon", "0201061AFF4C000215E2C56DB5DFFB48D2B060D0F5A71096E000010002C5"},
+		{"Eddystone UID", "0201060303AAFE1516AAFE00EE0102030405060708090A000000000001"},
+		{"Eddystone URL", "0201060303AAFE1116AAFE10EE0363726F776E73746F6E6507"},
+		{"Eddystone TLM", "0201060303AAFE1116AAFE2000 0BB81900000012340000ABCD"},
+		{"ATC thermometer", "0201060F161A18A4C1389A45E300E6321A0B8F250B09415443203941343545"},
+		{"Apple continuity", "02011A0AFF4C0010051B1C0E7A29"},
+		{"Apple AirPods", "1EFF4C000719010F2022F58F0100000000000000000000000000000000000000"},
+		{"Tile", "02010603039EFE1716EDFE01000000C000E4F5A1B2C3D4E5F60102030405"},
+		{"Google Fast Pair", "0201060303 2CFE06162CFE00B7270B0A09476F6F676C65"},
+		{"Swift Pair", "0201061EFF0600030080544553542D4D4F555345000000000000000000000000"},
+		{"Heart rate", "020106030D18050209486561727420526174650000"},
+		{"Crownstone", "0201060303C0FF1316C0FF01020304050607080910111213141516"},
+		{"Fitbit", "02010611070BA69F3E6C3B4F8AB34A45C8D95ACB080943686172676535"},
+		{"Samsung", "0201041BFF7500420401806060E6A1B2C3D4E5F601000000000000000000"},
+		{"Nameless", "02011A"},
+		{"Multi service data", "0201060516AAFE01020716 1A1803040506072078563412ABCD"},
+		{"PVVX thermometer", "0201061216 1A18E3459A38C1A4E6081C118F0B502A05"},
+};
+
+static const int CORPUS_SIZE = sizeof(corpus) / sizeof(corpus[0]);
+
+struct scan_t {
+	uint8_t data[MAX_BLE_ADV_DATA_LENGTH];
+	uint8_t size;
+};
+
+static scan_t scans[CORPUS_SIZE];
+
+static void parseCorpus() {
+	for (int i = 0; i < CORPUS_SIZE; ++i) {
+		scan_t& scan     = scans[i];
+		scan.size        = 0;
+		const char* text = corpus[i].hex;
+		while (text[0] != 0 && text[1] != 0 && scan.size < MAX_BLE_ADV_DATA_LENGTH) {
+			if (text[0] == ' ') {
+				text++;
+				continue;
+			}
+			unsigned int byte;
+			sscanf(text, "%2x", &byte);
+			scan.data[scan.size++] = byte;
+			text += 2;
+		}
+	}
+}
+
+// Parses the scan data for every query, as it was before.
+__attribute__((noinline)) static bool walkFind(const uint8_t* scanData, uint8_t scanSize, GapAdvType type, ble_ad_t* foundData) {
+	uint8_t i       = 0;
+	foundData->type = 0;
+	foundData->data = nullptr;
+	foundData->len  = 0;
+	while (i < scanSize - 1) {
+		uint8_t fieldLen  = scanData[i];
+		uint8_t fieldType = scanData[i + 1];
+		if (fieldLen == 0 || i + 1 + fieldLen > scanSize) {
+			return false;
+		}
+		if (fieldType == type) {
+			foundData->data = &scanData[i + 2];
+			foundData->len  = fieldLen - 1;
+			foundData->type = (uint8_t)type;
+			return true;
+		}
+		i += fieldLen + 1;
+	}
+	return false;
+}
+
+// Result of the queries of a handler, to check that both ways give the same answers.
+struct result_t {
+	uint32_t sum;
+	uint8_t nameLength;
+	uint8_t uuidCount;
+};
+
+static result_t walkHandler(const scan_t& scan) {
+	result_t result = {0, 0, 0};
+	ble_ad_t ad;
+	if (walkFind(scan.data, scan.size, CompleteLocalName, &ad) || walkFind(scan.data, scan.size, ShortenedLocalName, &ad)) {
+		result.nameLength = ad.len;
+	}
+	const GapAdvType listTypes[2] = {IncompleteList16BitServiceUuids, CompleteList16BitServiceUuids};
+	for (GapAdvType listType : listTypes) {
+		if (walkFind(scan.data, scan.size, listType, &ad)) {
+			result.uuidCount += ad.len / UUID_16BIT_BYTE_LENGTH;
+		}
+	}
+	for (uint8_t index = 0; index < result.uuidCount; ++index) {
+		uint8_t count = 0;
+		for (GapAdvType listType : listTypes) {
+			if (walkFind(scan.data, scan.size, listType, &ad)) {
+				for (uint8_t j = 0; j + 1 < ad.len; j += 2, ++count) {
+					if (count == index) {
+						result.sum += (ad.data[j + 1] << 8) | ad.data[j];
+					}
+				}
+			}
+		}
+	}
+	if (walkFind(scan.data, scan.size, ServiceData16BitUuid, &ad)) {
+		result.sum += ad.len;
+	}
+	if (walkFind(scan.data, scan.size, ManufacturerSpecificData, &ad)) {
+		result.sum += ad.len;
+	}
+	return result;
+}
+
+static result_t indexHandler(const scan_t& scan) {
+	result_t result = {0, 0, 0};
+	// Built on the first query, like BleDevice does
+	ble_ad_index_t index;
+	BleScan::buildIndex(scan.data, scan.size, index);
+	result.nameLength = BleScan::localName(scan.data, index).len;
+	result.uuidCount  = BleScan::serviceUuidCount(scan.data, index);
+	for (uint8_t i = 0; i < result.uuidCount; ++i) {
+		result.sum += BleScan::serviceUuid(scan.data, index, i);
+	}
+	ble_ad_t ad;
+	if (BleScan::findAdvertisementDataType(scan.data, index, ServiceData16BitUuid, &ad)) {
+		result.sum += ad.len;
+	}
+	if (BleScan::findAdvertisementDataType(scan.data, index, ManufacturerSpecificData, &ad)) {
+		result.sum += ad.len;
+	}
+	return result;
+}
+
+static const scan_t& findScan(const char* name) {
+	for (int i = 0; i < CORPUS_SIZE; ++i) {
+		// The string functions are those of the microapp library
+		if (strlen(corpus[i].name) == strlen(name) && memcmp(corpus[i].name, name, strlen(name)) == 0) {
+			return scans[i];
+		}
+	}
+	return scans[0];
+}
+
+static void check(bool condition, const char* name, const char* what, int& failures) {
+	if (!condition) {
+		printf("FAIL %s: %s\n", name, what);
+		failures++;
+	}
+}
+
+// Checks the accessors for the other AD types on known values.
+static int checkAccessors() {
+	int failures = 0;
+	ble_ad_index_t index;
+	ble_service_data_t serviceData;
+	ble_manufacturer_data_t manufacturerData;
+	uint8_t cursor;
+
+	const scan_t& iBeacon = findScan("iBeacon");
+	BleScan::buildIndex(iBeacon.data, iBeacon.size, index);
+	check(BleScan::findManufacturerData(iBeacon.data, index, 0x004C, &manufacturerData), "iBeacon", "apple", failures);
+	check(manufacturerData.len == 23 && manufacturerData.data[0] == 0x02, "iBeacon", "apple data", failures);
+	check(!BleScan::findManufacturerData(iBeacon.data, index, 0x0006, &manufacturerData), "iBeacon", "microsoft", failures);
+	check(!BleScan::findServiceData(iBeacon.data, index, 0xFEAA, &serviceData), "iBeacon", "service data", failures);
+
+	const scan_t& fitbit = findScan("Fitbit");
+	BleScan::buildIndex(fitbit.data, fitbit.size, index);
+	check(BleScan::serviceUuidCount(fitbit.data, index, UUID_128BIT_BYTE_LENGTH) == 1, "Fitbit", "128 bit uuids", failures);
+	check(BleScan::serviceUuidCount(fitbit.data, index, UUID_16BIT_BYTE_LENGTH) == 0, "Fitbit", "16 bit uuids", failures);
+	const uint8_t* uuid = BleScan::serviceUuidBytes(fitbit.data, index, UUID_128BIT_BYTE_LENGTH, 0);
+	check(uuid != nullptr && uuid[0] == 0x0B && uuid[15] == 0x08, "Fitbit", "128 bit uuid", failures);
+	check(BleScan::serviceUuidBytes(fitbit.data, index, UUID_128BIT_BYTE_LENGTH, 1) == nullptr, "Fitbit", "end", failures);
+
+	const scan_t& multi = findScan("Multi service data");
+	BleScan::buildIndex(multi.data, multi.size, index);
+	const uint8_t expectedUuidLengths[] = {UUID_16BIT_BYTE_LENGTH, UUID_16BIT_BYTE_LENGTH, UUID_32BIT_BYTE_LENGTH};
+	const uint8_t expectedLengths[]     = {2, 4, 2};
+	uint8_t count                       = 0;
+	cursor                              = 0;
+	while (BleScan::nextServiceData(multi.data, index, cursor, &serviceData)) {
+		check(count < 3 && serviceData.uuidLength == expectedUuidLengths[count] && serviceData.len == expectedLengths[count],
+			  "Multi service data",
+			  "entry",
+			  failures);
+		count++;
+	}
+	check(count == 3, "Multi service data", "count", failures);
+	check(BleScan::findServiceData(multi.data, index, 0x181A, &serviceData) && serviceData.data[0] == 0x03,
+		  "Multi service data",
+		  "find",
+		  failures);
+	return failures;
+}
+
+// Sums fields of the decoded beacons, to check that both ways decode the same.
+struct BeaconSum {
+	uint32_t sum    = 0;
+	uint8_t decoded = 0;
+
+	void operator()(const ble_ibeacon_t& beacon) {
+		sum += beacon.major + beacon.minor + beacon.uuid[0];
+		decoded++;
+	}
+	void operator()(const ble_eddystone_uid_t& beacon) {
+		sum += beacon.instanceId[5] + beacon.txPower;
+		decoded++;
+	}
+	void operator()(const ble_eddystone_tlm_t& beacon) {
+		sum += beacon.batteryMv + beacon.uptime;
+		decoded++;
+	}
+	void operator()(const ble_thermometer_t& thermometer) {
+		sum += thermometer.temperature + thermometer.humidity + thermometer.mac[0];
+		decoded++;
+	}
+};
+
+typedef BeaconDispatcher<IBeaconDecoder, EddystoneUidDecoder, EddystoneTlmDecoder, AtcThermometerDecoder, PvvxThermometerDecoder>
+		Dispatcher;
+
+static result_t dispatchHandler(const scan_t& scan) {
+	BeaconSum beaconSum;
+	Dispatcher::dispatch(scan.data, scan.size, beaconSum);
+	return {beaconSum.sum, 0, beaconSum.decoded};
+}
+
+// Tests the formats one after the other, like scanner microapps did.
+template <class Decoder>
+static bool chainDecode(const uint8_t* data, uint8_t len, BeaconSum& beaconSum) {
+	typename Decoder::Result result;
+	if (Decoder::matches(data, len) && Decoder::decode(data, len, result)) {
+		beaconSum(result);
+		return true;
+	}
+	return false;
+}
+
+static result_t chainHandler(const scan_t& scan) {
+	BeaconSum beaconSum;
+	ble_ad_index_t index;
+	BleScan::buildIndex(scan.data, scan.size, index);
+	ble_manufacturer_data_t manufacturerData;
+	ble_service_data_t serviceData;
+	if (BleScan::findManufacturerData(scan.data, index, 0x004C, &manufacturerData)) {
+		chainDecode<IBeaconDecoder>(manufacturerData.data, manufacturerData.len, beaconSum);
+	}
+	if (BleScan::findServiceData(scan.data, index, 0xFEAA, &serviceData)) {
+		chainDecode<EddystoneUidDecoder>(serviceData.data, serviceData.len, beaconSum)
+				|| chainDecode<EddystoneTlmDecoder>(serviceData.data, serviceData.len, beaconSum);
+	}
+	if (BleScan::findServiceData(scan.data, index, 0x181A, &serviceData)) {
+		chainDecode<AtcThermometerDecoder>(serviceData.data, serviceData.len, beaconSum)
+				|| chainDecode<PvvxThermometerDecoder>(serviceData.data, serviceData.len, beaconSum);
+	}
+	return {beaconSum.sum, 0, beaconSum.decoded};
+}
+
+// Checks the decoded fields of known beacons.
+static int checkBeacons() {
+	int failures = 0;
+	uint8_t expectedDecoded = 0;
+	for (int i = 0; i < CORPUS_SIZE; ++i) {
+		result_t dispatched = dispatchHandler(scans[i]);
+		result_t chained    = chainHandler(scans[i]);
+		check(dispatched.sum == chained.sum && dispatched.uuidCount == chained.uuidCount, corpus[i].name, "beacons", failures);
+		expectedDecoded += dispatched.uuidCount;
+	}
+	// iBeacon, Eddystone UID and TLM, and PVVX thermometer
+	check(expectedDecoded == 4, "corpus", "decoded beacons", failures);
+
+	struct ThermometerCheck {
+		ble_thermometer_t thermometer = {};
+		void operator()(const ble_thermometer_t& result) { thermometer = result; }
+	} thermometerCheck;
+	const scan_t& pvvx = findScan("PVVX thermometer");
+	check(BeaconDispatcher<PvvxThermometerDecoder>::dispatch(pvvx.data, pvvx.size, thermometerCheck) == 1, "PVVX", "dispatch", failures);
+	check(thermometerCheck.thermometer.temperature == 2278 && thermometerCheck.thermometer.humidity == 4380
+				  && thermometerCheck.thermometer.batteryMv == 2959 && thermometerCheck.thermometer.mac[5] == 0xA4,
+		  "PVVX",
+		  "fields",
+		  failures);
+	return failures;
+}
+
+typedef result_t (*handlerFunction)(const scan_t&);
+
+// Returns the number of nanoseconds per scan.
+static double measure(handlerFunction handler, const scan_t& scan) {
+	const int repetitions = 1000000;
+	uint32_t sum          = 0;
+	auto start            = std::chrono::steady_clock::now();
+	for (int i = 0; i < repetitions; ++i) {
+		sum += handler(scan).sum;
+		// Prevent the queries from being optimized away
+		asm volatile("" : "+r"(sum) : : "memory");
+	}
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return duration.count() * 1e9 / repetitions;
+}
+
+int main() {
+	parseCorpus();
+	int failures = 0;
+	for (int i = 0; i < CORPUS_SIZE; ++i) {
+		result_t walk  = walkHandler(scans[i]);
+		result_t index = indexHandler(scans[i]);
+		if (walk.sum != index.sum || walk.nameLength != index.nameLength || walk.uuidCount != index.uuidCount) {
+			printf("FAIL %s\n", corpus[i].name);
+			failures++;
+		}
+	}
+	failures += checkAccessors();
+	failures += checkBeacons();
+	if (failures) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+
+	printf("\n%-18s %6s %10s %10s %8s\n", "advertisement", "size", "walk ns", "index ns", "speedup");
+	double walkTotal  = 0;
+	double indexTotal = 0;
+	for (int i = 0; i < CORPUS_SIZE; ++i) {
+		double walk  = measure(walkHandler, scans[i]);
+		double index = measure(indexHandler, scans[i]);
+		walkTotal += walk;
+		indexTotal += index;
+		printf("%-18s %6u %10.1f %10.1f %7.1fx\n", corpus[i].name, scans[i].size, walk, index, walk / index);
+	}
+	printf("%-18s %6s %10.1f %10.1f %7.1fx\n", "total", "", walkTotal, indexTotal, walkTotal / indexTotal);
+
+	printf("\n%-18s %6s %10s %10s %8s\n", "advertisement", "size", "chain ns", "dispatch ns", "speedup");
+	double chainTotal    = 0;
+	double dispatchTotal = 0;
+	for (int i = 0; i < CORPUS_SIZE; ++i) {
+		double chain    = measure(chainHandler, scans[i]);
+		double dispatch = measure(dispatchHandler, scans[i]);
+		chainTotal += chain;
+		dispatchTotal += dispatch;
+		printf("%-18s %6u %10.1f %10.1f %7.1fx\n", corpus[i].name, scans[i].size, chain, dispatch, chain / dispatch);
+	}
+	printf("%-18s %6s %10.1f %10.1f %7.1fx\n", "total", "", chainTotal, dispatchTotal, chainTotal / dispatchTotal);
+	return 0;
+}
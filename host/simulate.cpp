@@ -0,0 +1,78 @@
+/**
+ * Runs a microapp on the host, against a simulated bluenet. See the host target in the Makefile.
+ *
+ * Usage: <microapp> [--ticks N] [--stone-id N] [--trace file] [script]
+ *        <microapp> --replay file
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include "Simulator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Default number of ticks to run.
+static const uint32_t DEFAULT_TICKS = 100;
+
+static void usage(const char* name) {
+	printf("Usage: %s [--ticks N] [--stone-id N] [--trace file] [script]\n", name);
+	printf("       %s --replay file\n", name);
+	printf("  --ticks N      number of ticks of %u ms to run, default %u\n", MICROAPP_LOOP_INTERVAL_MS, DEFAULT_TICKS);
+	printf("  --stone-id N   stone id of the simulated crownstone, default 1\n");
+	printf("  --trace file   record the messages of the microapp, needs a build with TRACING=1\n");
+	printf("  --replay file  replay recorded messages instead of simulating bluenet\n");
+	printf("  script         events to inject, see host/Simulator.h\n");
+}
+
+int main(int argc, char** argv) {
+	uint32_t ticks     = DEFAULT_TICKS;
+	uint8_t stoneId    = 1;
+	const char* script = nullptr;
+	const char* trace  = nullptr;
+	const char* replay = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+			ticks = strtoul(argv[++i], nullptr, 0);
+		}
+		else if (strcmp(argv[i], "--stone-id") == 0 && i + 1 < argc) {
+			stoneId = strtoul(argv[++i], nullptr, 0);
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			trace = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			replay = argv[++i];
+		}
+		else if (argv[i][0] != '-' && script == nullptr) {
+			script = argv[i];
+		}
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	std::vector<sim_event_t> events;
+	if (replay != nullptr) {
+		std::vector<sim_trace_record_t> records;
+		if (!loadTrace(replay, records)) {
+			return 2;
+		}
+		Simulator simulator(events, stoneId);
+		return simulator.replay(records) ? 0 : 1;
+	}
+	if (trace != nullptr && !openTrace(trace)) {
+		return 2;
+	}
+	if (script != nullptr && !parseScript(script, events)) {
+		return 2;
+	}
+
+	Simulator simulator(events, stoneId);
+	return simulator.run(ticks) ? 0 : 1;
+}
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <BleAttributePool.h>
 #include <BleDevice.h>
+#include <BleDeviceTracker.h>
+#include <BleDuplicateFilter.h>
+#include <BleMacAllowlist.h>
 #include <BleScan.h>
+#include <BleScanFilter.h>
+#include <BleScanMerger.h>
+#include <BleScanQueue.h>
+#include <BleScanScheduler.h>
+#include <BleScanStats.h>
+#include <BleScanView.h>
 #include <BleService.h>
 #include <BleUtils.h>
 #include <BleMacAddress.h>
@@ -46,6 +56,7 @@ private:
 	friend microapp_sdk_result_t removeBleEventHandlerRegistration(BleEventType);
 	friend bool registeredBleInterrupt(MicroappSdkBleType);
 	friend microapp_sdk_result_t registerBleInterrupt(MicroappSdkBleType);
+	friend class BleScanView;
 
 	Ble(){};
 
@@ -54,6 +65,20 @@ private:
 		bool initialized = false;
 		//! whether scans are handled
 		bool isScanning = false;
+		//! whether available() has been called, only then scans are queued for it
+		bool pollsScans = false;
+		//! whether duplicate advertisements are handled
+		bool withDuplicates = false;
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+		//! whether scanned devices are tracked, see trackDevices()
+		bool trackDevices = false;
+#endif
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+		//! whether advertisements are merged with their scan response, see mergeScanResponses()
+		bool mergeScanResponses = false;
+#endif
+		//! whether bluenet is stopped by the scan schedule while scanning, see setScanDutyCycle()
+		bool scanPaused = false;
 		bool registeredScanInterrupts = false;
 		bool registeredCentralInterrupts = false;
 		bool registeredPeripheralInterrupts = false;
@@ -62,10 +87,48 @@ private:
 	// Address of the crownstone itself
 	MacAddress _address;
 
-	// Device only used for incoming scans
+	// Device only used for incoming scans that are passed to the BLEDeviceScanned handler
 	// Is overwritten as new scans come in that pass the filter
 	BleDevice _scanDevice;
 
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	// Incoming scans that pass the filter, until polled via available()
+	BleScanQueue _scanQueue;
+#endif
+
+#ifdef MICROAPP_BLE_DUPLICATE_FILTER
+	// Recently scanned devices, to drop duplicate advertisements when scanning without duplicates
+	BleDuplicateFilter _duplicateFilter;
+#endif
+
+	// Filter that is evaluated on incoming scans, see scanWithFilter()
+	BleScanFilter _scanFilter;
+
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	// Recently scanned devices with their filtered RSSI, see trackDevices()
+	BleDeviceTracker _deviceTracker;
+#endif
+
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	// Advertisements that wait for their scan response, see mergeScanResponses()
+	BleScanMerger _scanMerger;
+#endif
+
+	// Counters of incoming scans, see scanStats()
+	BleScanStats _scanStats;
+
+	// Windows in which bluenet passes scans on, see setScanDutyCycle()
+	BleScanScheduler _scanScheduler;
+
+	// Number of ticks between dumps of the scan counters in poll(), 0 to not dump them, see setScanStatsInterval()
+	uint16_t _scanStatsIntervalTicks = 0;
+	uint32_t _scanStatsDumpTick = 0;
+
+#ifdef MICROAPP_MAC_ALLOWLIST
+	// Addresses of which scans are handled, see setAllowlist()
+	BleMacAllowlist _allowlist;
+#endif
+
 	// Remote device acting as peripheral
 	BleDevice _peripheral;
 	BleDevice _central;
@@ -83,8 +146,18 @@ private:
 	BleCharacteristic _remoteCharacteristics[MAX_REMOTE_CHARACTERISTICS];
 	uint8_t _remoteCharacteristicCount = 0;
 
-	// Event handlers set by the user
-	static constexpr uint8_t MAX_BLE_EVENT_HANDLER_REGISTRATIONS = 3;
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+	// All discovered services and characteristics of the peripheral, see BleDevice::attribute()
+	BleAttributePool _attributePool;
+#endif
+
+	// Event handlers set by the user, one per event type. Room for BLEDeviceScanned, BLEConnected and BLEDisconnected,
+	// or handlers of characteristics instead, for BLEDeviceScannedView, and for BLEDevicePresence with the tracker.
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	static constexpr uint8_t MAX_BLE_EVENT_HANDLER_REGISTRATIONS = 5;
+#else
+	static constexpr uint8_t MAX_BLE_EVENT_HANDLER_REGISTRATIONS = 4;
+#endif
 
 	/*
 	 * Store callbacks set by users
@@ -114,6 +187,33 @@ private:
 	 */
 	microapp_sdk_result_t handleScanEvent(microapp_sdk_ble_scan_t* scan);
 
+	/**
+	 * Filter a scan, and pass it to the handlers or the queue.
+	 *
+	 * @param[in] scan the scan, of which the data can be up to MAX_BLE_SCAN_DATA_LENGTH bytes
+	 */
+	void handleScan(const microapp_sdk_ble_scan_event_t& scan);
+
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	/**
+	 * Passes scans from the merger to handleScan().
+	 */
+	static void handleMergedScan(const microapp_sdk_ble_scan_event_t& scan);
+#endif
+
+	/**
+	 * Ask bluenet to start or stop passing scans on.
+	 *
+	 * @param[in] type CS_MICROAPP_SDK_BLE_SCAN_REQUEST_START or CS_MICROAPP_SDK_BLE_SCAN_REQUEST_STOP
+	 * @return true if bluenet acknowledged the request
+	 */
+	bool requestScan(uint8_t type);
+
+	/**
+	 * Starts and stops bluenet scanning according to the scan schedule, at the start of each tick.
+	 */
+	static void handleScanTick();
+
 	/**
 	 * Handles interrupts entering the BLE class from bluenet of the central type
 	 *
@@ -127,6 +227,17 @@ private:
 	 */
 	microapp_sdk_result_t handleCentralEvent(microapp_sdk_ble_central_t* central);
 
+	/**
+	 * Add a discovered service or characteristic to the peripheral as BleService or BleCharacteristic, as far as there
+	 * is space for MAX_REMOTE_SERVICES services
+	 *
+	 * @param[in] central the central packet with the discover event
+	 * @return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE if the service or characteristic cannot be added due to space limitations
+	 * @return CS_MICROAPP_SDK_ACK_SUCCESS upon success
+	 * @return microapp_sdk_result_t specifying other error
+	 */
+	microapp_sdk_result_t addDiscoveredAttribute(microapp_sdk_ble_central_t* central);
+
 	/**
 	 * Handles interrupts entering the BLE class from bluenet of the peripheral type
 	 *
@@ -138,6 +249,30 @@ private:
 	 */
 	microapp_sdk_result_t handlePeripheralEvent(microapp_sdk_ble_peripheral_t* peripheral);
 
+	/**
+	 * Set the remote device acting as peripheral, that is returned by available(), to a scanned device.
+	 *
+	 * @param[in] scan the scanned advertisement
+	 * @return the peripheral device, or a device which evaluates to false, see replacePeripheral()
+	 */
+	BleDevice& setPeripheral(const microapp_sdk_ble_scan_event_t& scan);
+
+	/**
+	 * Replace the remote device acting as peripheral. Refused while a request to the peripheral, like connectAsync(),
+	 * waits for its event: both the future of the request and the event refer to the current peripheral.
+	 *
+	 * @param[in] device the new peripheral
+	 * @return the peripheral device, or a device which evaluates to false if the peripheral was not replaced
+	 */
+	BleDevice& replacePeripheral(const BleDevice& device);
+
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	/**
+	 * Get the registered BLEDevicePresence handler, or nullptr.
+	 */
+	TrackerEventHandler trackerEventHandler();
+#endif
+
 	/**
 	 * Get a characteristic based on its handle (for peripheral role)
 	 *
@@ -187,10 +322,37 @@ public:
 	 * @param[in] callback the callback function to call upon a trigger
 	 *
 	 * @return true on success
-	 * @return false on failure
+	 * @return false on failure, for example when MAX_BLE_EVENT_HANDLER_REGISTRATIONS handlers are registered already
 	 */
 	bool setEventHandler(BleEventType eventType, DeviceEventHandler eventHandler);
 
+	/**
+	 * Registers a callback function for scanned device event triggered within bluenet, which gets a view on the
+	 * advertisement in the interrupt instead of a copy of it, see BleScanView. Scans that are passed to this handler are
+	 * not queued for available(), call BleScanView::device() to get a BleDevice.
+	 *
+	 * @param[in] eventType event type (BLEDeviceScannedView)
+	 * @param[in] callback the callback function to call upon a trigger
+	 *
+	 * @return true on success
+	 * @return false on failure
+	 */
+	bool setEventHandler(BleEventType eventType, ScanViewEventHandler eventHandler);
+
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	/**
+	 * Registers a callback function for devices that enter or leave, see trackDevices(). Starts tracking devices, if
+	 * not started yet. Like other scan handlers, it is called from the scan interrupt.
+	 *
+	 * @param[in] eventType event type (BLEDevicePresence)
+	 * @param[in] callback the callback function to call upon a transition
+	 *
+	 * @return true on success
+	 * @return false on failure
+	 */
+	bool setEventHandler(BleEventType eventType, TrackerEventHandler eventHandler);
+#endif
+
 	/**
 	 * Query if another BLE device is connected
 	 *
@@ -239,8 +401,11 @@ public:
 	/**
 	 * Sends command to bluenet to call registered microapp callback function upon receiving advertisements
 	 * Resets reviously scanned devices.
+	 * Without duplicates, an advertisement of a device that was scanned less than the TTL of the duplicate filter ago
+	 * is dropped, see setDuplicateFilter().
 	 *
-	 * @param[in] withDuplicates  If true, returns duplicate advertisements. (Not implemented)
+	 * @param[in] withDuplicates  If true, returns duplicate advertisements. Duplicates are only dropped when built with
+	 * BLE_DUPLICATE_FILTER=1, see setDuplicateFilter().
 	 *
 	 * @return true on success
 	 * @return false on failure
@@ -252,7 +417,8 @@ public:
 	 *
 	 * @param[in] name            String containing the local name to filter on, advertised as either the complete or
 	 * shortened local name
-	 * @param[in] withDuplicates  If true, returns duplicate advertisements. (Not implemented)
+	 * @param[in] withDuplicates  If true, returns duplicate advertisements. Duplicates are only dropped when built with
+	 * BLE_DUPLICATE_FILTER=1, see setDuplicateFilter().
 	 *
 	 * @return true on success
 	 * @return false on failure
@@ -264,7 +430,8 @@ public:
 	 *
 	 * @param[in] address         MAC address string of the format "AA:BB:CC:DD:EE:FF" to filter on, either lowercase or
 	 * uppercase letters.
-	 * @param[in] withDuplicates  If true, returns duplicate advertisements. (Not implemented)
+	 * @param[in] withDuplicates  If true, returns duplicate advertisements. Duplicates are only dropped when built with
+	 * BLE_DUPLICATE_FILTER=1, see setDuplicateFilter().
 	 *
 	 * @return true on success
 	 * @return false on failure
@@ -276,24 +443,215 @@ public:
 	 *
 	 * @param[in] uuid            16-bit UUID string, e.g. "180D" (Heart Rate), either lowercase or uppercase letters.
 	 * See https://www.bluetooth.com/specifications/assigned-numbers/
-	 * @param[in] withDuplicates  If true, returns duplicate advertisements. (Not implemented)
+	 * @param[in] withDuplicates  If true, returns duplicate advertisements. Duplicates are only dropped when built with
+	 * BLE_DUPLICATE_FILTER=1, see setDuplicateFilter().
 	 *
 	 * @return true on success
 	 * @return false on failure
 	 */
 	bool scanForUuid(const char* uuid, bool withDuplicates = false);
 
+	/**
+	 * Sets a filter with several criteria and calls scan(). See BleScanFilter.
+	 * Replaces the filter of scanForName(), scanForAddress() and scanForUuid(). An empty filter removes any filter.
+	 *
+	 * @param[in] filter          The filter, which is copied.
+	 * @param[in] withDuplicates  If true, returns duplicate advertisements. Duplicates are only dropped when built with
+	 * BLE_DUPLICATE_FILTER=1, see setDuplicateFilter().
+	 *
+	 * @return true on success
+	 * @return false if the filter is not valid, or on failure
+	 */
+	bool scanWithFilter(const BleScanFilter& filter, bool withDuplicates = false);
+
+#ifdef MICROAPP_BLE_DUPLICATE_FILTER
+	/**
+	 * Configure which advertisements are duplicates, when scanning without duplicates.
+	 * Forgets the devices that were scanned before.
+	 *
+	 * @param[in] ttlTicks        Number of ticks after an advertisement of a device during which its advertisements are
+	 * duplicates. Default is 1 second, see DEFAULT_SCAN_DUPLICATE_TTL_TICKS.
+	 * @param[in] compareData     If true, which is the default, advertisements with other data than the last one of
+	 * the device are not duplicates. If false, only the MAC address is compared.
+	 */
+	void setDuplicateFilter(uint16_t ttlTicks, bool compareData = true);
+
+	/**
+	 * Query the number of advertisements that were dropped as duplicate.
+	 *
+	 * @return number of dropped duplicates since startup
+	 */
+	uint16_t duplicateScanCount();
+#endif
+
 	/**
 	 * Sends command to bluenet to stop calling registered microapp callback function upon receiving advertisements
 	 */
 	bool stopScan();
 
 	/**
-	 * Returns last scanned device which matched the filter
+	 * Returns the oldest scanned device which matched the filter, and removes it from the queue of scanned devices.
+	 * Without the queue, see BLE_SCAN_QUEUE in config.mk, returns the last scanned device which matched the filter.
+	 *
+	 * Scans are only queued once available() has been called, so with the queue, the first call returns no device.
+	 * While a request to the last returned device waits for its event, like connectAsync(), no device is returned and
+	 * scans stay queued.
 	 *
-	 * @return BleDevice object representing the discovered device
+	 * @return BleDevice object representing the discovered device, which evaluates to false if there is none
 	 */
 	BleDevice& available();
+
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	/**
+	 * Set what happens to new scans when the queue of scanned devices is full, see BleScanOverflowPolicy.
+	 * The queue holds MAX_SCAN_QUEUE_SIZE devices.
+	 *
+	 * @param[in] policy     The policy, default BleScanDropOldest.
+	 */
+	void setScanOverflowPolicy(BleScanOverflowPolicy policy);
+
+	/**
+	 * Query the number of scanned devices that can be retrieved with available().
+	 *
+	 * @return number of scanned devices in the queue
+	 */
+	uint8_t scanQueueSize();
+
+	/**
+	 * Query the number of scanned devices that were dropped because the queue was full.
+	 *
+	 * @return number of dropped scans since startup
+	 */
+	uint16_t droppedScanCount();
+#endif
+
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	/**
+	 * Merge advertisements with their scan response, so that the handlers get one scan with the data of both, for
+	 * example the local name of the scan response with the service data of the advertisement. This halves the number
+	 * of scans of devices that are scanned actively. The scan filter is applied to the merged scan.
+	 * Only available when built with BLE_MERGE_SCAN_RESPONSES=1, see config.mk.
+	 * Scans wait in a buffer of MAX_SCAN_MERGE_ENTRIES devices, until their scan response comes, or until the window
+	 * has passed. Waiting scans are passed on upon new scans, and on BLE.poll(). See BleScanMerger for how a scan
+	 * response is recognized.
+	 *
+	 * @param[in] merge          True to merge, false to pass every scan on by itself again.
+	 * @param[in] windowTicks    Number of ticks after the tick of an advertisement during which its scan response is
+	 * merged with it.
+	 */
+	void mergeScanResponses(bool merge = true, uint16_t windowTicks = DEFAULT_SCAN_MERGE_WINDOW_TICKS);
+#endif
+
+	/**
+	 * Get a snapshot of the counters of incoming scans: how many were received, filtered, merged, deduplicated and
+	 * delivered, how many BLE interrupts were dropped before they got here, and, when built with PROFILING=1, how long
+	 * the delivery of a scan takes, including the handlers. See ble_scan_stats_t.
+	 *
+	 * @return the counters since startup
+	 */
+	ble_scan_stats_t scanStats();
+
+	/**
+	 * Send a snapshot of scanStats() as a ble_scan_stats_t via Message.write().
+	 *
+	 * @return true if the snapshot was sent
+	 */
+	bool dumpScanStats();
+
+	/**
+	 * Send a snapshot of scanStats() every intervalTicks ticks, from poll(). Call poll() from loop() for this.
+	 *
+	 * @param[in] intervalTicks  Number of ticks between snapshots, 0 to stop sending them.
+	 */
+	void setScanStatsInterval(uint16_t intervalTicks);
+
+	/**
+	 * Only let bluenet pass scans on during a window at the start of each interval, to bound the load of scan
+	 * interrupts. While scanning, bluenet is started and stopped at the start of the ticks, from the yields to bluenet.
+	 * The window shrinks when scans are dropped, see BleScanScheduler, and grows back to windowMs when they are not.
+	 * Applies to all scan methods. The times are rounded up to ticks of MICROAPP_LOOP_INTERVAL_MS.
+	 *
+	 * @param[in] windowMs             Time to scan at the start of each interval.
+	 * @param[in] intervalMs           Time between the starts of the windows, 0 to scan all the time again.
+	 * @param[in] maxScansPerSecond    Maximum number of scans per second from bluenet, 0 for no limit.
+	 */
+	void setScanDutyCycle(uint16_t windowMs, uint16_t intervalMs, uint16_t maxScansPerSecond = 0);
+
+	/**
+	 * Scan as long as fits in a budget of scans per second from bluenet, evaluated every SCAN_BUDGET_INTERVAL_TICKS.
+	 * Same as setScanDutyCycle() with a window as long as the interval.
+	 *
+	 * @param[in] maxScansPerSecond    Maximum number of scans per second from bluenet, 0 to scan all the time again.
+	 */
+	void setScanBudget(uint16_t maxScansPerSecond);
+
+	/**
+	 * Get the current window of the scan schedule, which may be shorter than configured under load.
+	 *
+	 * @return the window in ms, or 0 if there is no schedule
+	 */
+	uint16_t scanWindowMs();
+
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	/**
+	 * Start tracking scanned devices that pass the scan filter, in a table of MAX_TRACKED_DEVICES devices, and forget
+	 * the devices that were tracked. Only available when built with BLE_DEVICE_TRACKER=1, see config.mk.
+	 * A device enters when its filtered RSSI reaches enterRssi, and leaves when its filtered RSSI drops below
+	 * leaveRssi, or when it has not been scanned for timeoutTicks. Register a BLEDevicePresence handler to be informed.
+	 * Timeouts are checked on scans, and on BLE.poll().
+	 *
+	 * @param[in] filter         How the RSSI of the advertisements of a device is filtered.
+	 * @param[in] enterRssi      Filtered RSSI at which a device enters.
+	 * @param[in] leaveRssi      Filtered RSSI below which a device leaves.
+	 * @param[in] timeoutTicks   Number of ticks without advertisements after which a device leaves.
+	 */
+	void trackDevices(
+			BleRssiFilterType filter = BleRssiFilterEma,
+			rssi_t enterRssi         = -90,
+			rssi_t leaveRssi         = -95,
+			uint16_t timeoutTicks    = DEFAULT_TRACKER_TIMEOUT_TICKS);
+
+	/**
+	 * Query the number of present devices, see trackDevices().
+	 */
+	uint8_t trackedDeviceCount();
+
+	/**
+	 * Get a present device, see trackDevices(). The device is updated by scan interrupts.
+	 *
+	 * @param[in] index      Index of the device, from 0 to trackedDeviceCount().
+	 *
+	 * @return the device, or nullptr if the index is out of range.
+	 */
+	const ble_tracked_device_t* trackedDevice(uint8_t index);
+#endif
+
+#ifdef MICROAPP_MAC_ALLOWLIST
+	/**
+	 * Only handle scans of devices of which the address is in a table, before any other filter. The table is
+	 * typically the one generated at build time, with MAC_ALLOWLIST_CSV=<file>:
+	 *
+	 *   BLE.setAllowlist(macAllowlist, macAllowlistSize);
+	 *
+	 * A Bloom filter of the table is built in RAM, see MAC_ALLOWLIST_BLOOM_BYTES, which rejects most other addresses
+	 * without searching the table.
+	 *
+	 * @param[in] table      Addresses in the byte order of bluenet (reversed), sorted by memcmp(). Must stay valid,
+	 * declare it const so that it stays in flash. A null pointer removes the allowlist.
+	 * @param[in] size       Number of addresses.
+	 *
+	 * @return true on success
+	 * @return false if the table is not sorted, the allowlist is then removed.
+	 */
+	bool setAllowlist(const uint8_t (*table)[MAC_ADDRESS_LENGTH], uint16_t size);
+
+	/**
+	 * Query the number of scans of which the address passed the Bloom filter of the allowlist, but was not in it.
+	 *
+	 * @return number of false positives since the allowlist was set
+	 */
+	uint16_t allowlistFalsePositiveCount();
+#endif
 };
 
 #define BLE Ble::getInstance()
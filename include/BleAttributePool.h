@@ -0,0 +1,148 @@
+/*
+ * Compact table of the attributes discovered on a remote device.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <microapp.h>
+
+/*
+ * Maximum number of services and characteristics of a remote device that can be discovered. Set it to the number of
+ * services plus characteristics of the devices to connect to: the ones that do not fit are counted by droppedCount().
+ * Each takes 9 bytes of RAM. Only built in with BLE_ATTRIBUTE_POOL=1, see config.mk.
+ */
+#ifndef MAX_REMOTE_ATTRIBUTES
+#define MAX_REMOTE_ATTRIBUTES 24
+#endif
+
+static_assert(MAX_REMOTE_ATTRIBUTES < 0xFF, "MAX_REMOTE_ATTRIBUTES should fit in an index");
+
+/*
+ * Index returned when no attribute is found.
+ */
+const uint8_t BLE_ATTRIBUTE_NOT_FOUND = 0xFF;
+
+/*
+ * A discovered service or characteristic.
+ */
+struct __attribute__((packed)) ble_attribute_t {
+	//! Short form of the UUID: 16 bits, on the standard base or on a custom base registered with bluenet.
+	microapp_sdk_ble_uuid_t uuid;
+	//! Index in the pool of the service: of the service a characteristic belongs to, or of the service itself.
+	uint8_t service;
+	//! BleCharacteristicProperties of a characteristic, 0 for a service.
+	uint8_t properties;
+	//! Service: first handle of its discovered characteristics. Characteristic: the value handle.
+	uint16_t handle;
+	//! Service: last handle of its discovered characteristics. Characteristic: the CCCD handle, 0 if it has none.
+	uint16_t endHandle;
+};
+
+/**
+ * Services and characteristics of a remote device, in the order in which discovery events come in.
+ *
+ * A service is added when its discovery event comes, or with the first of its characteristics. The handle range of a
+ * service grows with each of its characteristics, from the declaration handle to the value or CCCD handle, so that
+ * the service of a handle can be found without knowing the characteristic.
+ */
+class BleAttributePool {
+private:
+	ble_attribute_t _attributes[MAX_REMOTE_ATTRIBUTES];
+	uint8_t _count        = 0;
+	//! Number of attributes that did not fit.
+	uint8_t _droppedCount = 0;
+
+	/**
+	 * Append an attribute.
+	 *
+	 * @return the index of the attribute, or BLE_ATTRIBUTE_NOT_FOUND if the pool is full
+	 */
+	uint8_t append(const microapp_sdk_ble_uuid_t& uuid, uint8_t properties, uint16_t handle, uint16_t endHandle);
+
+	/**
+	 * Find a characteristic of a service by its value handle or UUID.
+	 *
+	 * @return the index of the characteristic, or BLE_ATTRIBUTE_NOT_FOUND
+	 */
+	uint8_t findCharacteristic(uint8_t service, const microapp_sdk_ble_uuid_t& uuid, uint16_t valueHandle);
+
+public:
+	/**
+	 * Add a discovered service, unless it was added already.
+	 *
+	 * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
+	 * @return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE if the pool is full
+	 */
+	microapp_sdk_result_t addService(const microapp_sdk_ble_uuid_t& uuid);
+
+	/**
+	 * Add a discovered characteristic, and its service if that was not added yet. A characteristic of the service with
+	 * the same value handle or UUID is updated instead, so that discovering again does not add it twice.
+	 *
+	 * @param[in] serviceUuid    UUID of the service the characteristic belongs to.
+	 * @param[in] uuid           UUID of the characteristic.
+	 * @param[in] properties     BleCharacteristicProperties of the characteristic.
+	 * @param[in] valueHandle    Handle of the value.
+	 * @param[in] cccdHandle     Handle of the client characteristic configuration descriptor, 0 if it has none.
+	 *
+	 * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
+	 * @return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE if the pool is full
+	 */
+	microapp_sdk_result_t addCharacteristic(
+			const microapp_sdk_ble_uuid_t& serviceUuid,
+			const microapp_sdk_ble_uuid_t& uuid,
+			uint8_t properties,
+			uint16_t valueHandle,
+			uint16_t cccdHandle);
+
+	/**
+	 * Forget all attributes.
+	 */
+	void clear();
+
+	/**
+	 * Returns the number of attributes, services and characteristics together.
+	 */
+	uint8_t count();
+
+	/**
+	 * Returns the attribute at an index, or a null pointer if there is none.
+	 */
+	const ble_attribute_t* get(uint8_t index);
+
+	/**
+	 * Returns whether the attribute at an index is a service.
+	 */
+	bool isService(uint8_t index);
+
+	/**
+	 * Find a service by UUID.
+	 *
+	 * @return the index of the service, or BLE_ATTRIBUTE_NOT_FOUND
+	 */
+	uint8_t findService(const microapp_sdk_ble_uuid_t& uuid);
+
+	/**
+	 * Find the service of which the handle range holds a handle.
+	 *
+	 * @return the index of the service, or BLE_ATTRIBUTE_NOT_FOUND
+	 */
+	uint8_t findService(uint16_t handle);
+
+	/**
+	 * Find a characteristic by its value or CCCD handle.
+	 *
+	 * @return the index of the characteristic, or BLE_ATTRIBUTE_NOT_FOUND
+	 */
+	uint8_t findCharacteristic(uint16_t handle);
+
+	/**
+	 * Returns the number of discovered attributes that did not fit, since the last clear().
+	 */
+	uint8_t droppedCount();
+};
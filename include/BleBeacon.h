@@ -0,0 +1,348 @@
+/*
+ * Decoders of common beacon formats, and a dispatcher that classifies a scan in a single pass.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleUtils.h>
+#include <BleUuid.h>
+#include <microapp.h>
+
+/*
+ * A decoder is a class with:
+ *   - AD_TYPE:    the AD type the beacon data is in, ServiceData16BitUuid or ManufacturerSpecificData.
+ *   - KEY:        the 16-bit service uuid or company id at the start of that AD structure.
+ *   - Result:     the type of the decoded fields.
+ *   - matches():  whether the data after the key is of this format, for formats that share a key.
+ *   - decode():   extract the fields from the data after the key.
+ * The decoders only read the scan data, the results point into it where fields are larger than a few bytes.
+ */
+
+constexpr uint16_t beaconUint16Le(const uint8_t* data) {
+	return data[0] | (data[1] << 8);
+}
+
+constexpr uint16_t beaconUint16Be(const uint8_t* data) {
+	return (data[0] << 8) | data[1];
+}
+
+constexpr uint32_t beaconUint32Be(const uint8_t* data) {
+	return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+struct ble_ibeacon_t {
+	//! Proximity uuid, 16 bytes, big endian.
+	const uint8_t* uuid;
+	uint16_t major;
+	uint16_t minor;
+	//! Calibrated RSSI at 1 meter.
+	int8_t txPower;
+};
+
+/**
+ * Apple iBeacon: manufacturer data of Apple, with type 0x02 and length 0x15.
+ */
+struct IBeaconDecoder {
+	typedef ble_ibeacon_t Result;
+	static constexpr uint8_t AD_TYPE = ManufacturerSpecificData;
+	static constexpr uint16_t KEY    = 0x004C;
+
+	static constexpr bool matches(const uint8_t* data, uint8_t len) {
+		return len >= 23 && data[0] == 0x02 && data[1] == 0x15;
+	}
+
+	static bool decode(const uint8_t* data, uint8_t len, Result& result) {
+		result.uuid    = data + 2;
+		result.major   = beaconUint16Be(data + 18);
+		result.minor   = beaconUint16Be(data + 20);
+		result.txPower = (int8_t)data[22];
+		return true;
+	}
+};
+
+struct ble_eddystone_uid_t {
+	//! Calibrated RSSI at 0 meter.
+	int8_t txPower;
+	//! Namespace, 10 bytes.
+	const uint8_t* namespaceId;
+	//! Instance, 6 bytes.
+	const uint8_t* instanceId;
+};
+
+/**
+ * Eddystone-UID: service data of 0xFEAA, with frame type 0x00.
+ */
+struct EddystoneUidDecoder {
+	typedef ble_eddystone_uid_t Result;
+	static constexpr uint8_t AD_TYPE = ServiceData16BitUuid;
+	static constexpr uint16_t KEY    = 0xFEAA;
+
+	static constexpr bool matches(const uint8_t* data, uint8_t len) {
+		return len >= 18 && data[0] == 0x00;
+	}
+
+	static bool decode(const uint8_t* data, uint8_t len, Result& result) {
+		result.txPower     = (int8_t)data[1];
+		result.namespaceId = data + 2;
+		result.instanceId  = data + 12;
+		return true;
+	}
+};
+
+struct ble_eddystone_tlm_t {
+	//! Battery voltage in mV, 0 if not supported.
+	uint16_t batteryMv;
+	//! Temperature in 1/256 degrees Celsius, -32768 (0x8000) if not supported.
+	int16_t temperature;
+	//! Number of advertisements since boot.
+	uint32_t advertisementCount;
+	//! Time since boot, in 0.1 seconds.
+	uint32_t uptime;
+};
+
+/**
+ * Eddystone-TLM: service data of 0xFEAA, with frame type 0x20, unencrypted (version 0x00).
+ */
+struct EddystoneTlmDecoder {
+	typedef ble_eddystone_tlm_t Result;
+	static constexpr uint8_t AD_TYPE = ServiceData16BitUuid;
+	static constexpr uint16_t KEY    = 0xFEAA;
+
+	static constexpr bool matches(const uint8_t* data, uint8_t len) {
+		return len >= 14 && data[0] == 0x20 && data[1] == 0x00;
+	}
+
+	static bool decode(const uint8_t* data, uint8_t len, Result& result) {
+		result.batteryMv          = beaconUint16Be(data + 2);
+		result.temperature        = (int16_t)beaconUint16Be(data + 4);
+		result.advertisementCount = beaconUint32Be(data + 6);
+		result.uptime             = beaconUint32Be(data + 10);
+		return true;
+	}
+};
+
+struct ble_thermometer_t {
+	//! MAC address of the thermometer, in the byte order of bluenet (reversed).
+	uint8_t mac[MAC_ADDRESS_LENGTH];
+	//! Temperature in 0.01 degrees Celsius.
+	int16_t temperature;
+	//! Relative humidity in 0.01 %.
+	uint16_t humidity;
+	uint16_t batteryMv;
+	uint8_t batteryPercent;
+	//! Incremented when the measurement changes.
+	uint8_t counter;
+};
+
+/**
+ * Xiaomi thermometer with the ATC firmware (https://github.com/atc1441/ATC_MiThermometer): service data of the
+ * environmental sensing service 0x181A, 13 bytes, big endian.
+ */
+struct AtcThermometerDecoder {
+	typedef ble_thermometer_t Result;
+	static constexpr uint8_t AD_TYPE = ServiceData16BitUuid;
+	static constexpr uint16_t KEY    = 0x181A;
+
+	static constexpr bool matches(const uint8_t* data, uint8_t len) {
+		return len == 13;
+	}
+
+	static bool decode(const uint8_t* data, uint8_t len, Result& result) {
+		for (uint8_t i = 0; i < MAC_ADDRESS_LENGTH; ++i) {
+			result.mac[i] = data[MAC_ADDRESS_LENGTH - 1 - i];
+		}
+		result.temperature    = (int16_t)beaconUint16Be(data + 6) * 10;
+		result.humidity       = data[8] * 100;
+		result.batteryPercent = data[9];
+		result.batteryMv      = beaconUint16Be(data + 10);
+		result.counter        = data[12];
+		return true;
+	}
+};
+
+/**
+ * Xiaomi thermometer with the custom format of the PVVX firmware (https://github.com/pvvx/ATC_MiThermometer): service
+ * data of the environmental sensing service 0x181A, 15 bytes, little endian.
+ */
+struct PvvxThermometerDecoder {
+	typedef ble_thermometer_t Result;
+	static constexpr uint8_t AD_TYPE = ServiceData16BitUuid;
+	static constexpr uint16_t KEY    = 0x181A;
+
+	static constexpr bool matches(const uint8_t* data, uint8_t len) {
+		return len == 15;
+	}
+
+	static bool decode(const uint8_t* data, uint8_t len, Result& result) {
+		memcpy(result.mac, data, MAC_ADDRESS_LENGTH);
+		result.temperature    = (int16_t)beaconUint16Le(data + 6);
+		result.humidity       = beaconUint16Le(data + 8);
+		result.batteryMv      = beaconUint16Le(data + 10);
+		result.batteryPercent = data[12];
+		result.counter        = data[13];
+		return true;
+	}
+};
+
+struct ble_asset_report_t {
+	//! Id of the asset, 24 bits.
+	uint32_t assetId;
+	//! RSSI at which the Crownstone that reported it scanned the asset.
+	int8_t rssi;
+};
+
+/**
+ * Asset report of a Crownstone: a mesh message of type MESH_MSG_TYPE, sent when a Crownstone scanned an asset that
+ * passed its asset filters. It is not advertised, so it cannot be passed to a BeaconDispatcher: decode the message
+ * of an EVT_RECV_MESH_MSG event of BluenetInternal instead, see examples/tests/asset_tracker.ino.
+ */
+struct CrownstoneAssetReportDecoder {
+	typedef ble_asset_report_t Result;
+	//! See cs_MeshModelPackets.h in bluenet.
+	static constexpr uint8_t MESH_MSG_TYPE = 30;
+
+	static constexpr bool matches(const uint8_t* data, uint8_t len) {
+		return len >= 5;
+	}
+
+	static bool decode(const uint8_t* data, uint8_t len, Result& result) {
+		if (!matches(data, len)) {
+			return false;
+		}
+		result.assetId = data[0] | (data[1] << 8) | ((uint32_t)data[2] << 16);
+		result.rssi    = (int8_t)data[4];
+		return true;
+	}
+};
+
+/**
+ * Classifies scans with a set of decoders, and passes the decoded fields to a handler:
+ *
+ *   struct BeaconHandler {
+ *       void operator()(const ble_ibeacon_t& beacon) { ... }
+ *       void operator()(const ble_thermometer_t& thermometer) { ... }
+ *   };
+ *   BeaconHandler handler;
+ *   BeaconDispatcher<IBeaconDecoder, AtcThermometerDecoder, PvvxThermometerDecoder>::dispatch(data, size, handler);
+ *
+ * At compile time, the AD type and key of every decoder are put in a small hash table. A scan is then classified in a
+ * single pass over its AD structures: each service data or manufacturer data structure is looked up by its AD type
+ * and first 2 bytes, and only the decoders with that key are tried, in the order of the template arguments, by
+ * calling them via a table of functions. Other AD structures are skipped right away.
+ */
+template <class... Decoders>
+class BeaconDispatcher {
+private:
+	static_assert(sizeof...(Decoders) > 0 && sizeof...(Decoders) < 64, "BeaconDispatcher needs 1 to 63 decoders");
+	static_assert(
+			((Decoders::AD_TYPE == ServiceData16BitUuid || Decoders::AD_TYPE == ManufacturerSpecificData) && ...),
+			"Decoders should be for 16-bit service data or manufacturer data");
+
+	static constexpr uint8_t DECODER_COUNT = sizeof...(Decoders);
+	static constexpr uint8_t EMPTY_SLOT    = 0xFF;
+
+	static constexpr uint8_t tableBits() {
+		// At most half full, so that lookups of other keys end at an empty slot soon
+		uint8_t bits = 1;
+		while ((1 << bits) < 2 * DECODER_COUNT) {
+			bits++;
+		}
+		return bits;
+	}
+
+	static constexpr uint8_t TABLE_BITS = tableBits();
+	static constexpr uint8_t TABLE_SIZE = 1 << TABLE_BITS;
+
+	static constexpr uint32_t packKey(uint8_t adType, uint16_t key) {
+		return ((uint32_t)adType << 16) | key;
+	}
+
+	static constexpr uint8_t slotOf(uint32_t key) {
+		// Multiplicative hash: the top bits of the product depend on all bits of the key
+		return (uint32_t)(key * 2654435761u) >> (32 - TABLE_BITS);
+	}
+
+	struct slot_t {
+		uint32_t key    = 0;
+		uint8_t decoder = EMPTY_SLOT;
+	};
+
+	struct table_t {
+		slot_t slots[TABLE_SIZE];
+	};
+
+	static constexpr table_t buildTable() {
+		const uint32_t keys[DECODER_COUNT] = {packKey(Decoders::AD_TYPE, Decoders::KEY)...};
+		table_t table;
+		for (uint8_t decoder = 0; decoder < DECODER_COUNT; ++decoder) {
+			// Decoders with the same key end up after each other in the probe sequence, in order
+			uint8_t slot = slotOf(keys[decoder]);
+			while (table.slots[slot].decoder != EMPTY_SLOT) {
+				slot = (slot + 1) & (TABLE_SIZE - 1);
+			}
+			table.slots[slot].key     = keys[decoder];
+			table.slots[slot].decoder = decoder;
+		}
+		return table;
+	}
+
+	static constexpr table_t TABLE = buildTable();
+
+	template <class Decoder, class Handler>
+	static bool decode(const uint8_t* data, uint8_t len, Handler& handler) {
+		if (!Decoder::matches(data, len)) {
+			return false;
+		}
+		typename Decoder::Result result;
+		if (!Decoder::decode(data, len, result)) {
+			return false;
+		}
+		handler(result);
+		return true;
+	}
+
+public:
+	/**
+	 * Decode the beacon data in a scan, and pass the result of every AD structure that a decoder matched to the
+	 * handler. Per AD structure, only the first decoder that matches is used.
+	 *
+	 * @param[in] scanData   The scan data, for example BleScanView::data().
+	 * @param[in] scanSize   Size of the scan data.
+	 * @param[in] handler    Object with an operator() for the Result of every decoder.
+	 *
+	 * @return the number of AD structures that were decoded.
+	 */
+	template <class Handler>
+	static uint8_t dispatch(const uint8_t* scanData, uint8_t scanSize, Handler& handler) {
+		typedef bool (*DecodeFunction)(const uint8_t*, uint8_t, Handler&);
+		static constexpr DecodeFunction decoders[DECODER_COUNT] = {&decode<Decoders, Handler>...};
+		uint8_t decoded = 0;
+		uint8_t i       = 0;
+		while (i + 1 < scanSize) {
+			uint8_t fieldLen = scanData[i];
+			if (fieldLen == 0 || i + 1 + fieldLen > scanSize) {
+				break;
+			}
+			uint8_t type = scanData[i + 1];
+			// Type and key take 3 bytes of the length
+			if ((type == ServiceData16BitUuid || type == ManufacturerSpecificData) && fieldLen >= 3) {
+				uint32_t key = packKey(type, beaconUint16Le(scanData + i + 2));
+				for (uint8_t slot = slotOf(key); TABLE.slots[slot].decoder != EMPTY_SLOT;
+					 slot         = (slot + 1) & (TABLE_SIZE - 1)) {
+					if (TABLE.slots[slot].key == key
+						&& decoders[TABLE.slots[slot].decoder](scanData + i + 4, fieldLen - 3, handler)) {
+						decoded++;
+						break;
+					}
+				}
+			}
+			i += fieldLen + 1;
+		}
+		return decoded;
+	}
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <BleFuture.h>
 #include <BleUuid.h>
 #include <BleUtils.h>
 #include <String.h>
@@ -77,7 +78,8 @@ private:
 	uint16_t _cccdHandle  = 0;
 	uint16_t _cccdValue   = 0;
 
-	BleAsyncResult _asyncResult = BleAsyncNotWaiting;
+	// Request to bluenet of which the result comes in via an event
+	BleAsyncOperation _async;
 
 	Uuid _uuid;
 
@@ -107,35 +109,40 @@ private:
 
 	/**
 	 * Write value to a remote characteristic
-	 * Sends a WRITE request to bluenet and waits for WRITE event back
+	 * Sends a WRITE request to bluenet, the WRITE event back completes the returned future
 	 *
 	 * @param buffer buffer to write in
 	 * @param length length of the buffer
-	 * @param timeout in milliseconds
-	 * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
-	 * @return CS_MICROAPP_SDK_ACK_ERR_EMPTY if BleCharacteristic not initialized
-	 * @return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED if BleCharacteristic is not remote but local
-	 * @return CS_MICROAPP_SDK_ACK_ERR_DISABLED if characteristic can't be written
-	 * @return CS_MICROAPP_SDK_ACK_ERR_TIMEOUT if no (valid) WRITE event is received within timeout
-	 * @return microapp_sdk_result_t specifying other error
+	 * @return future with result:
+	 * CS_MICROAPP_SDK_ACK_SUCCESS on success
+	 * CS_MICROAPP_SDK_ACK_ERR_EMPTY if BleCharacteristic not initialized
+	 * CS_MICROAPP_SDK_ACK_ERR_UNDEFINED if BleCharacteristic is not remote but local
+	 * CS_MICROAPP_SDK_ACK_ERR_DISABLED if characteristic can't be written
+	 * microapp_sdk_result_t specifying other error
 	 */
-	microapp_sdk_result_t writeValueRemote(uint8_t* buffer, uint16_t length, uint32_t timeout = 5000);
+	BleFuture writeValueRemote(uint8_t* buffer, uint16_t length);
 
 	/**
 	 * Reads value from a remote characteristic
-	 * Sends a READ request to bluenet and waits for READ event back
+	 * Sends a READ request to bluenet, the READ event back completes the returned future
 	 *
-	 * @param buffer buffer to read value to
+	 * @param buffer buffer to read value to, should stay valid until the future is ready
 	 * @param length (max) length of buffer to write the read value to
-	 * @param timeout in milliseconds
-	 * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
-	 * @return CS_MICROAPP_SDK_ACK_ERR_EMPTY if BleCharacteristic not initialized
-	 * @return CS_MICROAPP_SDK_ACK_ERR_DISABLED if characteristic can't be read
-	 * @return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED if BleCharacteristic is not remote but local
-	 * @return CS_MICROAPP_SDK_ACK_ERR_TIMEOUT if no (valid) READ event is received within timeout
-	 * @return microapp_sdk_result_t specifying other error
+	 * @return future with result:
+	 * CS_MICROAPP_SDK_ACK_SUCCESS on success
+	 * CS_MICROAPP_SDK_ACK_ERR_EMPTY if BleCharacteristic not initialized
+	 * CS_MICROAPP_SDK_ACK_ERR_DISABLED if characteristic can't be read
+	 * CS_MICROAPP_SDK_ACK_ERR_UNDEFINED if BleCharacteristic is not remote but local
+	 * microapp_sdk_result_t specifying other error
+	 */
+	BleFuture readValueRemote(uint8_t* buffer, uint16_t length);
+
+	/**
+	 * Write the client characteristic configuration descriptor (for subscribing and unsubscribing)
+	 *
+	 * @return future with the result of the write
 	 */
-	microapp_sdk_result_t readValueRemote(uint8_t* buffer, uint16_t length, uint32_t timeout = 5000);
+	BleFuture writeCccd();
 
 	microapp_sdk_result_t onRemoteWritten();
 	microapp_sdk_result_t onRemoteRead(microapp_sdk_ble_central_event_read_t* eventRead);
@@ -146,16 +153,6 @@ private:
 	microapp_sdk_result_t onLocalUnsubscribed();
 	microapp_sdk_result_t onLocalNotificationDone();
 
-	/**
-	 * Wait for an event from bluenet after a request made to bluenet
-	 *
-	 * @param timeout in milliseconds
-	 * @return CS_MICROAPP_SDK_ACK_SUCCESS if event was received with success
-	 * @return CS_MICROAPP_SDK_ACK_ERR_TIMEOUT if event was not received within timeout
-	 * @return CS_MICROAPP_SDK_ACK_ERROR if event result with failure
-	 */
-	microapp_sdk_result_t waitForAsyncResult(uint32_t timeout);
-
 	/**
 	 * Internal function for setting generic event handler
 	 *
@@ -228,6 +225,17 @@ public:
 	 */
 	uint16_t readValue(uint8_t* buffer, uint16_t length);
 
+	/**
+	 * Read the current value of the characteristic without blocking.
+	 * If the characteristic is on a remote device, a read request will be sent, and the value is copied into buffer
+	 * when the returned future is ready. The number of bytes read is then given by valueLength().
+	 *
+	 * @param[in] buffer byte array to read value into, should stay valid until the future is ready
+	 * @param[in] length size of buffer argument in bytes
+	 * @return future with the result of the read
+	 */
+	BleFuture readValueAsync(uint8_t* buffer, uint16_t length);
+
 	/**
 	 * Write the value of the characteristic
 	 *
@@ -238,6 +246,15 @@ public:
 	 */
 	bool writeValue(uint8_t* buffer, uint16_t length);
 
+	/**
+	 * Write the value of the characteristic without blocking
+	 *
+	 * @param buffer byte array to write value with, should stay valid until the future is ready
+	 * @param length number of bytes of the buffer argument to write
+	 * @return future with the result of the write
+	 */
+	BleFuture writeValueAsync(uint8_t* buffer, uint16_t length);
+
 	/**
 	 * Set the event handler (callback) function that will be called when the specified event occurs
 	 *
@@ -295,6 +312,13 @@ public:
 	 */
 	bool subscribe(uint32_t timeout = 5000);
 
+	/**
+	 * Subscribe to a BLE characteristic notifications or indications without blocking
+	 *
+	 * @return future with the result of the subscription
+	 */
+	BleFuture subscribeAsync();
+
 	/**
 	 * Query if a BLE characteristic is unsubscribable
 	 *
@@ -312,6 +336,13 @@ public:
 	 */
 	bool unsubscribe(uint32_t timeout = 5000);
 
+	/**
+	 * Unsubscribe to a BLE characteristic notifications or indications without blocking
+	 *
+	 * @return future with the result of the unsubscription
+	 */
+	BleFuture unsubscribeAsync();
+
 	/**
 	 * Has the characteristics value been updated via a notification or indication
 	 *
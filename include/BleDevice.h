@@ -1,5 +1,7 @@
 #pragma once
 
+#include <BleAttributePool.h>
+#include <BleFuture.h>
 #include <BleScan.h>
 #include <BleService.h>
 #include <BleMacAddress.h>
@@ -31,9 +33,12 @@ private:
 	BleDevice(MacAddress address);
 
 	// raw scan data
-	uint8_t _scanData[MAX_BLE_ADV_DATA_LENGTH];
+	uint8_t _scanData[MAX_BLE_SCAN_DATA_LENGTH];
 	uint8_t _scanSize = 0;
 
+	// offsets of the AD structures in the scan data, built on the first query, see adIndex()
+	ble_ad_index_t _adIndex;
+
 	MacAddress _address;
 	rssi_t _rssi = 127;
 
@@ -44,6 +49,11 @@ private:
 	BleService* _services[MAX_REMOTE_SERVICES];  // array of pointers
 	uint8_t _serviceCount = 0;
 
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+	// All discovered services and characteristics for peripheral devices, set on connect
+	BleAttributePool* _attributes = nullptr;
+#endif
+
 	struct {
 		// device is initialized with nondefault constructor
 		bool initialized = false;
@@ -57,7 +67,13 @@ private:
 		bool discoveryDone = false;
 	} _flags;
 
-	BleAsyncResult _asyncResult = BleAsyncNotWaiting;
+	// Request to bluenet of which the result comes in via an event
+	BleAsyncOperation _async;
+
+	/**
+	 * Returns the index of the scan data, which is built the first time.
+	 */
+	const ble_ad_index_t& adIndex();
 
 	/**
 	 * Sets internal connected flag
@@ -107,13 +123,13 @@ private:
 	microapp_sdk_result_t getCharacteristic(uint16_t handle, BleCharacteristic** characteristic);
 
 	/**
-	 * Wait for an event from bluenet after a request made to bluenet
+	 * Send a discover request to bluenet
 	 *
-	 * @param timeout in milliseconds
-	 * @return true if event was received with success
-	 * @return false if event was not received within timeout or was received with failure
+	 * @param[in] uuids the services to discover
+	 * @param[in] count the number of services
+	 * @return the result of the request: CS_MICROAPP_SDK_ACK_IN_PROGRESS if the discover events will come
 	 */
-	bool waitForAsyncResult(uint32_t timeout);
+	microapp_sdk_result_t requestDiscover(const microapp_sdk_ble_uuid_t* uuids, uint8_t count);
 
 public:
 	// return true if BleDevice is nontrivial, i.e. initialized from an actual advertisement
@@ -143,6 +159,13 @@ public:
 	 */
 	bool disconnect(uint32_t timeout = 5000);
 
+	/**
+	 * Disconnect the BLE device without blocking
+	 *
+	 * @return future with the result of the disconnect, CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND if not connected
+	 */
+	BleFuture disconnectAsync();
+
 	/**
 	 * Get device address of the last scanned advertisement which matched the filter.
 	 *
@@ -158,12 +181,48 @@ public:
 	int8_t rssi();
 
 	/**
-	 * (Not implemented!) Discover all the attributes of the BLE device
+	 * Discover all the services and characteristics of the BLE device in one pass, see discoverAttributesAsync()
 	 *
+	 * @param timeout in milliseconds
 	 * @return true if successful
 	 * @return false on failure
 	 */
-	bool discoverAttributes();
+	bool discoverAttributes(uint32_t timeout = 5000);
+
+	/**
+	 * Discover all the services and characteristics of the BLE device in one pass without blocking
+	 *
+	 * Bluenet requires a set of services to initiate discovery, so the 16-bit services the device advertises are
+	 * discovered, up to 4 of them. The first MAX_REMOTE_SERVICES services can be used via service() and
+	 * characteristic(). When built with BLE_ATTRIBUTE_POOL=1, every discovered service and characteristic is also
+	 * stored in a pool of MAX_REMOTE_ATTRIBUTES attributes, see attribute(). Like discoverService(), discovery is done
+	 * once per connection.
+	 *
+	 * @return future with the result of the discovery
+	 * @return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND if the device advertises no 16-bit services
+	 */
+	BleFuture discoverAttributesAsync();
+
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+	/**
+	 * Query the number of discovered services and characteristics in the attribute pool
+	 *
+	 * Only available when built with BLE_ATTRIBUTE_POOL=1, see config.mk.
+	 *
+	 * @return the number of attributes, or 0 if discovery is not done
+	 */
+	uint8_t attributeCount();
+
+	/**
+	 * Get a discovered service or characteristic from the attribute pool, in the order of discovery
+	 *
+	 * A service has its own index as service, a characteristic the index of its service.
+	 *
+	 * @param[in] index index of the attribute, smaller than attributeCount()
+	 * @return pointer to the attribute, or nullptr if there is none
+	 */
+	const ble_attribute_t* attribute(uint8_t index);
+#endif
 
 	/**
 	 * Discover the attributes of a particular service on the BLE device
@@ -175,6 +234,14 @@ public:
 	 */
 	bool discoverService(const char* serviceUuid, uint32_t timeout = 5000);
 
+	/**
+	 * Discover the attributes of a particular service on the BLE device without blocking
+	 *
+	 * @param serviceUuid string containing uuid of the service to be discovered
+	 * @return future with the result of the discovery
+	 */
+	BleFuture discoverServiceAsync(const char* serviceUuid);
+
 	/**
 	 * Query the numer of services discovered for the BLE device
 	 *
@@ -262,6 +329,64 @@ public:
 	 */
 	String advertisedServiceUuid(uint8_t index = 0);
 
+	/**
+	 * Query the number of service uuids of a given size the device is advertising
+	 *
+	 * @param uuidLength number of bytes of the uuids: UUID_16BIT_BYTE_LENGTH, UUID_32BIT_BYTE_LENGTH or
+	 * UUID_128BIT_BYTE_LENGTH
+	 * @return the number of uuids
+	 */
+	uint8_t advertisedServiceUuidCount(uint8_t uuidLength);
+
+	/**
+	 * Query a service uuid of a given size the device is advertising, in place
+	 *
+	 * @param uuidLength number of bytes of the uuid, see advertisedServiceUuidCount()
+	 * @param index the index of the service uuid
+	 * @return pointer to the uuid, little endian, as advertised. nullptr if not found
+	 */
+	const uint8_t* advertisedServiceUuidBytes(uint8_t uuidLength, uint8_t index = 0);
+
+	/**
+	 * Find the service data of a 16-bit uuid in the scanned advertisement data
+	 *
+	 * @param[in] uuid the uuid of the service data
+	 * @param[out] foundData pointers to the uuid and the data after it, and their lengths
+	 * @return true if found
+	 */
+	bool findServiceData(uuid16_t uuid, ble_service_data_t* foundData);
+
+	/**
+	 * Iterate over the service data in the scanned advertisement data, with any uuid size
+	 *
+	 *   uint8_t cursor = 0;
+	 *   ble_service_data_t serviceData;
+	 *   while (device.nextServiceData(cursor, &serviceData)) { ... }
+	 *
+	 * @param[in,out] cursor 0 to start, keeps the position
+	 * @param[out] foundData pointers to the uuid and the data after it, and their lengths
+	 * @return true if more service data was found
+	 */
+	bool nextServiceData(uint8_t& cursor, ble_service_data_t* foundData);
+
+	/**
+	 * Find the manufacturer specific data of a company in the scanned advertisement data
+	 *
+	 * @param[in] companyId the company identifier, e.g. 0x004C for Apple
+	 * @param[out] foundData pointer to the data after the company id, and its length
+	 * @return true if found
+	 */
+	bool findManufacturerData(uint16_t companyId, ble_manufacturer_data_t* foundData);
+
+	/**
+	 * Iterate over the manufacturer specific data in the scanned advertisement data, see nextServiceData()
+	 *
+	 * @param[in,out] cursor 0 to start, keeps the position
+	 * @param[out] foundData company id, and pointer to the data after it and its length
+	 * @return true if more manufacturer specific data was found
+	 */
+	bool nextManufacturerData(uint8_t& cursor, ble_manufacturer_data_t* foundData);
+
 	/**
 	 * Connect to a BLE device
 	 *
@@ -271,6 +396,13 @@ public:
 	 */
 	bool connect(uint32_t timeout = 5000);
 
+	/**
+	 * Connect to a BLE device without blocking
+	 *
+	 * @return future with the result of the connection attempt
+	 */
+	BleFuture connectAsync();
+
 	/**
 	 * Find an advertisement of type type in the scanned advertisement data
 	 *
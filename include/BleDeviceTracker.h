@@ -0,0 +1,160 @@
+/*
+ * Table of recently scanned devices, with their filtered RSSI.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleUtils.h>
+#include <microapp.h>
+
+/*
+ * Number of devices that are tracked, should be a power of 2. Set it to at least twice the number of devices that pass
+ * the scan filter at the same time: when the table is full, the device that was scanned longest ago is evicted, and
+ * leaves. Each takes 25 bytes of RAM. Only built in with BLE_DEVICE_TRACKER=1, see config.mk.
+ */
+#ifndef MAX_TRACKED_DEVICES
+#define MAX_TRACKED_DEVICES 8
+#endif
+
+/*
+ * Default number of ticks without advertisements after which a device leaves: 10 seconds.
+ */
+#ifndef DEFAULT_TRACKER_TIMEOUT_TICKS
+#define DEFAULT_TRACKER_TIMEOUT_TICKS (10000 / MICROAPP_LOOP_INTERVAL_MS)
+#endif
+
+/*
+ * Weight of a new RSSI sample in the exponential moving average is 1 / 2^TRACKER_EMA_SHIFT.
+ */
+#ifndef TRACKER_EMA_SHIFT
+#define TRACKER_EMA_SHIFT 2
+#endif
+
+/*
+ * Number of RSSI samples of which the median is taken.
+ */
+const uint8_t TRACKER_MEDIAN_WINDOW = 3;
+
+/*
+ * How the RSSI of the advertisements of a device is filtered.
+ */
+enum BleRssiFilterType {
+	//! Exponential moving average, see TRACKER_EMA_SHIFT.
+	BleRssiFilterEma    = 0,
+	//! Median of the last TRACKER_MEDIAN_WINDOW advertisements, which ignores single outliers.
+	BleRssiFilterMedian = 1,
+};
+
+enum BleTrackerTransition {
+	//! The filtered RSSI of the device reached the enter threshold.
+	BleTrackerEnter = 1,
+	//! The filtered RSSI of the device dropped below the leave threshold, the device timed out, or it was evicted.
+	BleTrackerLeave = 2,
+};
+
+struct ble_tracked_device_t {
+	//! MAC address, in the byte order of bluenet (reversed).
+	uint8_t address[MAC_ADDRESS_LENGTH];
+	uint8_t addressType;
+	//! Filtered RSSI.
+	rssi_t rssi;
+	//! Whether the device entered, and did not leave since.
+	bool present;
+	//! Last RSSI samples, for the median filter.
+	rssi_t samples[TRACKER_MEDIAN_WINDOW];
+	//! Number of samples, up to TRACKER_MEDIAN_WINDOW.
+	uint8_t sampleCount;
+	//! Exponential moving average of the RSSI, in 1/16 dB.
+	int16_t ema;
+	//! Number of advertisements since the device was first seen, saturates.
+	uint16_t hits;
+	//! Tick of the last advertisement, see tickCount().
+	uint32_t lastSeen;
+};
+
+/**
+ * Called when a device enters or leaves.
+ */
+typedef void (*TrackerEventHandler)(const ble_tracked_device_t&, BleTrackerTransition);
+
+/**
+ * Fixed size open addressing hash table of scanned devices, by MAC address.
+ *
+ * A device enters when its filtered RSSI reaches the enter threshold, and leaves when it drops below the leave
+ * threshold, or when it has not been seen for the timeout. Devices that left keep their slot until it is needed for
+ * another device. When all slots that are probed hold present devices, the least recently seen one is evicted.
+ */
+class BleDeviceTracker {
+private:
+	ble_tracked_device_t _devices[MAX_TRACKED_DEVICES];
+	//! Whether a slot has been used since the last clear. Probing stops at the first unused slot.
+	bool _used[MAX_TRACKED_DEVICES] = {};
+	BleRssiFilterType _filter       = BleRssiFilterEma;
+	rssi_t _enterRssi               = -90;
+	rssi_t _leaveRssi               = -95;
+	uint16_t _timeout               = DEFAULT_TRACKER_TIMEOUT_TICKS;
+	//! Tick at which age() last checked for timeouts.
+	uint32_t _agedTick              = 0;
+
+	/**
+	 * Find the slot of a device, or a slot to track it in.
+	 *
+	 * @return the slot. When the slot of a present device is taken, that device leaves first.
+	 */
+	ble_tracked_device_t* findSlot(const uint8_t* address, bool& found, TrackerEventHandler handler);
+
+	/**
+	 * Add a sample to the device, and update its filtered RSSI.
+	 */
+	void filter(ble_tracked_device_t& device, rssi_t rssi);
+
+	void leave(ble_tracked_device_t& device, TrackerEventHandler handler);
+
+public:
+	/**
+	 * Update the tracked device of a scan, and inform the handler when it entered or left.
+	 *
+	 * @param[in] scan       The scan event from bluenet.
+	 * @param[in] handler    Handler to inform of transitions, or nullptr.
+	 */
+	void update(const microapp_sdk_ble_scan_event_t& scan, TrackerEventHandler handler);
+
+	/**
+	 * Let present devices that have not been seen for the timeout leave. Only checks once per tick.
+	 *
+	 * @param[in] handler    Handler to inform of transitions, or nullptr.
+	 */
+	void age(TrackerEventHandler handler);
+
+	/**
+	 * Forget all devices, without informing of transitions.
+	 */
+	void clear();
+
+	/**
+	 * @param[in] filter         How the RSSI is filtered.
+	 * @param[in] enterRssi      Filtered RSSI at which a device enters.
+	 * @param[in] leaveRssi      Filtered RSSI below which a device leaves, should be lower than enterRssi.
+	 * @param[in] timeoutTicks   Number of ticks without advertisements after which a device leaves.
+	 */
+	void configure(BleRssiFilterType filter, rssi_t enterRssi, rssi_t leaveRssi, uint16_t timeoutTicks);
+
+	/**
+	 * Returns the number of present devices.
+	 */
+	uint8_t count();
+
+	/**
+	 * Returns a present device.
+	 *
+	 * @param[in] index      Index of the device, from 0 to count().
+	 *
+	 * @return the device, or nullptr if the index is out of range.
+	 */
+	const ble_tracked_device_t* get(uint8_t index);
+};
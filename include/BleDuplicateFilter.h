@@ -0,0 +1,81 @@
+/*
+ * Filter for repeated advertisements of the same device.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleScan.h>
+#include <BleUtils.h>
+#include <microapp.h>
+
+/*
+ * Number of devices that are remembered, should be a power of 2. Set it to at least twice the number of devices that
+ * advertise within the TTL, so that probes stay short and devices are not forgotten before their TTL ends. Each takes
+ * 13 bytes of RAM. Only built in with BLE_DUPLICATE_FILTER=1, see config.mk.
+ */
+#ifndef MAX_SCAN_DUPLICATE_FILTER_SIZE
+#define MAX_SCAN_DUPLICATE_FILTER_SIZE 16
+#endif
+
+/*
+ * Default number of ticks during which an advertisement is a duplicate of an earlier one: 1 second.
+ */
+#ifndef DEFAULT_SCAN_DUPLICATE_TTL_TICKS
+#define DEFAULT_SCAN_DUPLICATE_TTL_TICKS (1000 / MICROAPP_LOOP_INTERVAL_MS)
+#endif
+
+struct ble_duplicate_entry_t {
+	uint8_t address[MAC_ADDRESS_LENGTH];
+	//! Hash of the advertisement data, if the data is compared.
+	uint16_t dataHash;
+	//! Tick at which the device was last let through.
+	uint32_t tick;
+};
+
+/**
+ * Fixed size open addressing hash set of recently seen devices, by MAC address and optionally advertisement data.
+ *
+ * An advertisement is a duplicate when the same device was let through less than the TTL ago. Entries expire after
+ * the TTL, their slots are then reused. When all slots that are probed hold devices that did not expire yet, the
+ * device that was let through longest ago is forgotten.
+ */
+class BleDuplicateFilter {
+private:
+	ble_duplicate_entry_t _entries[MAX_SCAN_DUPLICATE_FILTER_SIZE];
+	//! Whether a slot has been used since the last clear. Probing stops at the first unused slot.
+	bool _used[MAX_SCAN_DUPLICATE_FILTER_SIZE] = {};
+	uint16_t _ttl                              = DEFAULT_SCAN_DUPLICATE_TTL_TICKS;
+	bool _compareData                          = true;
+	uint16_t _duplicateCount                   = 0;
+
+public:
+	/**
+	 * Check whether a scan is a duplicate, and remember the device when it is not.
+	 *
+	 * @param[in] scan       The scan event from bluenet.
+	 *
+	 * @return true when the scan is a duplicate, and should be dropped.
+	 */
+	bool isDuplicate(const microapp_sdk_ble_scan_event_t& scan);
+
+	/**
+	 * Forget all devices.
+	 */
+	void clear();
+
+	/**
+	 * @param[in] ttl           Number of ticks during which advertisements of a device are duplicates.
+	 * @param[in] compareData   When true, advertisements with other data than the last one are not duplicates.
+	 */
+	void configure(uint16_t ttl, bool compareData);
+
+	/**
+	 * Returns the number of duplicates that were dropped.
+	 */
+	uint16_t duplicateCount();
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <BleUtils.h>
+#include <microapp.h>
+
+// Forward declarations
+class BleFuture;
+
+// Called when an asynchronous request completes, with the result of the request
+typedef void (*BleFutureCallback)(microapp_sdk_result_t result);
+
+/**
+ * State of an asynchronous request to bluenet, of which the result comes in later via an event.
+ *
+ * Each BleDevice and BleCharacteristic has one, so only one request per device or characteristic is in progress at a
+ * time. Starting a new request supersedes the previous one. The one of the peripheral stays while a request waits, see
+ * Ble::replacePeripheral().
+ */
+class BleAsyncOperation {
+private:
+	friend class Ble;
+	friend class BleDevice;
+	friend class BleCharacteristic;
+	friend class BleFuture;
+
+	BleAsyncResult _state         = BleAsyncNotWaiting;
+	microapp_sdk_result_t _result = CS_MICROAPP_SDK_ACK_SUCCESS;
+	// Incremented for each request, so that futures of a previous request can tell they are superseded
+	uint8_t _sequence             = 0;
+	BleFutureCallback _callback   = nullptr;
+
+	/**
+	 * Start a new request. Has to be called before the sendMessage call with the request to bluenet.
+	 *
+	 * @return a future for the new request
+	 */
+	BleFuture start();
+
+	/**
+	 * Complete the request, and call the completion callback, if any.
+	 * Called with the ack of the request if bluenet does not return CS_MICROAPP_SDK_ACK_IN_PROGRESS,
+	 * or from the event handler otherwise.
+	 *
+	 * @param result the result of the request
+	 */
+	void complete(microapp_sdk_result_t result);
+};
+
+/**
+ * Handle to the result of an asynchronous request, such as BleCharacteristic::readValueAsync().
+ *
+ * The request is completed by an event from bluenet, while the microapp continues. The result can be polled with
+ * ready() and result(), waited for with wait(), or handled in a callback set with onComplete().
+ */
+class BleFuture {
+private:
+	friend class BleAsyncOperation;
+
+	BleAsyncOperation* _operation = nullptr;
+	uint8_t _sequence             = 0;
+	// Result of a request that failed before it was sent
+	microapp_sdk_result_t _result = CS_MICROAPP_SDK_ACK_ERR_EMPTY;
+
+	BleFuture(BleAsyncOperation* operation, uint8_t sequence) : _operation(operation), _sequence(sequence) {}
+
+public:
+	/**
+	 * Create a future without request, which is ready with CS_MICROAPP_SDK_ACK_ERR_EMPTY.
+	 */
+	BleFuture() {}
+
+	/**
+	 * Create a future of a request that failed before it was sent, which is ready with the given result.
+	 */
+	explicit BleFuture(microapp_sdk_result_t result) : _result(result) {}
+
+	/**
+	 * Query if the request has completed, with success or not.
+	 *
+	 * @return true if the result is known
+	 * @return false if the request is still in progress
+	 */
+	bool ready();
+
+	/**
+	 * Get the result of the request.
+	 *
+	 * @return CS_MICROAPP_SDK_ACK_IN_PROGRESS if the request is still in progress
+	 * @return CS_MICROAPP_SDK_ACK_SUCCESS if the request completed with success
+	 * @return CS_MICROAPP_SDK_ACK_ERR_BUSY if a newer request on the same device or characteristic superseded it
+	 * @return microapp_sdk_result_t specifying the error otherwise
+	 */
+	microapp_sdk_result_t result();
+
+	/**
+	 * Block until the request has completed. Other microapp code only runs in interrupt handlers meanwhile.
+	 *
+	 * @param timeout in milliseconds
+	 * @return CS_MICROAPP_SDK_ACK_ERR_TIMEOUT if the request did not complete within timeout
+	 * @return result() otherwise
+	 */
+	microapp_sdk_result_t wait(uint32_t timeout = 5000);
+
+	/**
+	 * Set a function to call when the request completes. It is called from the interrupt handler of the completing
+	 * event, or right away if the request has already completed. Only one callback per request can be set.
+	 *
+	 * @param callback function to call with the result
+	 */
+	void onComplete(BleFutureCallback callback);
+};
@@ -0,0 +1,103 @@
+/*
+ * Large list of MAC addresses in flash, of which scans are let through.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleUtils.h>
+#include <microapp.h>
+
+/*
+ * Number of bytes of the Bloom filter in RAM, should be a power of 2.
+ * With n addresses, m bits and k hashes, the fraction of other addresses that passes the Bloom filter is about
+ * (1 - e^(-k * n / m))^k: those are then rejected by a binary search in flash.
+ * When building with MAC_ALLOWLIST_CSV, scripts/mac_allowlist.py sets it to about 10 bits per address, but at most
+ * MAC_ALLOWLIST_BLOOM_MAX_BYTES, see config.mk.
+ */
+#ifndef MAC_ALLOWLIST_BLOOM_BYTES
+#define MAC_ALLOWLIST_BLOOM_BYTES 256
+#endif
+
+/*
+ * Number of bits that are set in the Bloom filter per address.
+ */
+#ifndef MAC_ALLOWLIST_BLOOM_HASHES
+#define MAC_ALLOWLIST_BLOOM_HASHES 2
+#endif
+
+/*
+ * The table that is generated from a CSV file at build time, by building with MAC_ALLOWLIST_CSV=<file>, see
+ * scripts/mac_allowlist.py. Being const, it stays in flash. The addresses are in the byte order of bluenet
+ * (reversed), sorted by memcmp().
+ */
+extern const uint8_t macAllowlist[][MAC_ADDRESS_LENGTH];
+extern const uint16_t macAllowlistSize;
+
+/**
+ * Checks whether a MAC address is in a sorted table of addresses, in flash.
+ *
+ * Most scanned addresses are not in the table. To reject those quickly, a Bloom filter of the table is kept in RAM:
+ * when not all bits of an address are set, it is not in the table. Otherwise, a binary search in the table confirms.
+ */
+class BleMacAllowlist {
+private:
+	const uint8_t (*_table)[MAC_ADDRESS_LENGTH] = nullptr;
+	uint16_t _size                              = 0;
+	uint8_t _bloom[MAC_ALLOWLIST_BLOOM_BYTES];
+	//! Addresses that passed the Bloom filter, but were not in the table.
+	uint16_t _falsePositiveCount                = 0;
+
+public:
+	/**
+	 * Use a table of addresses, and build the Bloom filter of it.
+	 *
+	 * @param[in] table      Addresses in the byte order of bluenet (reversed), sorted by memcmp(). Must stay valid.
+	 * @param[in] size       Number of addresses.
+	 *
+	 * @return false if the table is not sorted, the allowlist is then empty.
+	 */
+	bool set(const uint8_t (*table)[MAC_ADDRESS_LENGTH], uint16_t size);
+
+	/**
+	 * Stop using the table.
+	 */
+	void clear();
+
+	/**
+	 * Returns whether a table is used.
+	 */
+	bool enabled();
+
+	/**
+	 * Check the Bloom filter only.
+	 *
+	 * @param[in] address    Address in the byte order of bluenet (reversed).
+	 *
+	 * @return false if the address is certainly not in the table.
+	 */
+	bool mayContain(const uint8_t* address);
+
+	/**
+	 * Binary search in the table only.
+	 *
+	 * @param[in] address    Address in the byte order of bluenet (reversed).
+	 */
+	bool search(const uint8_t* address);
+
+	/**
+	 * Check the Bloom filter, and confirm with a binary search.
+	 *
+	 * @param[in] address    Address in the byte order of bluenet (reversed).
+	 */
+	bool contains(const uint8_t* address);
+
+	/**
+	 * Returns the number of addresses that passed the Bloom filter, but were not in the table.
+	 */
+	uint16_t falsePositiveCount();
+};
@@ -17,6 +17,62 @@ struct ble_ad_t {
 	const uint8_t* data = nullptr;
 };
 
+/**
+ * Service data ad, split in uuid and data. Contains pointers into the scan data, not the data itself.
+ */
+struct ble_service_data_t {
+	//! Number of bytes of the uuid: 2, 4 or 16.
+	uint8_t uuidLength  = 0;
+	//! The uuid, little endian, as advertised.
+	const uint8_t* uuid = nullptr;
+	//! Number of bytes of data after the uuid.
+	uint8_t len         = 0;
+	const uint8_t* data = nullptr;
+};
+
+/**
+ * Manufacturer specific data ad, split in company id and data. Contains a pointer into the scan data, not the data
+ * itself.
+ */
+struct ble_manufacturer_data_t {
+	//! Company identifier, as assigned by the Bluetooth SIG.
+	uint16_t companyId  = 0;
+	//! Number of bytes of data after the company id.
+	uint8_t len         = 0;
+	const uint8_t* data = nullptr;
+};
+
+/*
+ * Maximum size of the scan data of a device. Each copy of the scan data takes this many bytes of RAM, so it is the size
+ * of an advertisement, unless scan responses can be merged with their advertisement, see Ble::mergeScanResponses():
+ * it then holds both by default.
+ */
+#ifndef MAX_BLE_SCAN_DATA_LENGTH
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+#define MAX_BLE_SCAN_DATA_LENGTH (2 * MAX_BLE_ADV_DATA_LENGTH)
+#else
+#define MAX_BLE_SCAN_DATA_LENGTH MAX_BLE_ADV_DATA_LENGTH
+#endif
+#endif
+
+/*
+ * Maximum number of AD structures in scan data: each takes at least 2 bytes.
+ */
+#define MAX_AD_STRUCTURES (MAX_BLE_SCAN_DATA_LENGTH / 2)
+
+const uint8_t AD_INDEX_NOT_BUILT = 0xFF;
+
+/**
+ * Offsets of the AD structures in scan data, so that they can be looked up by GAP ad type without parsing the scan
+ * data again. The type of each AD structure is read from the scan data itself.
+ */
+struct ble_ad_index_t {
+	//! Number of AD structures, or AD_INDEX_NOT_BUILT.
+	uint8_t count = AD_INDEX_NOT_BUILT;
+	//! Offset of the length field of each AD structure.
+	uint8_t offsets[MAX_AD_STRUCTURES];
+};
+
 /**
  * Helper wrapper class for scan data
  * Does not contain the actual data but only a pointer to it
@@ -41,6 +97,32 @@ private:
 	static bool findAdvertisementDataType(const uint8_t* scanData, uint8_t scanSize, GapAdvType type, ble_ad_t* foundData);
 
 public:
+	/**
+	 * Parse the AD structures of the scan data once, so that the queries below become lookups.
+	 * Parsing stops at the first AD structure with length 0, or that does not fit in the scan data.
+	 *
+	 * @param[in] scanData      The scan data.
+	 * @param[in] scanSize      Size of the scan data.
+	 * @param[out] index        The offsets of the AD structures.
+	 */
+	static void buildIndex(const uint8_t* scanData, uint8_t scanSize, ble_ad_index_t& index);
+
+	/**
+	 * Looks up an ad of specified GAP ad data type in an index of the scan data.
+	 * If found returns true and a ble_ad_t with ad type, length and pointer to its data
+	 *
+	 * @param[in] index         Index of the scan data, see buildIndex().
+	 * @param[in] type          GAP advertisement type
+	 * @param[out] foundData    ad containing a pointer to data and its length
+	 *
+	 * @return true             if the advertisement data of given type is found.
+	 * @return false            if the advertisement data of given type is not found.
+	 */
+	static bool findAdvertisementDataType(const uint8_t* scanData, const ble_ad_index_t& index, GapAdvType type, ble_ad_t* foundData);
+
+	/*
+	 * The queries below exist for scan data with and without index. Those without index parse the scan data each time.
+	 */
 
 	/**
 	 * Query the local name advertised in the scan (either complete or shortened)
@@ -48,6 +130,7 @@ public:
 	 * @return An ad with a pointer to the local name and its length (nullptr and 0 if not found, respectively)
 	 */
 	static ble_ad_t localName(const uint8_t* scanData, uint8_t scanSize);
+	static ble_ad_t localName(const uint8_t* scanData, const ble_ad_index_t& index);
 
 	/**
 	 * Checks if a service with passed uuid is advertised by the device
@@ -57,6 +140,7 @@ public:
 	 * @return false if not found
 	 */
 	static bool hasServiceUuid(const uint8_t* scanData, uint8_t scanSize, uuid16_t uuid = 0);
+	static bool hasServiceUuid(const uint8_t* scanData, const ble_ad_index_t& index, uuid16_t uuid = 0);
 
 	/**
 	 * Finds the number of 16-bit service uuids advertised by the device
@@ -64,6 +148,7 @@ public:
 	 * @return the number of services advertised
 	 */
 	static uint8_t serviceUuidCount(const uint8_t* scanData, uint8_t scanSize);
+	static uint8_t serviceUuidCount(const uint8_t* scanData, const ble_ad_index_t& index);
 
 	/**
 	 * Return the uuid advertised by the device, indexed by the index parameter
@@ -72,5 +157,85 @@ public:
 	 * @return uuid indexed by index. Returns 0 if not found
 	 */
 	static uuid16_t serviceUuid(const uint8_t* scanData, uint8_t scanSize, uint8_t index = 0);
+	static uuid16_t serviceUuid(const uint8_t* scanData, const ble_ad_index_t& adIndex, uint8_t index = 0);
+
+	/*
+	 * The queries below only exist for scan data with index, as iterating would parse the scan data for every entry.
+	 */
+
+	/**
+	 * Looks up the next ad of specified GAP ad data type, for types that can occur more than once.
+	 *
+	 * @param[in] type            GAP advertisement type
+	 * @param[in,out] cursor      Index of the AD structure to start at, 0 for the first. Set to the one after the found ad.
+	 * @param[out] foundData      ad containing a pointer to data and its length
+	 *
+	 * @return true               if another ad of given type is found.
+	 */
+	static bool nextAdvertisementDataType(
+			const uint8_t* scanData, const ble_ad_index_t& index, GapAdvType type, uint8_t& cursor, ble_ad_t* foundData);
+
+	/**
+	 * Finds the number of service uuids of a given size advertised by the device, in complete and incomplete lists.
+	 *
+	 * @param uuidLength      Number of bytes of the uuids: UUID_16BIT_BYTE_LENGTH, UUID_32BIT_BYTE_LENGTH or
+	 *                        UUID_128BIT_BYTE_LENGTH.
+	 * @return the number of uuids, 0 for another uuid length
+	 */
+	static uint8_t serviceUuidCount(const uint8_t* scanData, const ble_ad_index_t& index, uint8_t uuidLength);
+
+	/**
+	 * Return a service uuid of a given size advertised by the device, in place.
+	 *
+	 * @param uuidLength      Number of bytes of the uuid, see serviceUuidCount().
+	 * @param uuidIndex       Index of the uuid, from 0 to serviceUuidCount().
+	 * @return pointer to the uuid, little endian, as advertised. nullptr if not found
+	 */
+	static const uint8_t* serviceUuidBytes(
+			const uint8_t* scanData, const ble_ad_index_t& index, uint8_t uuidLength, uint8_t uuidIndex);
+
+	/**
+	 * Looks up the next service data, with a 16-bit, 32-bit or 128-bit uuid.
+	 *
+	 * @param[in,out] cursor      Index of the AD structure to start at, 0 for the first. Set to the one after the found ad.
+	 * @param[out] foundData      The service data.
+	 *
+	 * @return true               if more service data is found.
+	 */
+	static bool nextServiceData(
+			const uint8_t* scanData, const ble_ad_index_t& index, uint8_t& cursor, ble_service_data_t* foundData);
+
+	/**
+	 * Looks up the service data of a 16-bit uuid.
+	 *
+	 * @param[in] uuid            The uuid.
+	 * @param[out] foundData      The service data.
+	 *
+	 * @return true               if found.
+	 */
+	static bool findServiceData(
+			const uint8_t* scanData, const ble_ad_index_t& index, uuid16_t uuid, ble_service_data_t* foundData);
+
+	/**
+	 * Looks up the next manufacturer specific data.
+	 *
+	 * @param[in,out] cursor      Index of the AD structure to start at, 0 for the first. Set to the one after the found ad.
+	 * @param[out] foundData      The manufacturer specific data.
+	 *
+	 * @return true               if more manufacturer specific data is found.
+	 */
+	static bool nextManufacturerData(
+			const uint8_t* scanData, const ble_ad_index_t& index, uint8_t& cursor, ble_manufacturer_data_t* foundData);
+
+	/**
+	 * Looks up the manufacturer specific data of a company.
+	 *
+	 * @param[in] companyId       The company identifier.
+	 * @param[out] foundData      The manufacturer specific data.
+	 *
+	 * @return true               if found.
+	 */
+	static bool findManufacturerData(
+			const uint8_t* scanData, const ble_ad_index_t& index, uint16_t companyId, ble_manufacturer_data_t* foundData);
 
 };
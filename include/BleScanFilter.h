@@ -0,0 +1,125 @@
+/*
+ * Filter on scanned advertisements, with several criteria.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleMacAddress.h>
+#include <BleScan.h>
+#include <BleUtils.h>
+#include <microapp.h>
+
+/*
+ * Number of bytes of the compiled filter.
+ */
+#ifndef MAX_SCAN_FILTER_SIZE
+#define MAX_SCAN_FILTER_SIZE 32
+#endif
+
+/*
+ * Operations of a compiled filter. Each is followed by its operands.
+ */
+enum BleScanFilterOp {
+	//! Operands: length, then the first bytes of the MAC address, in the order they are written.
+	BleScanFilterOpMacPrefix = 1,
+	//! Operand: minimal RSSI (int8).
+	BleScanFilterOpMinRssi,
+	//! Operands: company id (uint16), the first 2 bytes of the manufacturer specific data.
+	BleScanFilterOpManufacturerId,
+	//! Operands: 16-bit uuid of the service data (uint16).
+	BleScanFilterOpServiceDataUuid,
+	//! Operands: length, then the first characters of the local name, complete or shortened.
+	BleScanFilterOpNamePrefix,
+	//! No operands: starts a new group of criteria.
+	BleScanFilterOpOr,
+};
+
+/**
+ * Filter on scanned advertisements, built by chaining criteria:
+ *
+ *   BleScanFilter filter;
+ *   filter.macPrefix("A4:C1:38").minRssi(-70).orElse().manufacturerId(0x004C);
+ *
+ * Criteria are ANDed, orElse() starts a new group of criteria: an advertisement passes when it matches all criteria
+ * of any group. An empty filter passes all advertisements.
+ *
+ * The criteria are compiled into a compact list of operations, which is evaluated on the raw scan. When the filter
+ * consists of a single group, its most selective criterion that bluenet supports (a complete MAC address, or a service
+ * data uuid) is also set as filter in bluenet, so that other advertisements do not even reach the microapp.
+ */
+class BleScanFilter {
+private:
+	uint8_t _code[MAX_SCAN_FILTER_SIZE];
+	uint8_t _size = 0;
+	//! Set when a criterion did not fit, or was invalid.
+	bool _valid   = true;
+
+	/**
+	 * Append an operation with its operands.
+	 */
+	BleScanFilter& append(BleScanFilterOp op, const uint8_t* operands, uint8_t size);
+
+	/**
+	 * Evaluate a single operation on a scan. The index of the advertisement data is built when it is needed.
+	 */
+	bool matches(const uint8_t* code, const microapp_sdk_ble_scan_event_t& scan, ble_ad_index_t& index) const;
+
+public:
+	/**
+	 * Match the first bytes of the MAC address.
+	 *
+	 * @param[in] prefix     MAC address, or its first bytes, of the format "AA:BB:CC", either lowercase or uppercase.
+	 */
+	BleScanFilter& macPrefix(const char* prefix);
+
+	/**
+	 * Match advertisements received with at least the given RSSI.
+	 */
+	BleScanFilter& minRssi(rssi_t rssi);
+
+	/**
+	 * Match manufacturer specific data of the given company, see https://www.bluetooth.com/specifications/assigned-numbers/
+	 */
+	BleScanFilter& manufacturerId(uint16_t companyId);
+
+	/**
+	 * Match service data with the given 16-bit uuid.
+	 */
+	BleScanFilter& serviceDataUuid(uuid16_t uuid);
+
+	/**
+	 * Match a local name, complete or shortened, that starts with the given prefix.
+	 */
+	BleScanFilter& namePrefix(const char* prefix);
+
+	/**
+	 * Start a new group of criteria.
+	 */
+	BleScanFilter& orElse();
+
+	/**
+	 * Returns false when a criterion was invalid, or the criteria do not fit in MAX_SCAN_FILTER_SIZE bytes.
+	 */
+	bool valid() const;
+
+	/**
+	 * Check whether a scan passes the filter.
+	 *
+	 * @param[in] scan       The scan event from bluenet.
+	 *
+	 * @return true when the scan passes.
+	 */
+	bool matches(const microapp_sdk_ble_scan_event_t& scan) const;
+
+	/**
+	 * Get the criterion that can be evaluated by bluenet.
+	 *
+	 * @param[out] filter    The filter for bluenet, CS_MICROAPP_SDK_BLE_SCAN_FILTER_NONE if there is none.
+	 */
+	void bluenetFilter(microapp_sdk_ble_scan_filter_t& filter) const;
+};
@@ -0,0 +1,116 @@
+/*
+ * Merges advertisements with their scan response.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleScan.h>
+#include <BleUtils.h>
+#include <microapp.h>
+
+/*
+ * Number of devices of which an advertisement can wait for its scan response at the same time. Set it to the number
+ * of devices that pass the scan filter within DEFAULT_SCAN_MERGE_WINDOW_TICKS: when all entries are in use, the
+ * oldest waiting scan is passed on without its scan response. Each takes MAX_BLE_SCAN_DATA_LENGTH + 18 bytes of RAM.
+ * Only built in with BLE_MERGE_SCAN_RESPONSES=1, see config.mk.
+ */
+#ifndef MAX_SCAN_MERGE_ENTRIES
+#define MAX_SCAN_MERGE_ENTRIES 4
+#endif
+
+/*
+ * Default number of ticks after the tick of an advertisement during which its scan response is merged with it.
+ * A scan response follows its advertisement within milliseconds, so at most until the next tick.
+ */
+#ifndef DEFAULT_SCAN_MERGE_WINDOW_TICKS
+#define DEFAULT_SCAN_MERGE_WINDOW_TICKS 1
+#endif
+
+/*
+ * A scan event of which the data can hold an advertisement and its scan response.
+ */
+struct __attribute__((packed)) ble_merged_scan_t {
+	microapp_sdk_ble_scan_event_t scan;
+	//! Continuation of scan.data, so that scan.size can be up to MAX_BLE_SCAN_DATA_LENGTH.
+	uint8_t moreData[MAX_BLE_SCAN_DATA_LENGTH - MAX_BLE_ADV_DATA_LENGTH];
+};
+
+struct ble_scan_merge_entry_t {
+	ble_merged_scan_t merged;
+	//! Tick at which the advertisement was received, see tickCount().
+	uint32_t tick;
+	bool used;
+};
+
+/**
+ * Called with a scan that is done: an advertisement merged with its scan response, or a scan of which no scan
+ * response came within the window. Only valid during the call.
+ */
+typedef void (*MergedScanHandler)(const microapp_sdk_ble_scan_event_t& scan);
+
+/**
+ * Short lived buffer of scans by MAC address, to combine an advertisement and its scan response into one scan.
+ *
+ * Bluenet does not tell whether a scan is an advertisement or a scan response. Instead, a scan of a device that has a
+ * scan waiting is taken as its scan response when it has AD types that the waiting scan does not have, like the local
+ * name. Its AD structures of those types are then appended to the waiting scan, as far as they fit in
+ * MAX_BLE_SCAN_DATA_LENGTH, and the merged scan is passed on. Otherwise, the waiting scan is passed on by itself, and
+ * the new scan waits instead. Scans that wait longer than the window are passed on by themselves.
+ */
+class BleScanMerger {
+private:
+	ble_scan_merge_entry_t _entries[MAX_SCAN_MERGE_ENTRIES] = {};
+	uint16_t _windowTicks                                   = DEFAULT_SCAN_MERGE_WINDOW_TICKS;
+	//! Number of scans that were merged into a waiting scan.
+	uint32_t _mergedCount                                   = 0;
+
+	/**
+	 * Free the entry, and pass its scan on. The entry may be reused by the handler.
+	 */
+	void release(ble_scan_merge_entry_t& entry, MergedScanHandler handler);
+
+	/**
+	 * Append the AD structures of the scan of which the type is not in the entry yet.
+	 *
+	 * @return the number of AD types that the scan has, and the entry had not.
+	 */
+	uint8_t merge(ble_scan_merge_entry_t& entry, const microapp_sdk_ble_scan_event_t& scan, bool append);
+
+public:
+	/**
+	 * Add a scan, and pass on the scans that are done.
+	 *
+	 * @param[in] scan       The scan event from bluenet.
+	 * @param[in] handler    Handler to pass scans on to.
+	 */
+	void add(const microapp_sdk_ble_scan_event_t& scan, MergedScanHandler handler);
+
+	/**
+	 * Pass on scans that waited longer than the window.
+	 *
+	 * @param[in] handler    Handler to pass scans on to.
+	 * @param[in] all        True to pass on all waiting scans.
+	 */
+	void flush(MergedScanHandler handler, bool all = false);
+
+	/**
+	 * Forget the waiting scans.
+	 */
+	void clear();
+
+	/**
+	 * @param[in] windowTicks    Number of ticks after the tick of an advertisement during which its scan response is
+	 * merged with it.
+	 */
+	void configure(uint16_t windowTicks);
+
+	/**
+	 * Returns the number of scans that were merged into a waiting scan, since startup.
+	 */
+	uint32_t mergedCount();
+};
@@ -0,0 +1,102 @@
+/*
+ * Queue of scanned advertisements, for polling via BLE.available().
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleScan.h>
+#include <BleUtils.h>
+#include <microapp.h>
+
+/*
+ * Number of scans that are kept until the microapp polls them. Set it to the most scans that pass the filter between
+ * two polls: when polling every loop, the peak number of such scans per tick. A record holds the scan data, so each
+ * takes MAX_BLE_SCAN_DATA_LENGTH + 9 bytes of RAM. Only built in with BLE_SCAN_QUEUE=1, see config.mk.
+ */
+#ifndef MAX_SCAN_QUEUE_SIZE
+#define MAX_SCAN_QUEUE_SIZE 4
+#endif
+
+/**
+ * What to do with a new scan when the queue is full.
+ */
+enum BleScanOverflowPolicy {
+	//! Remove the oldest scan to make space for the new one. Default.
+	BleScanDropOldest = 0,
+	//! Drop the new scan.
+	BleScanDropNewest,
+	//! Remove the scan with the weakest RSSI, unless the new scan is the weakest, then drop the new scan.
+	BleScanKeepStrongest,
+};
+
+/**
+ * Compact copy of a scanned advertisement.
+ */
+struct ble_scan_record_t {
+	uint8_t address[MAC_ADDRESS_LENGTH];
+	uint8_t addressType;
+	rssi_t rssi;
+	uint8_t size;
+	uint8_t data[MAX_BLE_SCAN_DATA_LENGTH];
+};
+
+/**
+ * Fixed size FIFO of scan records.
+ */
+class BleScanQueue {
+private:
+	ble_scan_record_t _records[MAX_SCAN_QUEUE_SIZE];
+	//! Index of the oldest record.
+	uint8_t _start                = 0;
+	uint8_t _count                = 0;
+	BleScanOverflowPolicy _policy = BleScanDropOldest;
+	uint16_t _droppedCount        = 0;
+
+	ble_scan_record_t& at(uint8_t index);
+
+	/**
+	 * Remove the record at the given index, keeping the order of the others.
+	 */
+	void remove(uint8_t index);
+
+public:
+	/**
+	 * Add a scan to the queue, applying the overflow policy when it is full.
+	 *
+	 * @param[in] scan       The scan event from bluenet.
+	 *
+	 * @return true when the scan was added.
+	 */
+	bool push(const microapp_sdk_ble_scan_event_t& scan);
+
+	/**
+	 * Remove the oldest scan from the queue.
+	 *
+	 * @param[out] record    The oldest scan.
+	 *
+	 * @return false when the queue is empty.
+	 */
+	bool pop(ble_scan_record_t& record);
+
+	/**
+	 * Remove all scans. The drop counter is kept.
+	 */
+	void clear();
+
+	/**
+	 * Returns the number of scans in the queue.
+	 */
+	uint8_t size();
+
+	void setOverflowPolicy(BleScanOverflowPolicy policy);
+
+	/**
+	 * Returns the number of scans that were dropped because the queue was full.
+	 */
+	uint16_t droppedCount();
+};
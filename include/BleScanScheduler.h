@@ -0,0 +1,93 @@
+/*
+ * Scans in windows, to bound the load of scan interrupts.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <microapp.h>
+
+/*
+ * Number of cycles without dropped scans after which a shrunk scan window grows by one tick again.
+ */
+#ifndef SCAN_SCHEDULE_RECOVERY_CYCLES
+#define SCAN_SCHEDULE_RECOVERY_CYCLES 4
+#endif
+
+/*
+ * Number of ticks per cycle when scanning with a budget of scans per second.
+ */
+#ifndef SCAN_BUDGET_INTERVAL_TICKS
+#define SCAN_BUDGET_INTERVAL_TICKS (1000 / MICROAPP_LOOP_INTERVAL_MS)
+#endif
+
+/**
+ * Decides per tick whether bluenet should pass scans on, so that scans come in a window at the start of each cycle.
+ *
+ * At the start of each cycle, the window is adapted to the load of the previous cycle: it is halved when scans were
+ * dropped, and scaled down to the budget when more scans were received than the budget allows. After
+ * SCAN_SCHEDULE_RECOVERY_CYCLES cycles without drops, it grows by one tick, as long as the budget allows, up to the
+ * configured window.
+ */
+class BleScanScheduler {
+private:
+	//! Configured window, 0 when there is no schedule.
+	uint16_t _maxWindowTicks    = 0;
+	uint16_t _intervalTicks     = 0;
+	//! Maximum number of received scans per second, 0 for no limit.
+	uint16_t _maxScansPerSecond = 0;
+	//! Window adapted to the load.
+	uint16_t _windowTicks       = 0;
+	//! Tick within the current cycle.
+	uint16_t _cycleTick         = 0;
+	//! Number of cycles without drops since the window changed.
+	uint8_t _calmCycles         = 0;
+	//! Whether the counters of the cycle start are set.
+	bool _started               = false;
+	uint32_t _cycleReceived     = 0;
+	uint32_t _cycleDropped      = 0;
+
+	/**
+	 * Adapt the window to the number of scans received and dropped during the last cycle.
+	 */
+	void adapt(uint32_t received, uint32_t dropped);
+
+public:
+	/**
+	 * Start a new schedule, with the full window.
+	 *
+	 * @param[in] windowTicks          Number of ticks to scan at the start of each cycle, at most intervalTicks.
+	 * @param[in] intervalTicks        Number of ticks per cycle, 0 to scan all the time.
+	 * @param[in] maxScansPerSecond    Maximum number of received scans per second, 0 for no limit.
+	 */
+	void configure(uint16_t windowTicks, uint16_t intervalTicks, uint16_t maxScansPerSecond = 0);
+
+	/**
+	 * Remove the schedule.
+	 */
+	void clear();
+
+	/**
+	 * Returns whether there is a schedule.
+	 */
+	bool enabled();
+
+	/**
+	 * Advance one tick.
+	 *
+	 * @param[in] received   Number of scans received since startup.
+	 * @param[in] dropped    Number of scans dropped since startup, for lack of time or space to handle them.
+	 *
+	 * @return true if bluenet should pass scans on during this tick.
+	 */
+	bool tick(uint32_t received, uint32_t dropped);
+
+	/**
+	 * Returns the current window in ticks.
+	 */
+	uint16_t windowTicks();
+};
@@ -0,0 +1,92 @@
+/*
+ * Counters of the scan pipeline.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <microapp.h>
+
+/*
+ * Snapshot of the scan counters, as returned by Ble::scanStats(), and sent by Ble::dumpScanStats().
+ *
+ * Every scan that reaches the BLE class is either filtered, merged, deduplicated, or delivered:
+ * received = filtered + merged + deduplicated + delivered, apart from scans that wait for their scan response.
+ * The counters wrap around, so compute rates from the differences
+ * between two snapshots. Scans that bluenet did not pass to the microapp are not counted.
+ */
+struct __attribute__((packed)) ble_scan_stats_t {
+	//! Scans received from bluenet.
+	uint32_t received;
+	//! Scans dropped because scanning is stopped, or by the allowlist or the scan filter.
+	uint32_t filtered;
+	//! Scan responses merged into their advertisement, see Ble::mergeScanResponses().
+	uint32_t merged;
+	//! Scans dropped as duplicate.
+	uint32_t deduplicated;
+	//! Scans passed to a handler, or kept for available().
+	uint32_t delivered;
+	//! Delivered scans that were dropped because the queue for available() was full, saturates at 0xFFFF. Always 0
+	//! without the queue, see BLE_SCAN_QUEUE in config.mk.
+	uint16_t queueDropped;
+	//! BLE interrupts dropped because all interrupt slots were in use, see busyInterruptCount(). Wraps around.
+	uint32_t busyDropped;
+	//! BLE interrupts dropped because the queue of deferred interrupts was full, see droppedInterruptCount(). Wraps
+	//! around.
+	uint32_t deferDropped;
+	//! Number of ticks per microsecond of the handler times, see profilerTicks().
+	uint16_t ticksPerUs;
+	//! Shortest, average and longest time in ticks to deliver a scan, including the handlers of the user. Only
+	//! measured when built with PROFILING=1, see config.mk, 0 otherwise.
+	uint32_t handlerMin;
+	uint32_t handlerAvg;
+	uint32_t handlerMax;
+};
+
+/**
+ * Counts scans at each step of Ble::handleScanEvent(). Always on, so it only increments. When built with PROFILING=1,
+ * it also times their delivery.
+ */
+class BleScanStats {
+private:
+	uint32_t _received     = 0;
+	uint32_t _filtered     = 0;
+	uint32_t _deduplicated = 0;
+	uint32_t _delivered    = 0;
+#ifdef MICROAPP_PROFILING
+	uint32_t _handlerMin   = 0xFFFFFFFF;
+	uint32_t _handlerMax   = 0;
+	//! Sum and number of the handler times, both halved when the sum would overflow.
+	uint32_t _handlerSum   = 0;
+	uint32_t _handlerCount = 0;
+#endif
+
+public:
+	void received() { _received++; }
+
+	void filtered() { _filtered++; }
+
+	void deduplicated() { _deduplicated++; }
+
+	void delivered() { _delivered++; }
+
+#ifdef MICROAPP_PROFILING
+	/**
+	 * Add the time from start until now to the handler times.
+	 *
+	 * @param[in] start      Time in ticks of profilerTicks() at the start of the delivery.
+	 */
+	void recordHandler(uint32_t start);
+#endif
+
+	/**
+	 * Fill in the counters of this class, the other fields are left as they are.
+	 */
+	void get(ble_scan_stats_t& stats);
+
+	void reset();
+};
@@ -0,0 +1,190 @@
+/*
+ * View on a scanned advertisement, without copying it.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <BleMacAddress.h>
+#include <BleScan.h>
+#include <BleUtils.h>
+#include <String.h>
+#include <microapp.h>
+
+/**
+ * Passed to a BLEDeviceScannedView handler, see Ble::setEventHandler(). Unlike the BleDevice that is passed to a
+ * BLEDeviceScanned handler, it does not hold a copy of the advertisement, but points into the buffer of the interrupt.
+ * Therefore, it is only valid during the call of the handler: do not keep it, nor the data returned by it.
+ *
+ * The accessors are the same as those of BleDevice, but return the data in place where possible. To connect to the
+ * device, or to keep it, turn the view into a BleDevice with device().
+ */
+class BleScanView {
+private:
+	friend class Ble;
+
+	BleScanView(const microapp_sdk_ble_scan_event_t& scan) : _scan(scan) {}
+
+	const microapp_sdk_ble_scan_event_t& _scan;
+
+	// offsets of the AD structures in the scan data, built on the first query, see adIndex()
+	ble_ad_index_t _adIndex;
+
+	/**
+	 * Returns the index of the scan data, which is built the first time.
+	 */
+	const ble_ad_index_t& adIndex();
+
+public:
+	/**
+	 * Get the address of the device.
+	 *
+	 * @return string in the format "AA:BB:CC:DD:EE:FF".
+	 */
+	String address();
+
+	/**
+	 * Get the address of the device, in the byte order of bluenet (reversed), without formatting it.
+	 *
+	 * @return pointer to the MAC_ADDRESS_LENGTH bytes of the address.
+	 */
+	const uint8_t* addressBytes();
+
+	/**
+	 * Get the type of the address of the device: MICROAPP_SDK_BLE_ADDRESS_PUBLIC, etc.
+	 */
+	uint8_t addressType();
+
+	/**
+	 * Get the received signal strength of the advertisement.
+	 */
+	int8_t rssi();
+
+	/**
+	 * Get the raw advertisement data.
+	 */
+	const uint8_t* data();
+
+	/**
+	 * Get the size of the raw advertisement data.
+	 */
+	uint8_t size();
+
+	/**
+	 * Returns whether the device has advertised a local name
+	 *
+	 * @return true    if the advertisement contains a local name field (either complete or shortened).
+	 * @return false   if the advertisement does not contain a local name field.
+	 */
+	bool hasLocalName();
+
+	/**
+	 * Returns the advertised local name of the device, in place: it is not null terminated.
+	 *
+	 * @return the data of either the complete local name field or the shortened local name field. The length is 0 if
+	 * the device does not advertise a local name.
+	 */
+	ble_ad_t localName();
+
+	/**
+	 * Query if the device is advertising a service UUID
+	 *
+	 * @param[in] uuid      16-bit uuid to look for, or 0 for any.
+	 * @return true if the device is advertising the service UUID
+	 */
+	bool hasAdvertisedServiceUuid(uuid16_t uuid = 0);
+
+	/**
+	 * Query the number of 16-bit service UUIDs the device is advertising
+	 */
+	uint8_t advertisedServiceUuidCount();
+
+	/**
+	 * Query a 16-bit service UUID the device is advertising
+	 *
+	 * @param index (optional) the index of the service UUID. Defaults to 0
+	 * @return the service UUID, 0 if there is none at that index
+	 */
+	uuid16_t advertisedServiceUuid(uint8_t index = 0);
+
+	/**
+	 * Query the number of service uuids of a given size the device is advertising
+	 *
+	 * @param uuidLength number of bytes of the uuids: UUID_16BIT_BYTE_LENGTH, UUID_32BIT_BYTE_LENGTH or
+	 * UUID_128BIT_BYTE_LENGTH
+	 * @return the number of uuids
+	 */
+	uint8_t advertisedServiceUuidCount(uint8_t uuidLength);
+
+	/**
+	 * Query a service uuid of a given size the device is advertising, in place
+	 *
+	 * @param uuidLength number of bytes of the uuid, see advertisedServiceUuidCount()
+	 * @param index the index of the service uuid
+	 * @return pointer to the uuid, little endian, as advertised. nullptr if not found
+	 */
+	const uint8_t* advertisedServiceUuidBytes(uint8_t uuidLength, uint8_t index = 0);
+
+	/**
+	 * Find the service data of a 16-bit uuid in the scanned advertisement data
+	 *
+	 * @param[in] uuid the uuid of the service data
+	 * @param[out] foundData pointers to the uuid and the data after it, and their lengths
+	 * @return true if found
+	 */
+	bool findServiceData(uuid16_t uuid, ble_service_data_t* foundData);
+
+	/**
+	 * Iterate over the service data in the scanned advertisement data, with any uuid size
+	 *
+	 *   uint8_t cursor = 0;
+	 *   ble_service_data_t serviceData;
+	 *   while (view.nextServiceData(cursor, &serviceData)) { ... }
+	 *
+	 * @param[in,out] cursor 0 to start, keeps the position
+	 * @param[out] foundData pointers to the uuid and the data after it, and their lengths
+	 * @return true if more service data was found
+	 */
+	bool nextServiceData(uint8_t& cursor, ble_service_data_t* foundData);
+
+	/**
+	 * Find the manufacturer specific data of a company in the scanned advertisement data
+	 *
+	 * @param[in] companyId the company identifier, e.g. 0x004C for Apple
+	 * @param[out] foundData pointer to the data after the company id, and its length
+	 * @return true if found
+	 */
+	bool findManufacturerData(uint16_t companyId, ble_manufacturer_data_t* foundData);
+
+	/**
+	 * Iterate over the manufacturer specific data in the scanned advertisement data, see nextServiceData()
+	 *
+	 * @param[in,out] cursor 0 to start, keeps the position
+	 * @param[out] foundData company id, and pointer to the data after it and its length
+	 * @return true if more manufacturer specific data was found
+	 */
+	bool nextManufacturerData(uint8_t& cursor, ble_manufacturer_data_t* foundData);
+
+	/**
+	 * Find an advertisement of type type in the scanned advertisement data
+	 *
+	 * @param[in] type the type of ad to look for
+	 * @param[out] foundData pointer to found ad + length of the ad, if present
+	 * @return true if the advertisement contains an ad of type type
+	 * @return false otherwise
+	 */
+	bool findAdvertisementDataType(GapAdvType type, ble_ad_t* foundData);
+
+	/**
+	 * Copy the advertisement into the device that is also returned by BLE.available(), for example to connect to it.
+	 * This replaces the previous device that was returned by BLE.available(), unless a request to it, like
+	 * connectAsync(), waits for its event.
+	 *
+	 * @return the device, which evaluates to false if the previous device was not replaced.
+	 */
+	BleDevice& device();
+};
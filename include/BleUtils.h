@@ -35,6 +35,10 @@ enum BleEventType {
 	BLEWritten      = 0x07,
 	// BleNotification
 	BLENotification = 0x08,
+	// BleScanView
+	BLEDeviceScannedView = 0x09,
+	// BleDeviceTracker
+	BLEDevicePresence = 0x0A,
 };
 
 enum BleAsyncResult {
@@ -47,8 +51,10 @@ enum BleAsyncResult {
 // Forward declarations
 class BleDevice;
 class BleCharacteristic;
+class BleScanView;
 
 typedef void (*DeviceEventHandler)(BleDevice&);
+typedef void (*ScanViewEventHandler)(BleScanView&);
 typedef void (*CharacteristicEventHandler)(BleDevice&, BleCharacteristic&);
 typedef void (*NotificationEventHandler)(BleDevice&, BleCharacteristic&, uint8_t*, uint16_t);
 // All of the above can be cast to a  (generic) BleEventHandler (and back)
@@ -83,3 +89,13 @@ bool convertTwoHexCharsToByte(const char* chars, uint8_t* byte);
  * @param[out] res   Pointer to a pair of chars.
  */
 void convertByteToTwoHexChars(uint8_t byte, char* res);
+
+/**
+ * FNV-1a hash of a block of data, for the hash tables of scanned devices.
+ *
+ * @param[in] data   Pointer to the data.
+ * @param[in] size   Number of bytes.
+ *
+ * @return the hash.
+ */
+uint32_t hashBytes(const uint8_t* data, uint8_t size);
@@ -9,6 +9,8 @@ typedef uint16_t uuid16_t;
 const microapp_size_t UUID_16BIT_BYTE_LENGTH = 2;
 // format "ABCD"
 const microapp_size_t UUID_16BIT_STRING_LENGTH = 4;
+// amount of bytes in a 32-bit uuid
+const microapp_size_t UUID_32BIT_BYTE_LENGTH = 4;
 // amount of bytes in a 128-bit uuid
 const microapp_size_t UUID_128BIT_BYTE_LENGTH = 16;
 // format "12345678-ABCD-1234-5678-ABCDEF123456"
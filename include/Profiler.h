@@ -0,0 +1,115 @@
+/*
+ * Profiler.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <microapp.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Profiling is enabled by building with PROFILING=1, which defines MICROAPP_PROFILING.
+ * It then times every call to bluenet, every interrupt handler, and every loop.
+ * On the target, time is measured in cycles of the DWT cycle counter, on the host in nanoseconds of a monotonic clock.
+ */
+
+/*
+ * Number of buckets per histogram.
+ */
+const uint8_t PROFILER_BUCKETS = 12;
+
+/*
+ * Durations below 2^PROFILER_FIRST_BUCKET_BITS ticks go in the first bucket. Each next bucket covers durations of
+ * twice as long, the last bucket has all longer durations.
+ */
+const uint8_t PROFILER_FIRST_BUCKET_BITS = 9;
+
+/*
+ * Number of types that have a histogram, indexed by MicroappSdkType.
+ */
+const uint8_t PROFILER_TYPES = CS_MICROAPP_SDK_TYPE_BLUENET_EVENT + 1;
+
+/*
+ * What is timed.
+ */
+enum ProfilerKind {
+	//! A call to bluenet, from sending the request until the microapp is resumed. Per type of request.
+	PROFILER_CALL      = 1,
+	//! An interrupt handler. Per type of interrupt.
+	PROFILER_INTERRUPT = 2,
+	//! The loop function, including the calls it makes. Type is 0.
+	PROFILER_LOOP      = 3,
+};
+
+struct __attribute__((packed)) profiler_histogram_t {
+	//! Longest duration in ticks.
+	uint32_t max;
+	//! Number of durations per bucket, saturates at 0xFFFF.
+	uint16_t buckets[PROFILER_BUCKETS];
+};
+
+/*
+ * Report of a single histogram, as sent by profilerDump().
+ */
+struct __attribute__((packed)) profiler_report_t {
+	//! See ProfilerKind.
+	uint8_t kind;
+	//! MicroappSdkType for calls and interrupts.
+	uint8_t type;
+	//! Number of ticks per microsecond: the frequency of the clock in MHz.
+	uint16_t ticksPerUs;
+	uint8_t bucketCount;
+	uint8_t firstBucketBits;
+	profiler_histogram_t histogram;
+};
+
+/**
+ * Get the current time in ticks. Wraps around, only use it to compute differences.
+ */
+uint32_t profilerTicks();
+
+/**
+ * Get the number of ticks per microsecond: the frequency of the clock of profilerTicks() in MHz.
+ */
+uint16_t profilerTicksPerUs();
+
+/**
+ * Add the duration from start until now to a histogram.
+ *
+ * @param[in] kind   See ProfilerKind.
+ * @param[in] type   The MicroappSdkType, ignored if it has no histogram.
+ * @param[in] start  Time in ticks at the start.
+ */
+void profilerRecord(ProfilerKind kind, uint8_t type, uint32_t start);
+
+/**
+ * Get a histogram.
+ *
+ * @return the histogram, or a null pointer if there is no histogram of this kind and type.
+ */
+const profiler_histogram_t* profilerHistogram(ProfilerKind kind, uint8_t type);
+
+/**
+ * Clear all histograms.
+ */
+void profilerReset();
+
+/**
+ * Send each histogram that is not empty as a profiler_report_t via Message.write().
+ *
+ * @return the number of reports that were sent.
+ */
+uint8_t profilerDump();
+
+#ifdef __cplusplus
+}
+#endif
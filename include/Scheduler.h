@@ -0,0 +1,199 @@
+/*
+ * Cooperative task scheduler.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <microapp.h>
+#include <stdint.h>
+
+/**
+ * Maximum number of tasks that can be added to the scheduler at the same time.
+ */
+#define MAX_TASKS 8
+
+class Task;
+
+/**
+ * A task function. It is called every time the task is resumed, and should start with TASK_BEGIN and end with
+ * TASK_END.
+ *
+ * Tasks are stackless (protothreads): local variables do not keep their value when the task yields, sleeps or waits.
+ * Keep state that should survive those in static or global variables, or in the object passed as argument.
+ */
+typedef void (*TaskFunction)(Task& task);
+
+/**
+ * Start of the body of a task function.
+ */
+#define TASK_BEGIN(task)              \
+	switch ((task).resumePoint()) { \
+		case 0:
+
+/**
+ * End of the body of a task function. The task is removed from the scheduler when it gets here.
+ */
+#define TASK_END(task) \
+	}                  \
+	(task).end();      \
+	return
+
+/**
+ * Let the other tasks run, and continue here at the next tick.
+ */
+#define TASK_YIELD(task)                      \
+	do {                                      \
+		(task).setResumePoint(__LINE__);      \
+		return;                               \
+		case __LINE__:;                       \
+	} while (0)
+
+/**
+ * Let the other tasks run, and continue here after at least the given number of milliseconds.
+ */
+#define TASK_SLEEP(task, ms)   \
+	do {                       \
+		(task).sleep(ms);      \
+		TASK_YIELD(task);      \
+	} while (0)
+
+/**
+ * Continue when the condition is true. It is evaluated right away, and then once every tick.
+ * The condition can for example be a flag that is set by an event handler.
+ */
+#define TASK_WAIT_UNTIL(task, condition)      \
+	do {                                      \
+		(task).setResumePoint(__LINE__);      \
+		case __LINE__:                        \
+			if (!(condition)) {               \
+				return;                       \
+			}                                 \
+	} while (0)
+
+/**
+ * Continue when the request of a BleFuture has completed.
+ */
+#define TASK_AWAIT(task, future) TASK_WAIT_UNTIL(task, (future).ready())
+
+/**
+ * State of a task in the scheduler.
+ */
+class Task {
+public:
+	/**
+	 * Get the argument that was given when the task was added.
+	 */
+	void* arg() { return _arg; }
+
+	/**
+	 * Get the line to continue at. Used by the TASK_ macros.
+	 */
+	uint16_t resumePoint() { return _resumePoint; }
+
+	/**
+	 * Set the line to continue at. Used by the TASK_ macros.
+	 */
+	void setResumePoint(uint16_t line) { _resumePoint = line; }
+
+	/**
+	 * Do not resume the task until the given number of milliseconds have passed. Used by TASK_SLEEP.
+	 */
+	void sleep(uint32_t ms);
+
+	/**
+	 * Remove the task from the scheduler. Used by TASK_END.
+	 */
+	void end() { _function = nullptr; }
+
+private:
+	friend class SchedulerClass;
+
+	TaskFunction _function = nullptr;
+	void* _arg             = nullptr;
+	uint16_t _resumePoint  = 0;
+	//! Tick at which the task may be resumed.
+	uint32_t _wakeTick     = 0;
+};
+
+/**
+ * Class to run several tasks side by side, within a single microapp loop.
+ *
+ * Call Scheduler.run() once in loop(). Each call resumes every task that is not sleeping, once, until it yields,
+ * sleeps, waits or ends. None of the tasks should call blocking functions like delay() or BleDevice::connect(),
+ * as those block all other tasks as well. Use the asynchronous variants together with TASK_AWAIT instead.
+ *
+ * Example:
+ *
+ *   void blink(Task& task) {
+ *     TASK_BEGIN(task);
+ *     while (true) {
+ *       digitalWrite(LED1_PIN, HIGH);
+ *       TASK_SLEEP(task, 1000);
+ *       digitalWrite(LED1_PIN, LOW);
+ *       TASK_SLEEP(task, 1000);
+ *     }
+ *     TASK_END(task);
+ *   }
+ */
+class SchedulerClass {
+public:
+	static SchedulerClass& getInstance() {
+		// Guaranteed to be destroyed.
+		static SchedulerClass instance;
+
+		// Instantiated on first use.
+		return instance;
+	}
+
+	/**
+	 * Add a task. It first runs at the next call to run(), or later in the current call when added from a task.
+	 *
+	 * @param[in] function   The task function.
+	 * @param[in] arg        Argument that the task can get via Task::arg().
+	 *
+	 * @return               The added task, or nullptr when there are already MAX_TASKS tasks.
+	 */
+	Task* add(TaskFunction function, void* arg = nullptr);
+
+	/**
+	 * Remove a task. Do not call this from the task itself, let it get to TASK_END instead.
+	 *
+	 * @return               False when the task was not found.
+	 */
+	bool remove(Task* task);
+
+	/**
+	 * Resume all tasks that are not sleeping, and advance the tick. Should be called once every loop.
+	 */
+	void run();
+
+	/**
+	 * Returns the number of tasks.
+	 */
+	uint8_t count();
+
+	/**
+	 * Returns the number of ticks, each of MICROAPP_LOOP_INTERVAL_MS, that the scheduler ran.
+	 */
+	uint32_t ticks() { return _tick; }
+
+private:
+	SchedulerClass() {}
+	SchedulerClass(SchedulerClass const&) = delete;
+	void operator=(SchedulerClass const&) = delete;
+
+	Task _tasks[MAX_TASKS];
+
+	//! Incremented every run.
+	uint32_t _tick = 0;
+
+	friend class Task;
+};
+
+//! The global instance.
+#define Scheduler SchedulerClass::getInstance()
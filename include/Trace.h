@@ -0,0 +1,96 @@
+/*
+ * Trace of the messages between microapp and bluenet.
+ *
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 17, 2026
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cs_MicroappStructs.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Tracing is enabled by building with TRACING=1, which defines MICROAPP_TRACING.
+ * It then records every request to bluenet, the response of bluenet to it, every interrupt from bluenet, and the
+ * result of the microapp for it. On the target, records are kept in a ring buffer in RAM, of which the oldest records
+ * are overwritten. On the host, records are written to the file given to the simulator, see host/Simulator.h, which
+ * can also replay a trace.
+ *
+ * A trace is a sequence of records, each a trace_record_header_t followed by size bytes of the message.
+ */
+
+/*
+ * Size of the ring buffer in RAM, on the target.
+ */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 256
+#endif
+
+/*
+ * What is recorded.
+ */
+enum TraceKind {
+	//! Request of the microapp, from the outgoing buffer. A yield request ends a tick.
+	TRACE_REQUEST          = 1,
+	//! The same request, after bluenet handled it: with the ack and the data of bluenet.
+	TRACE_RESPONSE         = 2,
+	//! Interrupt from bluenet, from the incoming buffer.
+	TRACE_INTERRUPT        = 3,
+	//! Header of the interrupt, with the result of the microapp in the ack.
+	TRACE_INTERRUPT_RESULT = 4,
+};
+
+struct __attribute__((packed)) trace_record_header_t {
+	//! See TraceKind.
+	uint8_t kind;
+	//! Number of bytes of the message that follow. Messages are cut off at 255 bytes.
+	uint8_t size;
+	//! Number of yields before this record, wraps around.
+	uint16_t tick;
+};
+
+/**
+ * Record a message. Used by the SDK.
+ *
+ * @param[in] kind       See TraceKind.
+ * @param[in] payload    The message.
+ */
+void traceRecord(TraceKind kind, const uint8_t* payload);
+
+/**
+ * Move the oldest records from the ring buffer to the given buffer, as many as fit.
+ *
+ * @return the number of bytes written to the buffer, 0 when there are no records, or on the host.
+ */
+uint16_t traceRead(uint8_t* buffer, uint16_t size);
+
+/**
+ * Returns the number of records that were overwritten or did not fit in the ring buffer.
+ */
+uint16_t traceDroppedCount();
+
+/**
+ * Send all records in the ring buffer via Message.write(), as many records per message as fit.
+ * The messages of the dump itself are not recorded. On the host, this does nothing.
+ *
+ * @return the number of messages that were sent.
+ */
+uint8_t traceDump();
+
+#ifdef MICROAPP_HOST
+/**
+ * Write a record to the trace file. Implemented by the simulator.
+ */
+void traceOutput(const uint8_t* data, uint16_t size);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,18 +10,36 @@ extern "C" {
 // Interrupt functions
 typedef microapp_sdk_result_t (*interruptFunction)(void*);
 
+/*
+ * Table with the interrupt handlers of a single SDK type, indexed by id.
+ * Each subsystem defines the table for its own type (see DEFINE_INTERRUPT_TABLE), so that only the subsystems that
+ * are linked in take up RAM for interrupt handlers.
+ */
+struct interrupt_table_t {
+	//! Offset of the id in interrupt messages of this type.
+	uint8_t idOffset;
+	//! Number of ids, ids should be smaller than this.
+	uint8_t size;
+	interruptFunction* handlers;
+};
+
+/*
+ * Define an interrupt table with the given name, for interrupt messages of type messageStruct.
+ * The id of an interrupt is the field idField of the message, and should be smaller than tableSize.
+ */
+#define DEFINE_INTERRUPT_TABLE(name, messageStruct, idField, tableSize) \
+	static interruptFunction name##Handlers[tableSize];                 \
+	static interrupt_table_t name = {__builtin_offsetof(messageStruct, idField), tableSize, name##Handlers};
+
 // Store interrupts in the microapp
 struct interrupt_registration_t {
 	MicroappSdkType type;
 	uint8_t id;
 	interruptFunction handler;
-	bool registered;
+	//! The table of this type, where the handler is stored.
+	interrupt_table_t* table;
 };
 
-#define MAX_INTERRUPT_REGISTRATIONS 6
-
-extern interrupt_registration_t interruptRegistrations[MAX_INTERRUPT_REGISTRATIONS];
-
 // define microapp_size_t as a 16-bit unsigned int
 typedef uint16_t microapp_size_t;
 
@@ -63,6 +81,28 @@ int memcmp(const void* ptr1, const void* ptr2, microapp_size_t num);
  */
 void* memcpy(void* dest, const void* src, microapp_size_t num);
 
+/**
+ * Sets num bytes of dest to value
+ *
+ * @param[in] dest   The starting address of the bytes to set
+ * @param[in] value  The value to set, converted to a byte
+ * @param[in] num    The number of bytes to set
+ *
+ * @return           A pointer to dest
+ */
+void* memset(void* dest, int value, microapp_size_t num);
+
+/**
+ * Copies num bytes from src to dest, where src and dest may overlap
+ *
+ * @param[in] dest   The starting address to copy data to
+ * @param[in] src    The starting address from where to copy data
+ * @param[in] num    The number of bytes to copy
+ *
+ * @return           A pointer to dest
+ */
+void* memmove(void* dest, const void* src, microapp_size_t num);
+
 /*
  * Get outgoing message buffer (can be used for sendMessage);
  */
@@ -77,6 +117,173 @@ uint8_t* getIncomingMessagePayload();
  */
 microapp_sdk_result_t sendMessage();
 
+/*
+ * Message type of a batch of requests. Not (yet) part of the bluenet SDK types.
+ */
+const uint8_t MICROAPP_SDK_TYPE_BATCH = 0x80;
+
+/*
+ * Maximum number of requests in a single batch.
+ */
+const uint8_t MAX_BATCH_ENTRIES = 16;
+
+/*
+ * Header of a batch message. It is followed by count entries, each made up of one size byte and a request of
+ * that size. Bluenet writes the result of each request in the ack field of that request.
+ */
+struct __attribute__((packed)) microapp_sdk_batch_header_t {
+	microapp_sdk_header_t header;
+	uint8_t count;
+};
+
+/**
+ * Start queueing requests instead of sending them one by one.
+ *
+ * While a batch is open, fire-and-forget requests (logs, pin writes, switch, service data, mesh and message sends)
+ * are appended to the batch, and sendMessage() returns CS_MICROAPP_SDK_ACK_SUCCESS without yielding. Any other
+ * request first commits the batch, and is then sent as usual. Requests made from an interrupt handler are never
+ * batched.
+ *
+ * Batches are only available when the microapp is built with BATCHING=1, see config.mk. The queue takes about
+ * MICROAPP_SDK_MAX_PAYLOAD + MAX_BATCH_ENTRIES bytes of RAM. Without it, requests are sent one by one as usual.
+ *
+ * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
+ * @return CS_MICROAPP_SDK_ACK_ERR_ALREADY_EXISTS if a batch is already open
+ * @return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED if the microapp is built without batches
+ */
+microapp_sdk_result_t beginBatch();
+
+/**
+ * Send all queued requests to bluenet in a single roundtrip and close the batch.
+ *
+ * If bluenet does not support batches, or does not handle this one, for example because it is busy, the queued
+ * requests are sent one by one instead.
+ *
+ * @return CS_MICROAPP_SDK_ACK_SUCCESS if all requests were handled with success
+ * @return CS_MICROAPP_SDK_ACK_ERR_EMPTY if no batch is open
+ * @return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED if the microapp is built without batches
+ * @return the first ack that was not a success otherwise
+ */
+microapp_sdk_result_t commitBatch();
+
+/**
+ * Get the number of requests that were sent with the last committed batch.
+ */
+uint8_t batchSize();
+
+/**
+ * Get the result of a request from the last committed batch.
+ *
+ * @param[in] index  Index of the request, in the order they were made.
+ *
+ * @return the ack bluenet wrote for this request
+ * @return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND if there is no request with this index
+ */
+microapp_sdk_result_t batchResult(uint8_t index);
+
+/*
+ * Pattern that the free stack is painted with at startup. Should match startup.S.
+ */
+const uint32_t STACK_PAINT_PATTERN = 0xA5A5A5A5;
+
+/**
+ * Get the size of the stack in bytes: the RAM that is not used by data, and can be used by the stack.
+ *
+ * Bluenet interrupts that happen while the microapp runs use this stack as well.
+ */
+microapp_size_t stackSize();
+
+/**
+ * Get the number of free bytes on the stack, below the current stack pointer.
+ */
+microapp_size_t stackFree();
+
+/**
+ * Get the maximum number of bytes that has been used on the stack since startup.
+ *
+ * This is measured by looking for the lowest part of the stack that has been written to. It takes some time, as the
+ * whole unused part of the stack is checked, so sample it occasionally, for example every few seconds.
+ */
+microapp_size_t stackPeakUsage();
+
+/**
+ * Get the maximum interrupt nesting depth that has been reached since startup.
+ * When this equals the maximum depth, interrupts may have been dropped.
+ */
+uint8_t peakInterruptDepth();
+
+/**
+ * Get the number of interrupts of a type that were dropped because all interrupt slots were in use. Wraps around, so
+ * take the difference of two counts with unsigned subtraction. Deferred interrupts do not take a slot, see
+ * deferInterrupts().
+ */
+uint32_t busyInterruptCount(MicroappSdkType type);
+
+/*
+ * Maximum number of calls to bluenet per tick. When the microapp makes more calls, bluenet pauses it until the next
+ * tick. Should be equal to the limit in bluenet.
+ */
+const uint8_t MAX_CALLS_PER_TICK = 8;
+
+/**
+ * Get the number of ticks since startup, each of MICROAPP_LOOP_INTERVAL_MS. Wraps around.
+ *
+ * Ticks are counted by the yields to bluenet, and by the calls after which bluenet pauses the microapp.
+ */
+uint32_t tickCount();
+
+/**
+ * Called at the start of each tick, from the main context.
+ */
+typedef void (*tickFunction)();
+
+/**
+ * Set a function that is called at the start of each tick that starts with a yield to bluenet, after the deferred
+ * requests and interrupts are handled. It may make calls to bluenet, but not yield.
+ *
+ * @param[in] handler    The function, or a null pointer to remove it.
+ */
+void setTickHandler(tickFunction handler);
+
+/**
+ * Set a function of the SDK itself that is called at the start of each tick, right before the one set with
+ * setTickHandler(). This way, classes like Ble can act on ticks without taking the tick handler of the user.
+ *
+ * @param[in] handler    The function, or a null pointer to remove it.
+ */
+void setInternalTickHandler(tickFunction handler);
+
+/**
+ * Get the number of calls to bluenet that can still be made in this tick, before bluenet pauses the microapp.
+ *
+ * Calls are counted from the last yield to bluenet, which happens at the end of each loop and in delay().
+ * Calls made from interrupt handlers are not counted.
+ */
+uint8_t remainingCallsThisTick();
+
+/**
+ * Keep a number of calls per tick free for calls that are not of low priority, like switching.
+ *
+ * Once no more than this number of calls is left in a tick, low priority calls (logs and service data updates) are
+ * deferred: they return CS_MICROAPP_SDK_ACK_SUCCESS right away, and are sent at the start of the next tick.
+ * Deferring is disabled when the count is 0, which is the default.
+ *
+ * Deferring is only available when the microapp is built with DEFERRED_CALLS=1, see config.mk. The deferred calls
+ * are kept in a queue of about MICROAPP_SDK_MAX_PAYLOAD bytes of RAM.
+ *
+ * @param[in] count  Number of calls to keep free.
+ *
+ * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
+ * @return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE if the count is not smaller than MAX_CALLS_PER_TICK
+ * @return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED if the microapp is built without deferred calls
+ */
+microapp_sdk_result_t reserveCallsPerTick(uint8_t count);
+
+/**
+ * Get the number of low priority calls that are deferred to the next tick.
+ */
+uint8_t deferredCallCount();
+
 /*
  * Returns the number of empty slots for bluenet.
  */
@@ -84,6 +291,11 @@ uint8_t emptySlotsInStack();
 
 /**
  * Register a softInterrupt locally.
+ *
+ * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
+ * @return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED if the type has no interrupts, or the table is of another type
+ * @return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE if the id does not fit in the table
+ * @return CS_MICROAPP_SDK_ACK_ERR_ALREADY_EXISTS if a handler is already registered for this type and id
  */
 microapp_sdk_result_t registerInterrupt(interrupt_registration_t* interrupt);
 
@@ -97,6 +309,57 @@ microapp_sdk_result_t removeInterruptRegistration(MicroappSdkType type, uint8_t
  */
 microapp_sdk_result_t handleInterrupt(microapp_sdk_header_t* header);
 
+/*
+ * Size in bytes of the queue for deferred interrupts. Each interrupt takes its message size plus one byte: a scan
+ * with 31 bytes of advertisement data takes about 45 bytes, so the default holds about 11 scans. Set it to a bit more
+ * than the sum of the quota times the message size of the deferred types.
+ */
+#ifndef INTERRUPT_QUEUE_SIZE
+#define INTERRUPT_QUEUE_SIZE 512
+#endif
+
+/**
+ * Defer interrupts of a type to the main loop.
+ *
+ * Instead of calling the handler right away, which takes an interrupt slot, the interrupt is copied to a queue and
+ * acked. The queue is drained at the start of every tick, before the microapp continues: after each loop and in
+ * delay(). Since deferred interrupts never nest, bursts of them are not dropped for lack of slots. When the quota
+ * of the type is reached, or the queue is full, the interrupt is dropped and counted.
+ *
+ * BLE central read and notification events are always handled right away, as their data is only valid during the
+ * interrupt.
+ *
+ * Deferring is only available when the microapp is built with DEFERRED_INTERRUPTS=1, see config.mk, as the queue
+ * takes INTERRUPT_QUEUE_SIZE bytes of RAM, plus a few bytes per type. Without it, interrupts are handled right away.
+ *
+ * @param[in] type   Type of interrupts to defer.
+ * @param[in] quota  Maximum number of interrupts of this type in the queue, 0 to handle them right away again.
+ *
+ * @return CS_MICROAPP_SDK_ACK_SUCCESS on success
+ * @return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED if the type has no interrupts
+ * @return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED if the microapp is built without deferred interrupts
+ */
+microapp_sdk_result_t deferInterrupts(MicroappSdkType type, uint8_t quota);
+
+/**
+ * Call the handlers of the deferred interrupts that are queued.
+ * Does nothing when called from an interrupt handler, or from a handler that is called by this function.
+ *
+ * @return the number of interrupts that were handled
+ */
+microapp_size_t drainInterrupts();
+
+/**
+ * Get the number of queued interrupts of a type.
+ */
+uint8_t queuedInterruptCount(MicroappSdkType type);
+
+/**
+ * Get the number of interrupts of a type that were dropped because the queue or the quota was full. Wraps around, so
+ * take the difference of two counts with unsigned subtraction.
+ */
+uint32_t droppedInterruptCount(MicroappSdkType type);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+
+"""Generate the source file with the table of the MAC allowlist, see include/BleMacAllowlist.h."""
+
+import argparse
+import re
+import sys
+
+MAC_ADDRESS_LENGTH = 6
+MAX_ALLOWLIST_SIZE = 0xFFFF
+# APPLICATION_LENGTH in include/nrf_symbols.ld: the flash of the whole microapp
+FLASH_SIZE = 0x4000
+# With 2 hashes, about 3% of the other addresses then passes the Bloom filter
+BLOOM_BITS_PER_ADDRESS = 10
+
+parser = argparse.ArgumentParser(description='Generate the MAC allowlist table from a CSV file')
+parser.add_argument('input',
+        help='CSV file with a MAC address "AA:BB:CC:DD:EE:FF" in the first column. Empty lines, lines starting '
+        'with # and a header line are skipped.')
+parser.add_argument('output',
+        help='The source file to write the table to.')
+parser.add_argument('--makefile',
+        help='Makefile to write MAC_ALLOWLIST_BLOOM_BYTES to, the size of the Bloom filter for the table.')
+parser.add_argument('--bloom-max-bytes', type=int, default=256,
+        help='RAM budget of the Bloom filter: its size is at most this, rounded down to a power of 2.')
+
+args = parser.parse_args()
+
+macPattern = re.compile(r'^([0-9A-Fa-f]{2})([:-][0-9A-Fa-f]{2}){5}$')
+
+addresses = set()
+firstLine = True
+with open(args.input, 'r') as csvFile:
+    for lineNumber, line in enumerate(csvFile, 1):
+        line = line.strip()
+        if not line or line.startswith('#'):
+            continue
+        field = line.split(',')[0].strip().strip('"')
+        isHeader = firstLine
+        firstLine = False
+        if not macPattern.match(field):
+            if isHeader:
+                continue
+            sys.exit(f'{args.input}:{lineNumber}: invalid MAC address "{field}"')
+        # Bluenet stores the address reversed
+        addresses.add(bytes(reversed(bytes.fromhex(field.replace(':', '').replace('-', '')))))
+
+if len(addresses) > MAX_ALLOWLIST_SIZE:
+    sys.exit(f'{args.input}: {len(addresses)} addresses, at most {MAX_ALLOWLIST_SIZE} are supported')
+# The code needs flash too, so the linker may still fail on a smaller table
+if len(addresses) * MAC_ADDRESS_LENGTH > FLASH_SIZE:
+    sys.exit(f'{args.input}: {len(addresses)} addresses take {len(addresses) * MAC_ADDRESS_LENGTH} bytes, '
+            f'more than the {FLASH_SIZE} bytes of flash of a microapp')
+
+# Sorted by memcmp(), for the binary search
+table = sorted(addresses)
+
+with open(args.output, 'w') as outputFile:
+    outputFile.write(f'/* Auto-generated file from {args.input}, by {sys.argv[0]} */\n')
+    outputFile.write('#include <BleMacAllowlist.h>\n\n')
+    outputFile.write(f'const uint16_t macAllowlistSize = {len(table)};\n\n')
+    # At least one entry, an empty array is not allowed
+    outputFile.write(f'const uint8_t macAllowlist[{max(len(table), 1)}][MAC_ADDRESS_LENGTH] = {{\n')
+    for address in table:
+        outputFile.write('\t\t{' + ', '.join(f'0x{b:02X}' for b in address) + '},\n')
+    outputFile.write('};\n')
+
+print(f'Wrote {len(table)} addresses to {args.output}')
+
+if args.makefile:
+    # A power of 2, with at least BLOOM_BITS_PER_ADDRESS bits per address, within the RAM budget
+    bloomBytes = 1
+    while bloomBytes * 8 < len(table) * BLOOM_BITS_PER_ADDRESS and bloomBytes * 2 <= args.bloom_max_bytes:
+        bloomBytes *= 2
+    if bloomBytes * 8 < len(table) * BLOOM_BITS_PER_ADDRESS:
+        print(f'Warning: the Bloom filter of {bloomBytes} bytes has less than {BLOOM_BITS_PER_ADDRESS} bits per '
+                f'address, so more of the other addresses pass it')
+    with open(args.makefile, 'w') as makeFile:
+        makeFile.write(f'# Auto-generated file from {args.input}, by {sys.argv[0]}\n')
+        makeFile.write(f'MAC_ALLOWLIST_BLOOM_BYTES={bloomBytes}\n')
+    print(f'Wrote Bloom filter size of {bloomBytes} bytes to {args.makefile}')
@@ -99,6 +99,11 @@ int digitalRead(uint8_t pin) {
 	return value;
 }
 
+/*
+ * Pin interrupts, the id is the interrupt index.
+ */
+DEFINE_INTERRUPT_TABLE(pinInterruptTable, microapp_sdk_pin_t, pin, NUMBER_OF_PINS)
+
 /**
  * The mode here is LOW, CHANGE, RISING, FALLING, HIGH.
  *
@@ -111,9 +116,10 @@ bool attachInterrupt(uint8_t interruptIndex, void (*isr)(void), uint8_t mode) {
 	}
 
 	interrupt_registration_t interrupt;
-	interrupt.type          = CS_MICROAPP_SDK_TYPE_PIN;
-	interrupt.id          = interruptIndex;
-	interrupt.handler        = reinterpret_cast<interruptFunction>(isr);
+	interrupt.type               = CS_MICROAPP_SDK_TYPE_PIN;
+	interrupt.id                 = interruptIndex;
+	interrupt.handler            = reinterpret_cast<interruptFunction>(isr);
+	interrupt.table              = &pinInterruptTable;
 	microapp_sdk_result_t result = registerInterrupt(&interrupt);
 	if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
 		return false;
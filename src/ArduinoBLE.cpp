@@ -1,5 +1,12 @@
 #include <Arduino.h>
 #include <ArduinoBLE.h>
+#include <Message.h>
+#include <Profiler.h>
+
+/*
+ * BLE interrupts, the id is the BLE type.
+ */
+DEFINE_INTERRUPT_TABLE(bleInterruptTable, microapp_sdk_ble_t, type, CS_MICROAPP_SDK_BLE_PERIPHERAL + 1)
 
 /*
  * An ordinary C function. Calls internal handler
@@ -40,20 +47,25 @@ microapp_sdk_result_t Ble::handleScanEvent(microapp_sdk_ble_scan_t* scanInterrup
 	// for scan type, only interrupt type is EVENT_SCAN for now
 	switch (scanInterrupt->type) {
 		case CS_MICROAPP_SDK_BLE_SCAN_EVENT_SCAN: {
+			_scanStats.received();
 			if (!_flags.isScanning) {
+				_scanStats.filtered();
 				return CS_MICROAPP_SDK_ACK_SUCCESS;
 			}
-
-			// Copy the scan data into the _scanDevice
-			MacAddress address(scanInterrupt->eventScan.address.address, MAC_ADDRESS_LENGTH, scanInterrupt->eventScan.address.type);
-			rssi_t rssi = scanInterrupt->eventScan.rssi;
-			_scanDevice = BleDevice(scanInterrupt->eventScan.data, scanInterrupt->eventScan.size, address, rssi);
-
-			// Call the event handler, if any.
-			auto handler = (DeviceEventHandler*)getBleEventHandler(BLEDeviceScanned);
-			if (handler != nullptr) {
-				(*handler)(_scanDevice);
+#ifdef MICROAPP_MAC_ALLOWLIST
+			if (_allowlist.enabled() && !_allowlist.contains(scanInterrupt->eventScan.address.address)) {
+				_scanStats.filtered();
+				return CS_MICROAPP_SDK_ACK_SUCCESS;
+			}
+#endif
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+			if (_flags.mergeScanResponses) {
+				// The merger passes the scan on to handleScan() when it is done
+				_scanMerger.add(scanInterrupt->eventScan, handleMergedScan);
+				return CS_MICROAPP_SDK_ACK_SUCCESS;
 			}
+#endif
+			handleScan(scanInterrupt->eventScan);
 
 			return CS_MICROAPP_SDK_ACK_SUCCESS;
 		}
@@ -63,6 +75,111 @@ microapp_sdk_result_t Ble::handleScanEvent(microapp_sdk_ble_scan_t* scanInterrup
 	}
 }
 
+void Ble::handleScan(const microapp_sdk_ble_scan_event_t& scan) {
+	if (!_scanFilter.matches(scan)) {
+		_scanStats.filtered();
+		return;
+	}
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	if (_flags.trackDevices) {
+		// Track before dropping duplicates, so that every advertisement counts for the RSSI
+		TrackerEventHandler trackerHandler = trackerEventHandler();
+		_deviceTracker.age(trackerHandler);
+		_deviceTracker.update(scan, trackerHandler);
+	}
+#endif
+#ifdef MICROAPP_BLE_DUPLICATE_FILTER
+	if (!_flags.withDuplicates && _duplicateFilter.isDuplicate(scan)) {
+		_scanStats.deduplicated();
+		return;
+	}
+#endif
+	_scanStats.delivered();
+#ifdef MICROAPP_PROFILING
+	uint32_t start = profilerTicks();
+#endif
+
+	// Pass a view on the scan to the event handler, if any.
+	auto viewHandler = (ScanViewEventHandler*)getBleEventHandler(BLEDeviceScannedView);
+	if (viewHandler != nullptr) {
+		BleScanView view(scan);
+		(*viewHandler)(view);
+	}
+
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	// Queue the scan until it is polled via available(), if the app polls scans at all
+	bool keepScanDevice = false;
+	if (_flags.pollsScans) {
+		_scanQueue.push(scan);
+	}
+#else
+	// Without the queue, available() returns the last scan
+	bool keepScanDevice = true;
+#endif
+
+	// Call the event handler, if any.
+	auto handler = (DeviceEventHandler*)getBleEventHandler(BLEDeviceScanned);
+	if (handler != nullptr || keepScanDevice) {
+		// Copy the scan data into the _scanDevice
+		MacAddress address(scan.address.address, MAC_ADDRESS_LENGTH, scan.address.type);
+		rssi_t rssi = scan.rssi;
+		_scanDevice = BleDevice(const_cast<uint8_t*>(scan.data), scan.size, address, rssi);
+	}
+	if (handler != nullptr) {
+		(*handler)(_scanDevice);
+	}
+#ifdef MICROAPP_PROFILING
+	_scanStats.recordHandler(start);
+#endif
+}
+
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+void Ble::handleMergedScan(const microapp_sdk_ble_scan_event_t& scan) {
+	BLE.handleScan(scan);
+}
+#endif
+
+void Ble::handleScanTick() {
+	Ble& ble = BLE;
+	if (!ble._flags.isScanning) {
+		return;
+	}
+	// Scans dropped from the queue of available() are left out, as they do not mean the interrupts are too many
+	ble_scan_stats_t stats = ble.scanStats();
+	uint32_t dropped       = stats.busyDropped + stats.deferDropped;
+	bool scan              = ble._scanScheduler.tick(stats.received, dropped);
+	if (scan != ble._flags.scanPaused) {
+		// Bluenet is already in the right state
+		return;
+	}
+	if (ble.requestScan(scan ? CS_MICROAPP_SDK_BLE_SCAN_REQUEST_START : CS_MICROAPP_SDK_BLE_SCAN_REQUEST_STOP)) {
+		ble._flags.scanPaused = !scan;
+	}
+}
+
+/*
+ * Returns the BleCharacteristicProperties of a discovered characteristic.
+ */
+static uint8_t discoveredProperties(microapp_sdk_ble_central_t* central) {
+	uint8_t properties = 0;
+	if (central->eventDiscover.options.read) {
+		properties |= BleCharacteristicProperties::BLERead;
+	}
+	if (central->eventDiscover.options.writeNoResponse) {
+		properties |= BleCharacteristicProperties::BLEWriteWithoutResponse;
+	}
+	if (central->eventDiscover.options.write) {
+		properties |= BleCharacteristicProperties::BLEWrite;
+	}
+	if (central->eventDiscover.options.notify) {
+		properties |= BleCharacteristicProperties::BLENotify;
+	}
+	if (central->eventDiscover.options.indicate) {
+		properties |= BleCharacteristicProperties::BLEIndicate;
+	}
+	return properties;
+}
+
 microapp_sdk_result_t Ble::handleCentralEvent(microapp_sdk_ble_central_t* central) {
 	if (!_peripheral || !_peripheral._flags.isPeripheral) {
 		// First scan for a peripheral device
@@ -73,9 +190,13 @@ microapp_sdk_result_t Ble::handleCentralEvent(microapp_sdk_ble_central_t* centra
 	switch (central->type) {
 		case CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_CONNECT: {
 			if (central->eventConnect.result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-				_peripheral._asyncResult = BleAsyncFailure;
+				_peripheral._async.complete((microapp_sdk_result_t)central->eventConnect.result);
 				return CS_MICROAPP_SDK_ACK_SUCCESS;
 			}
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+			_attributePool.clear();
+			_peripheral._attributes = &_attributePool;
+#endif
 			_peripheral.onConnect(central->connectionHandle);
 
 			// Call the event handler, if any.
@@ -90,6 +211,9 @@ microapp_sdk_result_t Ble::handleCentralEvent(microapp_sdk_ble_central_t* centra
 			// clean up own member variables as well
 			_remoteServiceCount = 0;
 			_remoteCharacteristicCount = 0;
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+			_attributePool.clear();
+#endif
 
 			// Call the event handler, if any.
 			auto handler = (DeviceEventHandler*)getBleEventHandler(BLEDisconnected);
@@ -99,59 +223,33 @@ microapp_sdk_result_t Ble::handleCentralEvent(microapp_sdk_ble_central_t* centra
 			return CS_MICROAPP_SDK_ACK_SUCCESS;
 		}
 		case CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_DISCOVER: {
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+			// Every attribute goes into the pool, only the first services can be used to read, write and subscribe
+			microapp_sdk_result_t pooled;
 			if (central->eventDiscover.valueHandle == 0) {
-				// discovered a service
-				if (_remoteServiceCount >= MAX_REMOTE_SERVICES) {
-					return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
-				}
-				BleService service(&central->eventDiscover.uuid);
-				_remoteServices[_remoteServiceCount] = service;
-				// add to device
-				result = _peripheral.addDiscoveredService(&_remoteServices[_remoteServiceCount]);
-				if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-					return result;
-				}
-				_remoteServiceCount++;
+				pooled = _attributePool.addService(central->eventDiscover.uuid);
 			}
 			else {
-				// discovered a characteristic
-				if (_remoteCharacteristicCount >= MAX_REMOTE_CHARACTERISTICS) {
-					return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
-				}
-				uint8_t properties = 0;
-				if (central->eventDiscover.options.read) {
-					properties |= BleCharacteristicProperties::BLERead;
-				}
-				if (central->eventDiscover.options.writeNoResponse) {
-					properties |= BleCharacteristicProperties::BLEWriteWithoutResponse;
-				}
-				if (central->eventDiscover.options.write) {
-					properties |= BleCharacteristicProperties::BLEWrite;
-				}
-				if (central->eventDiscover.options.notify) {
-					properties |= BleCharacteristicProperties::BLENotify;
-				}
-				if (central->eventDiscover.options.indicate) {
-					properties |= BleCharacteristicProperties::BLEIndicate;
-				}
-				BleCharacteristic characteristic(&central->eventDiscover.uuid, properties);
-				characteristic._valueHandle = central->eventDiscover.valueHandle;
-				characteristic._cccdHandle = central->eventDiscover.cccdHandle;
-				_remoteCharacteristics[_remoteCharacteristicCount] = characteristic;
-				// add to device
-				Uuid serviceUuid(central->eventDiscover.serviceUuid.uuid, central->eventDiscover.serviceUuid.type);
-				result = _peripheral.addDiscoveredCharacteristic(
-						&_remoteCharacteristics[_remoteCharacteristicCount], serviceUuid);
-				if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-					return result;
-				}
-				_remoteCharacteristicCount++;
+				pooled = _attributePool.addCharacteristic(
+						central->eventDiscover.serviceUuid,
+						central->eventDiscover.uuid,
+						discoveredProperties(central),
+						central->eventDiscover.valueHandle,
+						central->eventDiscover.cccdHandle);
 			}
-			return CS_MICROAPP_SDK_ACK_SUCCESS;
+			result = addDiscoveredAttribute(central);
+			if (pooled == CS_MICROAPP_SDK_ACK_SUCCESS) {
+				// Keep discovering, also when the services are full
+				return CS_MICROAPP_SDK_ACK_SUCCESS;
+			}
+			return result;
+#else
+			return addDiscoveredAttribute(central);
+#endif
 		}
 		case CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_DISCOVER_DONE: {
 			if (central->eventDiscoverDone.result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-				_peripheral._asyncResult = BleAsyncFailure;
+				_peripheral._async.complete((microapp_sdk_result_t)central->eventDiscoverDone.result);
 				return CS_MICROAPP_SDK_ACK_SUCCESS;
 			}
 			_peripheral.onDiscoverDone();
@@ -165,11 +263,11 @@ microapp_sdk_result_t Ble::handleCentralEvent(microapp_sdk_ble_central_t* centra
 			}
 			result = (microapp_sdk_result_t)central->eventWrite.result;
 			if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-				// set async result
-				characteristic->_asyncResult = BleAsyncFailure;
+				// complete the request with failure
+				characteristic->_async.complete(result);
 				return result;
 			}
-			// set async result so blocking function may return
+			// complete the request, so that a waiting function may return
 			result = characteristic->onRemoteWritten();
 			return result;
 		}
@@ -181,7 +279,7 @@ microapp_sdk_result_t Ble::handleCentralEvent(microapp_sdk_ble_central_t* centra
 			}
 			result = (microapp_sdk_result_t)central->eventRead.result;
 			if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-				characteristic->_asyncResult = BleAsyncFailure;
+				characteristic->_async.complete(result);
 				return result;
 			}
 			result = characteristic->onRemoteRead(&central->eventRead);
@@ -211,6 +309,43 @@ microapp_sdk_result_t Ble::handleCentralEvent(microapp_sdk_ble_central_t* centra
 	}
 }
 
+microapp_sdk_result_t Ble::addDiscoveredAttribute(microapp_sdk_ble_central_t* central) {
+	microapp_sdk_result_t result;
+	if (central->eventDiscover.valueHandle == 0) {
+		// discovered a service
+		if (_remoteServiceCount >= MAX_REMOTE_SERVICES) {
+			return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+		}
+		BleService service(&central->eventDiscover.uuid);
+		_remoteServices[_remoteServiceCount] = service;
+		// add to device
+		result = _peripheral.addDiscoveredService(&_remoteServices[_remoteServiceCount]);
+		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
+			return result;
+		}
+		_remoteServiceCount++;
+	}
+	else {
+		// discovered a characteristic
+		if (_remoteCharacteristicCount >= MAX_REMOTE_CHARACTERISTICS) {
+			return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+		}
+		BleCharacteristic characteristic(&central->eventDiscover.uuid, discoveredProperties(central));
+		characteristic._valueHandle = central->eventDiscover.valueHandle;
+		characteristic._cccdHandle = central->eventDiscover.cccdHandle;
+		_remoteCharacteristics[_remoteCharacteristicCount] = characteristic;
+		// add to device
+		Uuid serviceUuid(central->eventDiscover.serviceUuid.uuid, central->eventDiscover.serviceUuid.type);
+		result = _peripheral.addDiscoveredCharacteristic(
+				&_remoteCharacteristics[_remoteCharacteristicCount], serviceUuid);
+		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
+			return result;
+		}
+		_remoteCharacteristicCount++;
+	}
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
 microapp_sdk_result_t Ble::handlePeripheralEvent(microapp_sdk_ble_peripheral_t* peripheral) {
 	microapp_sdk_result_t result;
 	switch (peripheral->type) {
@@ -346,10 +481,39 @@ bool Ble::begin() {
 void Ble::end() {
 	_address = MacAddress();
 	_scanDevice = BleDevice();
-	_peripheral = BleDevice();
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	_scanQueue.clear();
+#endif
+	_scanFilter = BleScanFilter();
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	_deviceTracker.clear();
+#endif
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	_scanMerger.clear();
+#endif
+	_scanScheduler.clear();
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+	_attributePool.clear();
+#endif
+#ifdef MICROAPP_MAC_ALLOWLIST
+	_allowlist.clear();
+#endif
+	if (_peripheral._async._state == BleAsyncWaiting) {
+		// The event of the request will not come anymore
+		_peripheral._async.complete(CS_MICROAPP_SDK_ACK_ERR_DISABLED);
+	}
+	replacePeripheral(BleDevice());
 	_central = BleDevice();
 	_flags.initialized = false;
 	_flags.isScanning = false;
+	_flags.pollsScans = false;
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	_flags.trackDevices = false;
+#endif
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	_flags.mergeScanResponses = false;
+#endif
+	_flags.scanPaused = false;
 	_flags.registeredCentralInterrupts = false;
 	_flags.registeredPeripheralInterrupts = false;
 	_flags.registeredScanInterrupts = false;
@@ -360,6 +524,20 @@ void Ble::poll(int timeout) {
 	if (!_flags.initialized) {
 		return;
 	}
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+	if (_flags.trackDevices) {
+		_deviceTracker.age(trackerEventHandler());
+	}
+#endif
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	if (_flags.mergeScanResponses) {
+		_scanMerger.flush(handleMergedScan);
+	}
+#endif
+	if (_scanStatsIntervalTicks != 0 && tickCount() - _scanStatsDumpTick >= _scanStatsIntervalTicks) {
+		_scanStatsDumpTick = tickCount();
+		dumpScanStats();
+	}
 	if (timeout == 0) {
 		return;
 	}
@@ -417,6 +595,50 @@ bool Ble::setEventHandler(BleEventType eventType, DeviceEventHandler eventHandle
 	}
 }
 
+bool Ble::setEventHandler(BleEventType eventType, ScanViewEventHandler eventHandler) {
+	if (eventType != BLEDeviceScannedView) {
+		return false;
+	}
+	microapp_sdk_result_t result = registerBleEventHandler(eventType, (BleEventHandler)eventHandler);
+	if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
+		return false;
+	}
+	if (!registeredBleInterrupt(CS_MICROAPP_SDK_BLE_SCAN)) {
+		result = registerBleInterrupt(CS_MICROAPP_SDK_BLE_SCAN);
+		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
+			removeBleEventHandlerRegistration(eventType);
+			return false;
+		}
+	}
+	return true;
+}
+
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+bool Ble::setEventHandler(BleEventType eventType, TrackerEventHandler eventHandler) {
+	if (eventType != BLEDevicePresence) {
+		return false;
+	}
+	microapp_sdk_result_t result = registerBleEventHandler(eventType, (BleEventHandler)eventHandler);
+	if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
+		return false;
+	}
+	if (!registeredBleInterrupt(CS_MICROAPP_SDK_BLE_SCAN)) {
+		result = registerBleInterrupt(CS_MICROAPP_SDK_BLE_SCAN);
+		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
+			removeBleEventHandlerRegistration(eventType);
+			return false;
+		}
+	}
+	_flags.trackDevices = true;
+	return true;
+}
+
+TrackerEventHandler Ble::trackerEventHandler() {
+	auto handler = (TrackerEventHandler*)getBleEventHandler(BLEDevicePresence);
+	return (handler != nullptr) ? *handler : nullptr;
+}
+#endif
+
 bool Ble::connected() {
 	if (!_flags.initialized) {
 		return false;
@@ -503,8 +725,18 @@ bool Ble::scan(bool withDuplicates) {
 	if (!_flags.initialized) {
 		return false;
 	}
-	// Reset existing _scanDevice
+	// Reset existing _scanDevice, queued scans and scanned devices
 	_scanDevice = BleDevice();
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	_scanQueue.clear();
+#endif
+#ifdef MICROAPP_BLE_DUPLICATE_FILTER
+	_duplicateFilter.clear();
+#endif
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	_scanMerger.clear();
+#endif
+	_flags.withDuplicates = withDuplicates;
 	if (_flags.isScanning) {
 		return true;
 	}
@@ -516,23 +748,37 @@ bool Ble::scan(bool withDuplicates) {
 		}
 	}
 
+	if (!requestScan(CS_MICROAPP_SDK_BLE_SCAN_REQUEST_START)) {
+		return false;
+	}
+	_flags.isScanning = true;
+	_flags.scanPaused = false;
+	return true;
+}
+
+bool Ble::requestScan(uint8_t type) {
 	uint8_t* payload               = getOutgoingMessagePayload();
 	microapp_sdk_ble_t* bleRequest = (microapp_sdk_ble_t*)(payload);
 	bleRequest->header.messageType = CS_MICROAPP_SDK_TYPE_BLE;
 	bleRequest->header.ack         = CS_MICROAPP_SDK_ACK_REQUEST;
 	bleRequest->type               = CS_MICROAPP_SDK_BLE_SCAN;
-	bleRequest->scan.type          = CS_MICROAPP_SDK_BLE_SCAN_REQUEST_START;
+	bleRequest->scan.type          = type;
 
 	sendMessage();
 
-	bool success = (bleRequest->header.ack == CS_MICROAPP_SDK_ACK_SUCCESS);
-	if (!success) {
-		return false;
-	}
-	_flags.isScanning = true;
-	return true;
+	return (bleRequest->header.ack == CS_MICROAPP_SDK_ACK_SUCCESS);
 }
 
+#ifdef MICROAPP_BLE_DUPLICATE_FILTER
+void Ble::setDuplicateFilter(uint16_t ttlTicks, bool compareData) {
+	_duplicateFilter.configure(ttlTicks, compareData);
+}
+
+uint16_t Ble::duplicateScanCount() {
+	return _duplicateFilter.duplicateCount();
+}
+#endif
+
 microapp_sdk_result_t Ble::setScanFilter(microapp_sdk_ble_scan_filter_t& scanFilter) {
 	microapp_sdk_ble_t* request = (microapp_sdk_ble_t*)getOutgoingMessagePayload();
 	request->header.messageType = CS_MICROAPP_SDK_TYPE_BLE;
@@ -548,6 +794,8 @@ bool Ble::scanForName(const char* name, bool withDuplicates) {
 	if (!_flags.initialized) {
 		return false;
 	}
+	// Bluenet filters on its own
+	_scanFilter = BleScanFilter();
 
 	microapp_sdk_ble_scan_filter_t scanFilter;
 	scanFilter.type = CS_MICROAPP_SDK_BLE_SCAN_FILTER_NAME;
@@ -570,6 +818,8 @@ bool Ble::scanForAddress(const char* address, bool withDuplicates) {
 	if (!_flags.initialized) {
 		return false;
 	}
+	// Bluenet filters on its own
+	_scanFilter = BleScanFilter();
 
 	microapp_sdk_ble_scan_filter_t scanFilter;
 	scanFilter.type = CS_MICROAPP_SDK_BLE_SCAN_FILTER_MAC;
@@ -599,6 +849,8 @@ bool Ble::scanForUuid(const char* uuidString, bool withDuplicates) {
 	if (uuid.custom()) {
 		return false;
 	}
+	// Bluenet filters on its own
+	_scanFilter = BleScanFilter();
 
 	microapp_sdk_ble_scan_filter_t scanFilter;
 	scanFilter.type = CS_MICROAPP_SDK_BLE_SCAN_FILTER_SERVICE_16_BIT;
@@ -611,6 +863,22 @@ bool Ble::scanForUuid(const char* uuidString, bool withDuplicates) {
 	return scan(withDuplicates);
 }
 
+bool Ble::scanWithFilter(const BleScanFilter& filter, bool withDuplicates) {
+	if (!_flags.initialized || !filter.valid()) {
+		return false;
+	}
+
+	// Let bluenet filter on the most selective criterion it supports, the complete filter is evaluated on each scan
+	microapp_sdk_ble_scan_filter_t scanFilter;
+	filter.bluenetFilter(scanFilter);
+	if (setScanFilter(scanFilter) != CS_MICROAPP_SDK_ACK_SUCCESS) {
+		return false;
+	}
+	_scanFilter = filter;
+
+	return scan(withDuplicates);
+}
+
 bool Ble::stopScan() {
 	if (!_flags.initialized) {
 		return false;
@@ -618,43 +886,180 @@ bool Ble::stopScan() {
 	if (!_flags.isScanning) {  // already not scanning
 		return true;
 	}
-	// Reset existing _scanDevice
+	// Reset existing _scanDevice, queued scans and scans waiting for their scan response
 	_scanDevice = BleDevice();
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	_scanQueue.clear();
+#endif
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	_scanMerger.clear();
+#endif
 
 	// send a message to bluenet asking it to stop forwarding ads to microapp
-	uint8_t* payload               = getOutgoingMessagePayload();
-	microapp_sdk_ble_t* bleRequest = (microapp_sdk_ble_t*)(payload);
-
-	bleRequest->header.ack         = CS_MICROAPP_SDK_ACK_REQUEST;
-	bleRequest->header.messageType = CS_MICROAPP_SDK_TYPE_BLE;
-	bleRequest->type               = CS_MICROAPP_SDK_BLE_SCAN;
-	bleRequest->scan.type          = CS_MICROAPP_SDK_BLE_SCAN_REQUEST_STOP;
-
-	sendMessage();
-
-	bool success = (bleRequest->header.ack == CS_MICROAPP_SDK_ACK_SUCCESS);
-	if (!success) {
+	if (!requestScan(CS_MICROAPP_SDK_BLE_SCAN_REQUEST_STOP)) {
 		return false;
 	}
 
 	_flags.isScanning = false;
+	_flags.scanPaused = false;
 	return true;
 }
 
 BleDevice& Ble::available() {
+	// From now on, keep scans until they are polled
+	_flags.pollsScans = true;
+	if (_peripheral._async._state == BleAsyncWaiting) {
+		// Leave the scans, they are returned once the request to the peripheral completes
+		return replacePeripheral(BleDevice());
+	}
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	ble_scan_record_t record;
+	if (!_flags.initialized || !_flags.isScanning || !_scanQueue.pop(record)) {
+		// Reset peripheral device
+		return replacePeripheral(BleDevice());
+	}
+	// Set main (persistent) device as the oldest scanned device
+	MacAddress address(record.address, MAC_ADDRESS_LENGTH, record.addressType);
+	replacePeripheral(BleDevice(record.data, record.size, address, record.rssi));
+#else
 	if (!_flags.initialized || !_flags.isScanning ||
 		!_scanDevice || !_scanDevice._flags.isPeripheral) {
 		// Reset peripheral device
-		_peripheral = BleDevice();
-		return _peripheral;
+		return replacePeripheral(BleDevice());
 	}
 	// Set main (persistent) device as the latest scanned device
-	_peripheral = _scanDevice;
+	replacePeripheral(_scanDevice);
 	// Reset scan device
 	_scanDevice = BleDevice();
+#endif
 	return _peripheral;
 }
 
+BleDevice& Ble::setPeripheral(const microapp_sdk_ble_scan_event_t& scan) {
+	MacAddress address(scan.address.address, MAC_ADDRESS_LENGTH, scan.address.type);
+	return replacePeripheral(BleDevice(const_cast<uint8_t*>(scan.data), scan.size, address, scan.rssi));
+}
+
+BleDevice& Ble::replacePeripheral(const BleDevice& device) {
+	if (_peripheral._async._state == BleAsyncWaiting) {
+		static BleDevice noDevice;
+		noDevice = BleDevice();
+		return noDevice;
+	}
+	// Keep the state of the last request, so that its future keeps its result and sequence numbers are not reused
+	BleAsyncOperation async = _peripheral._async;
+	_peripheral = device;
+	_peripheral._async = async;
+	return _peripheral;
+}
+
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+void Ble::setScanOverflowPolicy(BleScanOverflowPolicy policy) {
+	_scanQueue.setOverflowPolicy(policy);
+}
+
+uint8_t Ble::scanQueueSize() {
+	return _scanQueue.size();
+}
+
+uint16_t Ble::droppedScanCount() {
+	return _scanQueue.droppedCount();
+}
+#endif
+
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+void Ble::trackDevices(BleRssiFilterType filter, rssi_t enterRssi, rssi_t leaveRssi, uint16_t timeoutTicks) {
+	_deviceTracker.configure(filter, enterRssi, leaveRssi, timeoutTicks);
+	_flags.trackDevices = true;
+}
+#endif
+
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+void Ble::mergeScanResponses(bool merge, uint16_t windowTicks) {
+	if (!merge && _flags.mergeScanResponses) {
+		// Pass on the waiting scans, as the window will not be checked anymore
+		_flags.mergeScanResponses = false;
+		_scanMerger.flush(handleMergedScan, true);
+	}
+	_scanMerger.configure(windowTicks);
+	_flags.mergeScanResponses = merge;
+}
+#endif
+
+void Ble::setScanDutyCycle(uint16_t windowMs, uint16_t intervalMs, uint16_t maxScansPerSecond) {
+	uint16_t windowTicks   = (windowMs + MICROAPP_LOOP_INTERVAL_MS - 1) / MICROAPP_LOOP_INTERVAL_MS;
+	uint16_t intervalTicks = (intervalMs + MICROAPP_LOOP_INTERVAL_MS - 1) / MICROAPP_LOOP_INTERVAL_MS;
+	_scanScheduler.configure(windowTicks, intervalTicks, maxScansPerSecond);
+	// Scanning resumes on the next tick, when the schedule is removed while bluenet is stopped
+	setInternalTickHandler(handleScanTick);
+}
+
+void Ble::setScanBudget(uint16_t maxScansPerSecond) {
+	uint16_t intervalTicks = (maxScansPerSecond == 0) ? 0 : SCAN_BUDGET_INTERVAL_TICKS;
+	_scanScheduler.configure(intervalTicks, intervalTicks, maxScansPerSecond);
+	setInternalTickHandler(handleScanTick);
+}
+
+uint16_t Ble::scanWindowMs() {
+	if (!_scanScheduler.enabled()) {
+		return 0;
+	}
+	return _scanScheduler.windowTicks() * MICROAPP_LOOP_INTERVAL_MS;
+}
+
+ble_scan_stats_t Ble::scanStats() {
+	ble_scan_stats_t stats;
+	_scanStats.get(stats);
+#ifdef MICROAPP_BLE_MERGE_SCAN_RESPONSES
+	stats.merged       = _scanMerger.mergedCount();
+#else
+	stats.merged       = 0;
+#endif
+#ifdef MICROAPP_BLE_SCAN_QUEUE
+	stats.queueDropped = _scanQueue.droppedCount();
+#else
+	stats.queueDropped = 0;
+#endif
+	stats.busyDropped  = busyInterruptCount(CS_MICROAPP_SDK_TYPE_BLE);
+	stats.deferDropped = droppedInterruptCount(CS_MICROAPP_SDK_TYPE_BLE);
+	return stats;
+}
+
+bool Ble::dumpScanStats() {
+	ble_scan_stats_t stats = scanStats();
+	return Message.write(&stats, sizeof(stats)) == sizeof(stats);
+}
+
+void Ble::setScanStatsInterval(uint16_t intervalTicks) {
+	_scanStatsIntervalTicks = intervalTicks;
+	_scanStatsDumpTick      = tickCount();
+}
+
+#ifdef MICROAPP_BLE_DEVICE_TRACKER
+uint8_t Ble::trackedDeviceCount() {
+	_deviceTracker.age(trackerEventHandler());
+	return _deviceTracker.count();
+}
+
+const ble_tracked_device_t* Ble::trackedDevice(uint8_t index) {
+	return _deviceTracker.get(index);
+}
+#endif
+
+#ifdef MICROAPP_MAC_ALLOWLIST
+bool Ble::setAllowlist(const uint8_t (*table)[MAC_ADDRESS_LENGTH], uint16_t size) {
+	if (table == nullptr) {
+		_allowlist.clear();
+		return true;
+	}
+	return _allowlist.set(table, size);
+}
+
+uint16_t Ble::allowlistFalsePositiveCount() {
+	return _allowlist.falsePositiveCount();
+}
+#endif
+
 microapp_sdk_result_t registerBleEventHandler(BleEventType eventType, BleEventHandler eventHandler) {
 	// Check if the type already exists.
 	for (int i = 0; i < BLE.MAX_BLE_EVENT_HANDLER_REGISTRATIONS; ++i) {
@@ -715,6 +1120,7 @@ microapp_sdk_result_t registerBleInterrupt(MicroappSdkBleType bleType) {
 	interrupt.type               = CS_MICROAPP_SDK_TYPE_BLE;
 	interrupt.id                 = bleType;
 	interrupt.handler            = handleBleInterrupt;
+	interrupt.table              = &bleInterruptTable;
 	microapp_sdk_result_t result = registerInterrupt(&interrupt);
 	if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
 		// No empty interrupt slots available on microapp side
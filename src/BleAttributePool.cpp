@@ -0,0 +1,147 @@
+#include <BleAttributePool.h>
+
+static bool equalUuids(const microapp_sdk_ble_uuid_t& a, const microapp_sdk_ble_uuid_t& b) {
+	return a.type == b.type && a.uuid == b.uuid;
+}
+
+uint8_t BleAttributePool::append(
+		const microapp_sdk_ble_uuid_t& uuid, uint8_t properties, uint16_t handle, uint16_t endHandle) {
+	if (_count >= MAX_REMOTE_ATTRIBUTES) {
+		if (_droppedCount < 0xFF) {
+			_droppedCount++;
+		}
+		return BLE_ATTRIBUTE_NOT_FOUND;
+	}
+	ble_attribute_t& attribute = _attributes[_count];
+	attribute.uuid             = uuid;
+	attribute.service          = _count;
+	attribute.properties       = properties;
+	attribute.handle           = handle;
+	attribute.endHandle        = endHandle;
+	return _count++;
+}
+
+microapp_sdk_result_t BleAttributePool::addService(const microapp_sdk_ble_uuid_t& uuid) {
+	if (findService(uuid) != BLE_ATTRIBUTE_NOT_FOUND) {
+		return CS_MICROAPP_SDK_ACK_SUCCESS;
+	}
+	// The handle range is set by the first characteristic
+	if (append(uuid, 0, 0, 0) == BLE_ATTRIBUTE_NOT_FOUND) {
+		return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+	}
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+microapp_sdk_result_t BleAttributePool::addCharacteristic(
+		const microapp_sdk_ble_uuid_t& serviceUuid,
+		const microapp_sdk_ble_uuid_t& uuid,
+		uint8_t properties,
+		uint16_t valueHandle,
+		uint16_t cccdHandle) {
+	uint8_t service = findService(serviceUuid);
+	if (service == BLE_ATTRIBUTE_NOT_FOUND) {
+		service = append(serviceUuid, 0, 0, 0);
+		if (service == BLE_ATTRIBUTE_NOT_FOUND) {
+			return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+		}
+	}
+	uint8_t index = findCharacteristic(service, uuid, valueHandle);
+	if (index != BLE_ATTRIBUTE_NOT_FOUND) {
+		// Discovered before
+		_attributes[index].uuid       = uuid;
+		_attributes[index].properties = properties;
+		_attributes[index].handle     = valueHandle;
+		_attributes[index].endHandle  = cccdHandle;
+	}
+	else {
+		index = append(uuid, properties, valueHandle, cccdHandle);
+		if (index == BLE_ATTRIBUTE_NOT_FOUND) {
+			return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+		}
+		_attributes[index].service = service;
+	}
+
+	// The declaration of a characteristic comes right before its value
+	uint16_t first         = (valueHandle > 1) ? valueHandle - 1 : valueHandle;
+	uint16_t last          = (cccdHandle > valueHandle) ? cccdHandle : valueHandle;
+	ble_attribute_t& range = _attributes[service];
+	if (range.handle == 0 || first < range.handle) {
+		range.handle = first;
+	}
+	if (last > range.endHandle) {
+		range.endHandle = last;
+	}
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+void BleAttributePool::clear() {
+	_count        = 0;
+	_droppedCount = 0;
+}
+
+uint8_t BleAttributePool::count() {
+	return _count;
+}
+
+const ble_attribute_t* BleAttributePool::get(uint8_t index) {
+	if (index >= _count) {
+		return nullptr;
+	}
+	return &_attributes[index];
+}
+
+bool BleAttributePool::isService(uint8_t index) {
+	return index < _count && _attributes[index].service == index;
+}
+
+uint8_t BleAttributePool::findService(const microapp_sdk_ble_uuid_t& uuid) {
+	for (uint8_t i = 0; i < _count; ++i) {
+		if (isService(i) && equalUuids(_attributes[i].uuid, uuid)) {
+			return i;
+		}
+	}
+	return BLE_ATTRIBUTE_NOT_FOUND;
+}
+
+uint8_t BleAttributePool::findService(uint16_t handle) {
+	for (uint8_t i = 0; i < _count; ++i) {
+		if (isService(i) && _attributes[i].handle != 0 && _attributes[i].handle <= handle
+			&& handle <= _attributes[i].endHandle) {
+			return i;
+		}
+	}
+	return BLE_ATTRIBUTE_NOT_FOUND;
+}
+
+uint8_t BleAttributePool::findCharacteristic(uint16_t handle) {
+	if (handle == 0) {
+		return BLE_ATTRIBUTE_NOT_FOUND;
+	}
+	// Only look at the characteristics of the service that holds the handle
+	uint8_t service = findService(handle);
+	if (service == BLE_ATTRIBUTE_NOT_FOUND) {
+		return BLE_ATTRIBUTE_NOT_FOUND;
+	}
+	for (uint8_t i = service + 1; i < _count; ++i) {
+		const ble_attribute_t& attribute = _attributes[i];
+		if (attribute.service == service && (attribute.handle == handle || attribute.endHandle == handle)) {
+			return i;
+		}
+	}
+	return BLE_ATTRIBUTE_NOT_FOUND;
+}
+
+uint8_t BleAttributePool::findCharacteristic(
+		uint8_t service, const microapp_sdk_ble_uuid_t& uuid, uint16_t valueHandle) {
+	for (uint8_t i = service + 1; i < _count; ++i) {
+		const ble_attribute_t& attribute = _attributes[i];
+		if (attribute.service == service && (attribute.handle == valueHandle || equalUuids(attribute.uuid, uuid))) {
+			return i;
+		}
+	}
+	return BLE_ATTRIBUTE_NOT_FOUND;
+}
+
+uint8_t BleAttributePool::droppedCount() {
+	return _droppedCount;
+}
@@ -127,22 +127,22 @@ microapp_sdk_result_t BleCharacteristic::writeValueLocal(uint8_t* buffer, uint16
 }
 
 // Only defined for remote characteristics
-microapp_sdk_result_t BleCharacteristic::writeValueRemote(uint8_t* buffer, uint16_t length, uint32_t timeout) {
+BleFuture BleCharacteristic::writeValueRemote(uint8_t* buffer, uint16_t length) {
 	if (!_flags.initialized) {
-		return CS_MICROAPP_SDK_ACK_ERR_EMPTY;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_EMPTY);
 	}
 	if (!_flags.remote) {
-		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_UNDEFINED);
 	}
 	if (!canWrite()) {
-		return CS_MICROAPP_SDK_ACK_ERR_DISABLED;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_DISABLED);
 	}
 	if (length > MAX_CHARACTERISTIC_VALUE_SIZE) {
 		length = MAX_CHARACTERISTIC_VALUE_SIZE;
 	}
 	// Indicate we are waiting for an async event with a result
 	// This has to be set before the sendMessage call
-	_asyncResult = BleAsyncWaiting;
+	BleFuture future = _async.start();
 
 	microapp_sdk_result_t result;
 	uint8_t* payload                             = getOutgoingMessagePayload();
@@ -158,29 +158,24 @@ microapp_sdk_result_t BleCharacteristic::writeValueRemote(uint8_t* buffer, uint1
 
 	sendMessage();
 	result = (microapp_sdk_result_t)bleRequest->header.ack;
-	if (result == CS_MICROAPP_SDK_ACK_SUCCESS) {
-		// direct success
-		_asyncResult = BleAsyncNotWaiting;
-		return result;
-	}
 	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
-		_asyncResult = BleAsyncNotWaiting;
-		return result;
+		// direct success or failure
+		_async.complete(result);
 	}
-	// Block until write event happens
-	return waitForAsyncResult(timeout);
+	// Otherwise the write event completes the future
+	return future;
 }
 
 // Only defined for remote characteristics
-microapp_sdk_result_t BleCharacteristic::readValueRemote(uint8_t* buffer, uint16_t length, uint32_t timeout) {
+BleFuture BleCharacteristic::readValueRemote(uint8_t* buffer, uint16_t length) {
 	if (!_flags.initialized) {
-		return CS_MICROAPP_SDK_ACK_ERR_EMPTY;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_EMPTY);
 	}
 	if (!_flags.remote) {
-		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_UNDEFINED);
 	}
 	if (!canRead()) {
-		return CS_MICROAPP_SDK_ACK_ERR_DISABLED;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_DISABLED);
 	}
 	if (length > MAX_CHARACTERISTIC_VALUE_SIZE) {
 		length = MAX_CHARACTERISTIC_VALUE_SIZE;
@@ -191,7 +186,7 @@ microapp_sdk_result_t BleCharacteristic::readValueRemote(uint8_t* buffer, uint16
 
 	// Indicate we are waiting for an async event with a result
 	// This has to be set before the sendMessage call
-	_asyncResult = BleAsyncWaiting;
+	BleFuture future = _async.start();
 
 	microapp_sdk_result_t result;
 	uint8_t* payload                            = getOutgoingMessagePayload();
@@ -205,24 +200,19 @@ microapp_sdk_result_t BleCharacteristic::readValueRemote(uint8_t* buffer, uint16
 
 	sendMessage();
 	result = (microapp_sdk_result_t)bleRequest->header.ack;
-	if (result == CS_MICROAPP_SDK_ACK_SUCCESS) {
-		// direct success
-		_asyncResult = BleAsyncNotWaiting;
-		return result;
-	}
 	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
-		_asyncResult = BleAsyncNotWaiting;
-		return result;
+		// direct success or failure
+		_async.complete(result);
 	}
-	// Block until read event happens
-	return waitForAsyncResult(timeout);
+	// Otherwise the read event completes the future
+	return future;
 }
 
 microapp_sdk_result_t BleCharacteristic::onRemoteWritten() {
 	if (!_flags.remote) {
 		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
 	}
-	_asyncResult = BleAsyncSuccess;
+	_async.complete(CS_MICROAPP_SDK_ACK_SUCCESS);
 	return CS_MICROAPP_SDK_ACK_SUCCESS;
 }
 
@@ -238,7 +228,9 @@ microapp_sdk_result_t BleCharacteristic::onRemoteRead(microapp_sdk_ble_central_e
 	// Copy data to value pointer
 	memcpy(_value, eventRead->data, size);
 	_valueLength = size;
-	_asyncResult = BleAsyncSuccess;
+	// Clear valueUpdated flag after set on notify
+	_flags.remoteValueUpdated = false;
+	_async.complete(CS_MICROAPP_SDK_ACK_SUCCESS);
 	return CS_MICROAPP_SDK_ACK_SUCCESS;
 }
 
@@ -282,26 +274,6 @@ microapp_sdk_result_t BleCharacteristic::onLocalNotificationDone() {
 	return CS_MICROAPP_SDK_ACK_SUCCESS;
 }
 
-microapp_sdk_result_t BleCharacteristic::waitForAsyncResult(uint32_t timeout) {
-	// Before calling this function, the asyncResult variable needs
-	// to be set to BleAsyncWaiting. It will even need to be set before
-	// the sendMessage call with the request to bluenet
-	int16_t tries = timeout / MICROAPP_LOOP_INTERVAL_MS;
-	while (_asyncResult == BleAsyncWaiting) {
-		// Yield. Upon an event from bluenet asyncResult will be set
-		delay(MICROAPP_LOOP_INTERVAL_MS);
-		if (--tries <= 0) {
-			return CS_MICROAPP_SDK_ACK_ERR_TIMEOUT;
-		}
-	}
-	if (_asyncResult == BleAsyncFailure) {
-		_asyncResult = BleAsyncNotWaiting;
-		return CS_MICROAPP_SDK_ACK_ERROR;
-	}
-	_asyncResult = BleAsyncNotWaiting;
-	return CS_MICROAPP_SDK_ACK_SUCCESS;
-}
-
 String BleCharacteristic::uuid() {
 	if (!_flags.initialized) {
 		return String(nullptr);
@@ -340,7 +312,7 @@ uint16_t BleCharacteristic::readValue(uint8_t* buffer, uint16_t length) {
 		return length;
 	}
 	else {
-		microapp_sdk_result_t result = readValueRemote(buffer, length);
+		microapp_sdk_result_t result = readValueRemote(buffer, length).wait();
 		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
 			return 0;
 		}
@@ -350,15 +322,33 @@ uint16_t BleCharacteristic::readValue(uint8_t* buffer, uint16_t length) {
 	}
 }
 
+BleFuture BleCharacteristic::readValueAsync(uint8_t* buffer, uint16_t length) {
+	if (!_flags.initialized) {
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_EMPTY);
+	}
+	if (!_flags.remote) {
+		if (_valueLength < length) {
+			length = _valueLength;
+		}
+		memcpy(buffer, _value, length);
+		return BleFuture(CS_MICROAPP_SDK_ACK_SUCCESS);
+	}
+	return readValueRemote(buffer, length);
+}
+
 bool BleCharacteristic::writeValue(uint8_t* buffer, uint16_t length) {
+	return (writeValueAsync(buffer, length).wait() == CS_MICROAPP_SDK_ACK_SUCCESS);
+}
+
+BleFuture BleCharacteristic::writeValueAsync(uint8_t* buffer, uint16_t length) {
 	if (!_flags.initialized) {
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_EMPTY);
 	}
 	if (_flags.remote) {
-		return (writeValueRemote(buffer, length) == CS_MICROAPP_SDK_ACK_SUCCESS);
+		return writeValueRemote(buffer, length);
 	}
 	else {
-		return (writeValueLocal(buffer, length) == CS_MICROAPP_SDK_ACK_SUCCESS);
+		return BleFuture(writeValueLocal(buffer, length));
 	}
 }
 
@@ -451,8 +441,13 @@ bool BleCharacteristic::canSubscribe() {
 
 // Only defined for remote characteristics
 bool BleCharacteristic::subscribe(uint32_t timeout) {
+	return (subscribeAsync().wait(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+}
+
+// Only defined for remote characteristics
+BleFuture BleCharacteristic::subscribeAsync() {
 	if (!_flags.initialized || !_flags.remote) {
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_UNDEFINED);
 	}
 	// Write to _cccdValue: bit 0 for notify, bit 1 for indicate
 	// We only use the first two bits, but BLE specs says the value should be 2 bytes
@@ -465,38 +460,9 @@ bool BleCharacteristic::subscribe(uint32_t timeout) {
 	}
 	else {
 		// Both are not allowed. Subscribing not possible
-		return false;
-	}
-	// Indicate we are waiting for an async event with a result
-	// This has to be set before the sendMessage call
-	_asyncResult = BleAsyncWaiting;
-
-	microapp_sdk_result_t result;
-	uint8_t* payload                     = getOutgoingMessagePayload();
-	microapp_sdk_ble_t* bleRequest       = (microapp_sdk_ble_t*)(payload);
-	bleRequest->header.messageType       = CS_MICROAPP_SDK_TYPE_BLE;
-	bleRequest->header.ack               = CS_MICROAPP_SDK_ACK_REQUEST;
-	bleRequest->type                     = CS_MICROAPP_SDK_BLE_CENTRAL;
-	bleRequest->central.type             = CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_WRITE;
-	bleRequest->central.requestWrite.handle = _cccdHandle;
-	bleRequest->central.requestWrite.buffer = reinterpret_cast<uint8_t*>(&_cccdValue);
-	bleRequest->central.requestWrite.size = 2;
-	bleRequest->central.connectionHandle = BLE_CONNECTION_HANDLE_PLACEHOLDER;
-
-	sendMessage();
-	result = (microapp_sdk_result_t)bleRequest->header.ack;
-		result = (microapp_sdk_result_t)bleRequest->header.ack;
-	if (result == CS_MICROAPP_SDK_ACK_SUCCESS) {
-		// direct success
-		_asyncResult = BleAsyncNotWaiting;
-		return true;
-	}
-	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
-		_asyncResult = BleAsyncNotWaiting;
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_DISABLED);
 	}
-	// Block until write event happens
-	return (waitForAsyncResult(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+	return writeCccd();
 }
 
 bool BleCharacteristic::canUnsubscribe() {
@@ -509,43 +475,48 @@ bool BleCharacteristic::canUnsubscribe() {
 
 // Only defined for remote characteristics
 bool BleCharacteristic::unsubscribe(uint32_t timeout) {
+	return (unsubscribeAsync().wait(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+}
+
+// Only defined for remote characteristics
+BleFuture BleCharacteristic::unsubscribeAsync() {
 	if (!_flags.initialized || !_flags.remote) {
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_UNDEFINED);
 	}
 	if (!canUnsubscribe()) {
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_DISABLED);
 	}
 	// Clear the notify and indicate bits both
 	_cccdValue = 0;
+	return writeCccd();
+}
+
+// Only defined for remote characteristics
+BleFuture BleCharacteristic::writeCccd() {
 	// Indicate we are waiting for an async event with a result
 	// This has to be set before the sendMessage call
-	_asyncResult = BleAsyncWaiting;
+	BleFuture future = _async.start();
 
 	microapp_sdk_result_t result;
-	uint8_t* payload                     = getOutgoingMessagePayload();
-	microapp_sdk_ble_t* bleRequest       = (microapp_sdk_ble_t*)(payload);
-	bleRequest->header.messageType       = CS_MICROAPP_SDK_TYPE_BLE;
-	bleRequest->header.ack               = CS_MICROAPP_SDK_ACK_REQUEST;
-	bleRequest->type                     = CS_MICROAPP_SDK_BLE_CENTRAL;
-	bleRequest->central.type             = CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_WRITE;
-	bleRequest->central.connectionHandle = BLE_CONNECTION_HANDLE_PLACEHOLDER;
+	uint8_t* payload                        = getOutgoingMessagePayload();
+	microapp_sdk_ble_t* bleRequest          = (microapp_sdk_ble_t*)(payload);
+	bleRequest->header.messageType          = CS_MICROAPP_SDK_TYPE_BLE;
+	bleRequest->header.ack                  = CS_MICROAPP_SDK_ACK_REQUEST;
+	bleRequest->type                        = CS_MICROAPP_SDK_BLE_CENTRAL;
+	bleRequest->central.type                = CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_WRITE;
+	bleRequest->central.connectionHandle    = BLE_CONNECTION_HANDLE_PLACEHOLDER;
 	bleRequest->central.requestWrite.handle = _cccdHandle;
 	bleRequest->central.requestWrite.buffer = reinterpret_cast<uint8_t*>(&_cccdValue);
-	bleRequest->central.requestWrite.size = 2;
+	bleRequest->central.requestWrite.size   = 2;
 
 	sendMessage();
 	result = (microapp_sdk_result_t)bleRequest->header.ack;
-	if (result == CS_MICROAPP_SDK_ACK_SUCCESS) {
-		// direct success
-		_asyncResult = BleAsyncNotWaiting;
-		return true;
-	}
 	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
-		_asyncResult = BleAsyncNotWaiting;
-		return false;
+		// direct success or failure
+		_async.complete(result);
 	}
-	// Block until write event happens
-	return (waitForAsyncResult(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+	// Otherwise the write event completes the future
+	return future;
 }
 
 // Only defined for remote characteristics
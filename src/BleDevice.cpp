@@ -1,13 +1,19 @@
 #include <Arduino.h>
 #include <BleDevice.h>
 
+/*
+ * Maximum number of services in a discover request.
+ */
+static const uint8_t MAX_DISCOVER_UUIDS =
+		sizeof(microapp_sdk_ble_central_t::requestDiscover.uuids) / sizeof(microapp_sdk_ble_uuid_t);
+
 // Construct as a peripheral device
 BleDevice::BleDevice(uint8_t* scanData, uint8_t scanSize, MacAddress address, rssi_t rssi) {
 	_scanSize = scanSize;
 	if (_scanSize > sizeof(_scanData)) {
 		_scanSize = sizeof(_scanData);
 	}
-	memcpy(_scanData, scanData, scanSize);
+	memcpy(_scanData, scanData, _scanSize);
 	_address                  = address;
 	_rssi                     = rssi;
 	_flags.isPeripheral = true;
@@ -21,6 +27,13 @@ BleDevice::BleDevice(MacAddress address) {
 	_flags.initialized = true;
 }
 
+const ble_ad_index_t& BleDevice::adIndex() {
+	if (_adIndex.count == AD_INDEX_NOT_BUILT) {
+		BleScan::buildIndex(_scanData, _scanSize, _adIndex);
+	}
+	return _adIndex;
+}
+
 BleDevice::operator bool() const {
 	return _flags.initialized;
 }
@@ -31,7 +44,7 @@ void BleDevice::onConnect(uint16_t connectionHandle) {
 	_connectionHandle = connectionHandle;
 	// set async result flag
 	if (_flags.isPeripheral) {
-		_asyncResult = BleAsyncSuccess;
+		_async.complete(CS_MICROAPP_SDK_ACK_SUCCESS);
 	}
 }
 
@@ -44,7 +57,7 @@ void BleDevice::onDisconnect() {
 	_flags.discoveryDone = false;
 	// set async result flag
 	if (_flags.isPeripheral) {
-		_asyncResult = BleAsyncSuccess;
+		_async.complete(CS_MICROAPP_SDK_ACK_SUCCESS);
 	}
 }
 
@@ -52,7 +65,7 @@ void BleDevice::onDiscoverDone() {
 	_flags.discoveryDone = true;
 	// set async result flag
 	if (_flags.isPeripheral) {
-		_asyncResult = BleAsyncSuccess;
+		_async.complete(CS_MICROAPP_SDK_ACK_SUCCESS);
 	}
 }
 
@@ -93,26 +106,6 @@ microapp_sdk_result_t BleDevice::getCharacteristic(uint16_t handle, BleCharacter
 	return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
 }
 
-bool BleDevice::waitForAsyncResult(uint32_t timeout) {
-	// Before calling this function, the asyncResult variable needs
-	// to be set to BleAsyncWaiting. It will even need to be set before
-	// the sendMessage call with the request to bluenet
-	int16_t tries = timeout / MICROAPP_LOOP_INTERVAL_MS;
-	while (_asyncResult == BleAsyncWaiting) {
-		// Yield. Upon an event from bluenet asyncResult will be set
-		delay(MICROAPP_LOOP_INTERVAL_MS);
-		if (--tries <= 0) {
-			return false;
-		}
-	}
-	if (_asyncResult == BleAsyncFailure) {
-		_asyncResult = BleAsyncNotWaiting;
-		return false;
-	}
-	_asyncResult = BleAsyncNotWaiting;
-	return true;
-}
-
 // Defined for both central and peripheral devices
 void BleDevice::poll(uint32_t timeout) {
 	if (timeout == 0) {
@@ -129,12 +122,17 @@ bool BleDevice::connected() {
 // Defined for both central and peripheral devices
 bool BleDevice::disconnect(uint32_t timeout) {
 	// this is a blocking function
+	return (disconnectAsync().wait(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+}
+
+// Defined for both central and peripheral devices
+BleFuture BleDevice::disconnectAsync() {
 	if (!_flags.connected) {
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND);
 	}
 	// Indicate we are waiting for an async event with a result
 	// This has to be set before the sendMessage call
-	_asyncResult = BleAsyncWaiting;
+	BleFuture future = _async.start();
 
 	uint8_t* payload               = getOutgoingMessagePayload();
 	microapp_sdk_ble_t* bleRequest = (microapp_sdk_ble_t*)(payload);
@@ -152,16 +150,12 @@ bool BleDevice::disconnect(uint32_t timeout) {
 	}
 	sendMessage();
 	microapp_sdk_result_t result = (microapp_sdk_result_t)bleRequest->header.ack;
-	if (result == CS_MICROAPP_SDK_ACK_SUCCESS) {
-		// direct success
-		_asyncResult = BleAsyncNotWaiting;
-		return true;
-	}
 	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
-		_asyncResult = BleAsyncNotWaiting;
-		return false;
+		// direct success or failure
+		_async.complete(result);
 	}
-	return waitForAsyncResult(timeout);
+	// Otherwise the disconnect event completes the future
+	return future;
 }
 
 // Defined for both central and peripheral devices
@@ -175,59 +169,122 @@ int8_t BleDevice::rssi() {
 }
 
 // Only defined for peripheral devices
-bool BleDevice::discoverAttributes() {
-	// Not implemented!
-	// Bluenet requires a set of services to initiate discovery
-	// Hence, discovery is currently only possible via discoverService
-	return false;
+bool BleDevice::discoverAttributes(uint32_t timeout) {
+	return (discoverAttributesAsync().wait(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+}
+
+// Only defined for peripheral devices
+BleFuture BleDevice::discoverAttributesAsync() {
+	if (!_flags.initialized || !_flags.isPeripheral) {
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_UNDEFINED);
+	}
+	if (_flags.discoveryDone) {
+		return BleFuture(CS_MICROAPP_SDK_ACK_SUCCESS);
+	}
+	// Bluenet requires a set of services to initiate discovery, so discover those the device advertises
+	microapp_sdk_ble_uuid_t uuids[MAX_DISCOVER_UUIDS];
+	uint8_t count = advertisedServiceUuidCount(UUID_16BIT_BYTE_LENGTH);
+	if (count == 0) {
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND);
+	}
+	if (count > MAX_DISCOVER_UUIDS) {
+		count = MAX_DISCOVER_UUIDS;
+	}
+	for (uint8_t i = 0; i < count; i++) {
+		const uint8_t* uuid = advertisedServiceUuidBytes(UUID_16BIT_BYTE_LENGTH, i);
+		uuids[i].type       = CS_MICROAPP_SDK_BLE_UUID_STANDARD;
+		uuids[i].uuid       = uuid[0] | (uuid[1] << 8);
+	}
+
+	// Indicate we are waiting for an async event with a result
+	// This has to be set before the sendMessage call
+	BleFuture future = _async.start();
+
+	microapp_sdk_result_t result = requestDiscover(uuids, count);
+	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
+		// direct success or failure
+		_async.complete(result);
+	}
+	// Otherwise the discover done event completes the future
+	return future;
 }
 
 // Only defined for peripheral devices
 bool BleDevice::discoverService(const char* serviceUuid, uint32_t timeout) {
+	return (discoverServiceAsync(serviceUuid).wait(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+}
+
+// Only defined for peripheral devices
+BleFuture BleDevice::discoverServiceAsync(const char* serviceUuid) {
 	if (!_flags.initialized || !_flags.isPeripheral) {
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_UNDEFINED);
 	}
 	if (_flags.discoveryDone) {
-		return true;
+		return BleFuture(CS_MICROAPP_SDK_ACK_SUCCESS);
 	}
 	microapp_sdk_result_t result;
 	Uuid uuid(serviceUuid);
 	if (!uuid.registered()) {
 		result = uuid.registerCustom();
 		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-			return false;
+			return BleFuture(result);
 		}
 	}
 	// Indicate we are waiting for an async event with a result
 	// This has to be set before the sendMessage call
-	_asyncResult = BleAsyncWaiting;
-
-	uint8_t* payload                                  = getOutgoingMessagePayload();
-	microapp_sdk_ble_t* bleRequest                    = (microapp_sdk_ble_t*)(payload);
-	bleRequest->header.messageType                    = CS_MICROAPP_SDK_TYPE_BLE;
-	bleRequest->header.ack                            = CS_MICROAPP_SDK_ACK_REQUEST;
-	bleRequest->type                                  = CS_MICROAPP_SDK_BLE_CENTRAL;
-	bleRequest->central.type                          = CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_DISCOVER;
-	bleRequest->central.requestDiscover.uuidCount     = 1;
-	bleRequest->central.requestDiscover.uuids[0].type = uuid.getType();
-	bleRequest->central.requestDiscover.uuids[0].uuid = uuid.uuid16();
-	bleRequest->central.connectionHandle              = _connectionHandle;
+	BleFuture future = _async.start();
+
+	microapp_sdk_ble_uuid_t requestUuid;
+	requestUuid.type = uuid.getType();
+	requestUuid.uuid = uuid.uuid16();
+	result           = requestDiscover(&requestUuid, 1);
+	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
+		// direct success or failure
+		_async.complete(result);
+	}
+	// Otherwise the discover done event completes the future
+	return future;
+}
+
+// Only defined for peripheral devices
+microapp_sdk_result_t BleDevice::requestDiscover(const microapp_sdk_ble_uuid_t* uuids, uint8_t count) {
+	uint8_t* payload                              = getOutgoingMessagePayload();
+	microapp_sdk_ble_t* bleRequest                = (microapp_sdk_ble_t*)(payload);
+	bleRequest->header.messageType                = CS_MICROAPP_SDK_TYPE_BLE;
+	bleRequest->header.ack                        = CS_MICROAPP_SDK_ACK_REQUEST;
+	bleRequest->type                              = CS_MICROAPP_SDK_BLE_CENTRAL;
+	bleRequest->central.type                      = CS_MICROAPP_SDK_BLE_CENTRAL_REQUEST_DISCOVER;
+	bleRequest->central.requestDiscover.uuidCount = count;
+	for (uint8_t i = 0; i < count; i++) {
+		bleRequest->central.requestDiscover.uuids[i] = uuids[i];
+	}
+	bleRequest->central.connectionHandle = _connectionHandle;
 
 	sendMessage();
-	result = (microapp_sdk_result_t)bleRequest->header.ack;
-	if (result == CS_MICROAPP_SDK_ACK_SUCCESS) {
-		// direct success
-		_asyncResult = BleAsyncNotWaiting;
-		return true;
+	return (microapp_sdk_result_t)bleRequest->header.ack;
+}
+
+#ifdef MICROAPP_BLE_ATTRIBUTE_POOL
+// Only defined for peripheral devices
+uint8_t BleDevice::attributeCount() {
+	if (!_flags.initialized || !_flags.isPeripheral || _attributes == nullptr) {
+		return 0;
 	}
-	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
-		// direct failure
-		_asyncResult = BleAsyncNotWaiting;
-		return false;
+	if (!_flags.discoveryDone) {
+		return 0;
 	}
-	return waitForAsyncResult(timeout);
+	return _attributes->count();
 }
 
+// Only defined for peripheral devices
+const ble_attribute_t* BleDevice::attribute(uint8_t index) {
+	if (index >= attributeCount()) {
+		return nullptr;
+	}
+	return _attributes->get(index);
+}
+#endif
+
 // Only defined for peripheral devices
 uint8_t BleDevice::serviceCount() {
 	if (!_flags.initialized || !_flags.isPeripheral) {
@@ -346,7 +403,7 @@ bool BleDevice::hasLocalName() {
 	if (!_flags.initialized || !_flags.isPeripheral) {
 		return false;
 	}
-	return (BleScan::localName(_scanData, _scanSize).len != 0);
+	return (BleScan::localName(_scanData, adIndex()).len != 0);
 }
 
 // Only defined for peripheral devices
@@ -354,11 +411,11 @@ String BleDevice::localName() {
 	if (!_flags.initialized || !_flags.isPeripheral) {
 		return String(nullptr);
 	}
-	ble_ad_t localName = BleScan::localName(_scanData, _scanSize);
+	ble_ad_t localName = BleScan::localName(_scanData, adIndex());
 	if (localName.len == 0) {
 		return String(nullptr);
 	}
-	static char localNameString[MAX_BLE_ADV_DATA_LENGTH + 1];
+	static char localNameString[MAX_BLE_SCAN_DATA_LENGTH + 1];
 	memcpy(localNameString, localName.data, localName.len);
 	localNameString[localName.len] = 0;
 	return String(localNameString);
@@ -368,44 +425,91 @@ bool BleDevice::hasAdvertisedServiceUuid() {
 	if (!_flags.initialized || !_flags.isPeripheral) {
 		return false;
 	}
-	return BleScan::hasServiceUuid(_scanData, _scanSize);
+	return BleScan::hasServiceUuid(_scanData, adIndex());
 }
 
 uint8_t BleDevice::advertisedServiceUuidCount() {
 	if (!_flags.initialized || !_flags.isPeripheral) {
 		return false;
 	}
-	return BleScan::serviceUuidCount(_scanData, _scanSize);
+	return BleScan::serviceUuidCount(_scanData, adIndex());
 }
 
 String BleDevice::advertisedServiceUuid(uint8_t index) {
 	if (!_flags.initialized || !_flags.isPeripheral) {
 		return String(nullptr);
 	}
-	Uuid uuid = Uuid(BleScan::serviceUuid(_scanData, _scanSize, index), CS_MICROAPP_SDK_BLE_UUID_STANDARD);
+	Uuid uuid = Uuid(BleScan::serviceUuid(_scanData, adIndex(), index), CS_MICROAPP_SDK_BLE_UUID_STANDARD);
 	return String(uuid.string());
 }
 
+uint8_t BleDevice::advertisedServiceUuidCount(uint8_t uuidLength) {
+	if (!_flags.initialized || !_flags.isPeripheral) {
+		return 0;
+	}
+	return BleScan::serviceUuidCount(_scanData, adIndex(), uuidLength);
+}
+
+const uint8_t* BleDevice::advertisedServiceUuidBytes(uint8_t uuidLength, uint8_t index) {
+	if (!_flags.initialized || !_flags.isPeripheral) {
+		return nullptr;
+	}
+	return BleScan::serviceUuidBytes(_scanData, adIndex(), uuidLength, index);
+}
+
+bool BleDevice::findServiceData(uuid16_t uuid, ble_service_data_t* foundData) {
+	if (!_flags.initialized || !_flags.isPeripheral) {
+		return false;
+	}
+	return BleScan::findServiceData(_scanData, adIndex(), uuid, foundData);
+}
+
+bool BleDevice::nextServiceData(uint8_t& cursor, ble_service_data_t* foundData) {
+	if (!_flags.initialized || !_flags.isPeripheral) {
+		return false;
+	}
+	return BleScan::nextServiceData(_scanData, adIndex(), cursor, foundData);
+}
+
+bool BleDevice::findManufacturerData(uint16_t companyId, ble_manufacturer_data_t* foundData) {
+	if (!_flags.initialized || !_flags.isPeripheral) {
+		return false;
+	}
+	return BleScan::findManufacturerData(_scanData, adIndex(), companyId, foundData);
+}
+
+bool BleDevice::nextManufacturerData(uint8_t& cursor, ble_manufacturer_data_t* foundData) {
+	if (!_flags.initialized || !_flags.isPeripheral) {
+		return false;
+	}
+	return BleScan::nextManufacturerData(_scanData, adIndex(), cursor, foundData);
+}
+
 // Only defined for peripheral devices
 bool BleDevice::connect(uint32_t timeout) {
+	return (connectAsync().wait(timeout) == CS_MICROAPP_SDK_ACK_SUCCESS);
+}
+
+// Only defined for peripheral devices
+BleFuture BleDevice::connectAsync() {
 	if (!_flags.initialized || !_flags.isPeripheral) {
-		return false;
+		return BleFuture(CS_MICROAPP_SDK_ACK_ERR_UNDEFINED);
 	}
 	if (_flags.connected) {
 		// already connected
-		return true;
+		return BleFuture(CS_MICROAPP_SDK_ACK_SUCCESS);
 	}
 	microapp_sdk_result_t result;
 	// First register interrupts
 	if (!registeredBleInterrupt(CS_MICROAPP_SDK_BLE_CENTRAL)) {
 		result = registerBleInterrupt(CS_MICROAPP_SDK_BLE_CENTRAL);
 		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
-			return false;
+			return BleFuture(result);
 		}
 	}
 	// Indicate we are waiting for an async event with a result
 	// This has to be set before the sendMessage call
-	_asyncResult = BleAsyncWaiting;
+	BleFuture future = _async.start();
 
 	// Next, request connect
 	uint8_t* payload                                = getOutgoingMessagePayload();
@@ -420,16 +524,12 @@ bool BleDevice::connect(uint32_t timeout) {
 
 	sendMessage();
 	result = (microapp_sdk_result_t)bleRequest->header.ack;
-	if (result == CS_MICROAPP_SDK_ACK_SUCCESS) {
-		// direct success
-		_asyncResult = BleAsyncNotWaiting;
-		return true;
-	}
 	if (result != CS_MICROAPP_SDK_ACK_IN_PROGRESS) {
-		_asyncResult = BleAsyncNotWaiting;
-		return false;
+		// direct success or failure
+		_async.complete(result);
 	}
-	return waitForAsyncResult(timeout);
+	// Otherwise the connect event completes the future
+	return future;
 }
 
 // Only defined for peripheral devices
@@ -437,7 +537,7 @@ bool BleDevice::findAdvertisementDataType(GapAdvType type, ble_ad_t* foundData)
 	if (!_flags.initialized || !_flags.isPeripheral) {
 		return false;
 	}
-	return BleScan::findAdvertisementDataType(_scanData, _scanSize, type, foundData);
+	return BleScan::findAdvertisementDataType(_scanData, adIndex(), type, foundData);
 }
 
 // Only defined for central devices
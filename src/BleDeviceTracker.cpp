@@ -0,0 +1,165 @@
+#include <BleDeviceTracker.h>
+
+static_assert((MAX_TRACKED_DEVICES & (MAX_TRACKED_DEVICES - 1)) == 0, "MAX_TRACKED_DEVICES should be a power of 2");
+
+static rssi_t median(const rssi_t* samples, uint8_t count) {
+	switch (count) {
+		case 1: return samples[0];
+		case 2: return (samples[0] + samples[1]) / 2;
+		default: {
+			rssi_t low  = (samples[0] < samples[1]) ? samples[0] : samples[1];
+			rssi_t high = (samples[0] < samples[1]) ? samples[1] : samples[0];
+			if (samples[2] < low) {
+				return low;
+			}
+			return (samples[2] < high) ? samples[2] : high;
+		}
+	}
+}
+
+ble_tracked_device_t* BleDeviceTracker::findSlot(const uint8_t* address, bool& found, TrackerEventHandler handler) {
+	uint32_t now  = tickCount();
+	uint8_t index = hashBytes(address, MAC_ADDRESS_LENGTH) & (MAX_TRACKED_DEVICES - 1);
+	// Slot to track the device in, if it is not found: a device that left, otherwise the least recently seen one
+	ble_tracked_device_t* slot = nullptr;
+	bool slotPresent           = true;
+	for (uint8_t probe = 0; probe < MAX_TRACKED_DEVICES; ++probe) {
+		uint8_t i = (index + probe) & (MAX_TRACKED_DEVICES - 1);
+		if (!_used[i]) {
+			if (slotPresent) {
+				slot        = &_devices[i];
+				slotPresent = false;
+				_used[i]    = true;
+			}
+			break;
+		}
+		ble_tracked_device_t& device = _devices[i];
+		if (memcmp(device.address, address, MAC_ADDRESS_LENGTH) == 0) {
+			found = true;
+			return &device;
+		}
+		bool older = (slot == nullptr || now - device.lastSeen > now - slot->lastSeen);
+		if (!device.present) {
+			if (slotPresent || older) {
+				slot        = &device;
+				slotPresent = false;
+			}
+		}
+		else if (slotPresent && older) {
+			slot = &device;
+		}
+	}
+	found = false;
+	if (slotPresent) {
+		leave(*slot, handler);
+	}
+	return slot;
+}
+
+void BleDeviceTracker::filter(ble_tracked_device_t& device, rssi_t rssi) {
+	for (uint8_t i = TRACKER_MEDIAN_WINDOW - 1; i > 0; --i) {
+		device.samples[i] = device.samples[i - 1];
+	}
+	device.samples[0] = rssi;
+	if (device.sampleCount < TRACKER_MEDIAN_WINDOW) {
+		device.sampleCount++;
+	}
+	switch (_filter) {
+		case BleRssiFilterMedian: {
+			device.rssi = median(device.samples, device.sampleCount);
+			break;
+		}
+		case BleRssiFilterEma:
+		default: {
+			if (device.sampleCount == 1) {
+				device.ema = rssi * 16;
+			}
+			else {
+				device.ema += (rssi * 16 - device.ema) / (1 << TRACKER_EMA_SHIFT);
+			}
+			// Round to the nearest dB
+			device.rssi = (device.ema - 8) / 16;
+			break;
+		}
+	}
+}
+
+void BleDeviceTracker::leave(ble_tracked_device_t& device, TrackerEventHandler handler) {
+	device.present = false;
+	if (handler != nullptr) {
+		handler(device, BleTrackerLeave);
+	}
+}
+
+void BleDeviceTracker::update(const microapp_sdk_ble_scan_event_t& scan, TrackerEventHandler handler) {
+	bool found;
+	ble_tracked_device_t* device = findSlot(scan.address.address, found, handler);
+	if (!found) {
+		memcpy(device->address, scan.address.address, MAC_ADDRESS_LENGTH);
+		device->present     = false;
+		device->sampleCount = 0;
+		device->hits        = 0;
+	}
+	device->addressType = scan.address.type;
+	device->lastSeen    = tickCount();
+	if (device->hits < 0xFFFF) {
+		device->hits++;
+	}
+	filter(*device, scan.rssi);
+	if (!device->present && device->rssi >= _enterRssi) {
+		device->present = true;
+		if (handler != nullptr) {
+			handler(*device, BleTrackerEnter);
+		}
+	}
+	else if (device->present && device->rssi < _leaveRssi) {
+		leave(*device, handler);
+	}
+}
+
+void BleDeviceTracker::age(TrackerEventHandler handler) {
+	uint32_t now = tickCount();
+	if (now == _agedTick) {
+		return;
+	}
+	_agedTick = now;
+	for (uint8_t i = 0; i < MAX_TRACKED_DEVICES; ++i) {
+		if (_used[i] && _devices[i].present && now - _devices[i].lastSeen >= _timeout) {
+			leave(_devices[i], handler);
+		}
+	}
+}
+
+void BleDeviceTracker::clear() {
+	memset(_used, 0, sizeof(_used));
+}
+
+void BleDeviceTracker::configure(BleRssiFilterType filter, rssi_t enterRssi, rssi_t leaveRssi, uint16_t timeoutTicks) {
+	_filter    = filter;
+	_enterRssi = enterRssi;
+	_leaveRssi = leaveRssi;
+	_timeout   = timeoutTicks;
+	clear();
+}
+
+uint8_t BleDeviceTracker::count() {
+	uint8_t result = 0;
+	for (uint8_t i = 0; i < MAX_TRACKED_DEVICES; ++i) {
+		if (_used[i] && _devices[i].present) {
+			result++;
+		}
+	}
+	return result;
+}
+
+const ble_tracked_device_t* BleDeviceTracker::get(uint8_t index) {
+	for (uint8_t i = 0; i < MAX_TRACKED_DEVICES; ++i) {
+		if (_used[i] && _devices[i].present) {
+			if (index == 0) {
+				return &_devices[i];
+			}
+			index--;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,68 @@
+#include <BleDuplicateFilter.h>
+
+static_assert((MAX_SCAN_DUPLICATE_FILTER_SIZE & (MAX_SCAN_DUPLICATE_FILTER_SIZE - 1)) == 0,
+			  "MAX_SCAN_DUPLICATE_FILTER_SIZE should be a power of 2");
+
+bool BleDuplicateFilter::isDuplicate(const microapp_sdk_ble_scan_event_t& scan) {
+	uint32_t now      = tickCount();
+	uint8_t dataSize  = (scan.size > MAX_BLE_SCAN_DATA_LENGTH) ? MAX_BLE_SCAN_DATA_LENGTH : scan.size;
+	uint16_t dataHash = 0;
+	if (_compareData) {
+		uint32_t fullHash = hashBytes(scan.data, dataSize);
+		dataHash          = (fullHash >> 16) ^ (fullHash & 0xFFFF);
+	}
+	uint8_t index = hashBytes(scan.address.address, MAC_ADDRESS_LENGTH) & (MAX_SCAN_DUPLICATE_FILTER_SIZE - 1);
+	// Slot to remember the device in, if it is not found: the first free one, otherwise the oldest one
+	ble_duplicate_entry_t* slot = nullptr;
+	bool slotFree               = false;
+	for (uint8_t probe = 0; probe < MAX_SCAN_DUPLICATE_FILTER_SIZE; ++probe) {
+		uint8_t i = (index + probe) & (MAX_SCAN_DUPLICATE_FILTER_SIZE - 1);
+		if (!_used[i]) {
+			if (!slotFree) {
+				slot     = &_entries[i];
+				_used[i] = true;
+			}
+			break;
+		}
+		ble_duplicate_entry_t& entry = _entries[i];
+		bool expired                 = (now - entry.tick >= _ttl);
+		if (memcmp(entry.address, scan.address.address, MAC_ADDRESS_LENGTH) == 0) {
+			if (!expired && entry.dataHash == dataHash) {
+				_duplicateCount++;
+				return true;
+			}
+			// Seen, but long enough ago, or with other data
+			slot     = &entry;
+			slotFree = true;
+			break;
+		}
+		if (slotFree) {
+			continue;
+		}
+		if (expired) {
+			slot     = &entry;
+			slotFree = true;
+		}
+		else if (slot == nullptr || now - entry.tick > now - slot->tick) {
+			slot = &entry;
+		}
+	}
+	memcpy(slot->address, scan.address.address, MAC_ADDRESS_LENGTH);
+	slot->dataHash = dataHash;
+	slot->tick     = now;
+	return false;
+}
+
+void BleDuplicateFilter::clear() {
+	memset(_used, 0, sizeof(_used));
+}
+
+void BleDuplicateFilter::configure(uint16_t ttl, bool compareData) {
+	_ttl         = ttl;
+	_compareData = compareData;
+	clear();
+}
+
+uint16_t BleDuplicateFilter::duplicateCount() {
+	return _duplicateCount;
+}
@@ -0,0 +1,56 @@
+#include <Arduino.h>
+#include <BleFuture.h>
+
+BleFuture BleAsyncOperation::start() {
+	_sequence++;
+	_state    = BleAsyncWaiting;
+	_callback = nullptr;
+	return BleFuture(this, _sequence);
+}
+
+void BleAsyncOperation::complete(microapp_sdk_result_t result) {
+	_result                    = result;
+	_state                     = (result == CS_MICROAPP_SDK_ACK_SUCCESS) ? BleAsyncSuccess : BleAsyncFailure;
+	BleFutureCallback callback = _callback;
+	_callback                  = nullptr;
+	if (callback != nullptr) {
+		callback(result);
+	}
+}
+
+bool BleFuture::ready() {
+	return result() != CS_MICROAPP_SDK_ACK_IN_PROGRESS;
+}
+
+microapp_sdk_result_t BleFuture::result() {
+	if (_operation == nullptr) {
+		return _result;
+	}
+	if (_operation->_sequence != _sequence) {
+		return CS_MICROAPP_SDK_ACK_ERR_BUSY;
+	}
+	if (_operation->_state == BleAsyncWaiting) {
+		return CS_MICROAPP_SDK_ACK_IN_PROGRESS;
+	}
+	return _operation->_result;
+}
+
+microapp_sdk_result_t BleFuture::wait(uint32_t timeout) {
+	int16_t tries = timeout / MICROAPP_LOOP_INTERVAL_MS;
+	while (!ready()) {
+		if (tries-- <= 0) {
+			return CS_MICROAPP_SDK_ACK_ERR_TIMEOUT;
+		}
+		// Yield. Upon an event from bluenet the request will be completed
+		delay(MICROAPP_LOOP_INTERVAL_MS);
+	}
+	return result();
+}
+
+void BleFuture::onComplete(BleFutureCallback callback) {
+	if (ready()) {
+		callback(result());
+		return;
+	}
+	_operation->_callback = callback;
+}
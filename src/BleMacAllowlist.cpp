@@ -0,0 +1,95 @@
+#include <BleMacAllowlist.h>
+
+static_assert((MAC_ALLOWLIST_BLOOM_BYTES & (MAC_ALLOWLIST_BLOOM_BYTES - 1)) == 0,
+			  "MAC_ALLOWLIST_BLOOM_BYTES should be a power of 2");
+
+const uint32_t BLOOM_BIT_MASK = MAC_ALLOWLIST_BLOOM_BYTES * 8 - 1;
+
+/*
+ * Get the bits of an address in the Bloom filter, by double hashing: bit i is h1 + i * h2.
+ * Both are the full hash, so that they reach every bit of large filters as well.
+ */
+static void bloomBits(const uint8_t* address, uint32_t* bits) {
+	uint32_t hash = hashBytes(address, MAC_ADDRESS_LENGTH);
+	uint32_t h1   = hash;
+	// Rotated, so that small filters use other bits than for h1. Odd, so that the bits differ
+	uint32_t h2   = ((hash >> 16) | (hash << 16)) | 1;
+	for (uint8_t i = 0; i < MAC_ALLOWLIST_BLOOM_HASHES; ++i) {
+		bits[i] = (h1 + i * h2) & BLOOM_BIT_MASK;
+	}
+}
+
+bool BleMacAllowlist::set(const uint8_t (*table)[MAC_ADDRESS_LENGTH], uint16_t size) {
+	clear();
+	for (uint16_t i = 1; i < size; ++i) {
+		if (memcmp(table[i - 1], table[i], MAC_ADDRESS_LENGTH) >= 0) {
+			return false;
+		}
+	}
+	uint32_t bits[MAC_ALLOWLIST_BLOOM_HASHES];
+	for (uint16_t i = 0; i < size; ++i) {
+		bloomBits(table[i], bits);
+		for (uint8_t j = 0; j < MAC_ALLOWLIST_BLOOM_HASHES; ++j) {
+			_bloom[bits[j] >> 3] |= 1 << (bits[j] & 7);
+		}
+	}
+	_table = table;
+	_size  = size;
+	return true;
+}
+
+void BleMacAllowlist::clear() {
+	_table = nullptr;
+	_size  = 0;
+	memset(_bloom, 0, sizeof(_bloom));
+	_falsePositiveCount = 0;
+}
+
+bool BleMacAllowlist::enabled() {
+	return _table != nullptr;
+}
+
+bool BleMacAllowlist::mayContain(const uint8_t* address) {
+	uint32_t bits[MAC_ALLOWLIST_BLOOM_HASHES];
+	bloomBits(address, bits);
+	for (uint8_t i = 0; i < MAC_ALLOWLIST_BLOOM_HASHES; ++i) {
+		if ((_bloom[bits[i] >> 3] & (1 << (bits[i] & 7))) == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool BleMacAllowlist::search(const uint8_t* address) {
+	uint16_t low  = 0;
+	uint16_t high = _size;
+	while (low < high) {
+		uint16_t middle = low + (high - low) / 2;
+		int result      = memcmp(_table[middle], address, MAC_ADDRESS_LENGTH);
+		if (result == 0) {
+			return true;
+		}
+		if (result < 0) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return false;
+}
+
+bool BleMacAllowlist::contains(const uint8_t* address) {
+	if (!mayContain(address)) {
+		return false;
+	}
+	if (!search(address)) {
+		_falsePositiveCount++;
+		return false;
+	}
+	return true;
+}
+
+uint16_t BleMacAllowlist::falsePositiveCount() {
+	return _falsePositiveCount;
+}
@@ -1,47 +1,66 @@
 #include <BleScan.h>
 
-ble_ad_t BleScan::localName(const uint8_t* scanData, uint8_t scanSize) {
-	ble_ad_t localName;
-	if (findAdvertisementDataType(scanData, scanSize, GapAdvType::CompleteLocalName, &localName)) {
-		return localName; // filled
-	}
-	else if (findAdvertisementDataType(scanData, scanSize, GapAdvType::ShortenedLocalName, &localName)) {
-		return localName; // filled
-	}
-	else {
-		return localName; // empty
+void BleScan::buildIndex(const uint8_t* scanData, uint8_t scanSize, ble_ad_index_t& index) {
+	index.count = 0;
+	uint8_t i   = 0;
+	while (i + 1 < scanSize && index.count < MAX_AD_STRUCTURES) {
+		uint8_t fieldLen = scanData[i];
+		if (fieldLen == 0 || i + 1 + fieldLen > scanSize) {
+			return;
+		}
+		index.offsets[index.count++] = i;
+		i += fieldLen + 1;
 	}
 }
 
-bool BleScan::findAdvertisementDataType(const uint8_t* scanData, uint8_t scanSize, GapAdvType type, ble_ad_t* foundData) {
-	uint8_t i       = 0;
+bool BleScan::findAdvertisementDataType(const uint8_t* scanData, const ble_ad_index_t& index, GapAdvType type, ble_ad_t* foundData) {
 	foundData->type = 0;
 	foundData->data = nullptr;
 	foundData->len  = 0;
-	while (i < scanSize - 1) {
-		uint8_t fieldLen  = scanData[i];
-		uint8_t fieldType = scanData[i + 1];
-		if (fieldLen == 0 || i + 1 + fieldLen > scanSize) {
-			return false;
-		}
-		if (fieldType == type) {
-			foundData->data = &scanData[i + 2];
-			foundData->len  = fieldLen - 1;
+	for (uint8_t i = 0; i < index.count; ++i) {
+		const uint8_t* field = &scanData[index.offsets[i]];
+		if (field[1] == type) {
+			foundData->data = &field[2];
+			foundData->len  = field[0] - 1;
 			foundData->type = (uint8_t)type;
 			return true;
 		}
-		i += fieldLen + 1;
 	}
 	return false;
 }
 
-bool BleScan::hasServiceUuid(const uint8_t* scanData, uint8_t scanSize, uuid16_t uuid) {
+bool BleScan::findAdvertisementDataType(const uint8_t* scanData, uint8_t scanSize, GapAdvType type, ble_ad_t* foundData) {
+	ble_ad_index_t index;
+	buildIndex(scanData, scanSize, index);
+	return findAdvertisementDataType(scanData, index, type, foundData);
+}
+
+ble_ad_t BleScan::localName(const uint8_t* scanData, const ble_ad_index_t& index) {
+	ble_ad_t localName;
+	if (findAdvertisementDataType(scanData, index, GapAdvType::CompleteLocalName, &localName)) {
+		return localName; // filled
+	}
+	else if (findAdvertisementDataType(scanData, index, GapAdvType::ShortenedLocalName, &localName)) {
+		return localName; // filled
+	}
+	else {
+		return localName; // empty
+	}
+}
+
+ble_ad_t BleScan::localName(const uint8_t* scanData, uint8_t scanSize) {
+	ble_ad_index_t index;
+	buildIndex(scanData, scanSize, index);
+	return localName(scanData, index);
+}
+
+bool BleScan::hasServiceUuid(const uint8_t* scanData, const ble_ad_index_t& index, uuid16_t uuid) {
 	GapAdvType serviceUuidListTypes[2] = {
 			GapAdvType::IncompleteList16BitServiceUuids,
 			GapAdvType::CompleteList16BitServiceUuids};
 	ble_ad_t ad;
 	for (uint8_t i = 0; i < sizeof(serviceUuidListTypes) / sizeof(serviceUuidListTypes[0]); i++) {
-		if (findAdvertisementDataType(scanData, scanSize, serviceUuidListTypes[i], &ad)) {
+		if (findAdvertisementDataType(scanData, index, serviceUuidListTypes[i], &ad)) {
 			// uuid == 0 means any uuid
 			if (uuid == 0 && ad.len >= sizeof(uuid)) {
 				return true;
@@ -59,35 +78,176 @@ bool BleScan::hasServiceUuid(const uint8_t* scanData, uint8_t scanSize, uuid16_t
 	return false;
 }
 
+bool BleScan::hasServiceUuid(const uint8_t* scanData, uint8_t scanSize, uuid16_t uuid) {
+	ble_ad_index_t index;
+	buildIndex(scanData, scanSize, index);
+	return hasServiceUuid(scanData, index, uuid);
+}
+
+uint8_t BleScan::serviceUuidCount(const uint8_t* scanData, const ble_ad_index_t& index) {
+	return serviceUuidCount(scanData, index, UUID_16BIT_BYTE_LENGTH);
+}
+
 uint8_t BleScan::serviceUuidCount(const uint8_t* scanData, uint8_t scanSize) {
-	GapAdvType serviceUuidListTypes[2] = {
-			GapAdvType::IncompleteList16BitServiceUuids,
-			GapAdvType::CompleteList16BitServiceUuids};
+	ble_ad_index_t index;
+	buildIndex(scanData, scanSize, index);
+	return serviceUuidCount(scanData, index);
+}
+
+uuid16_t BleScan::serviceUuid(const uint8_t* scanData, const ble_ad_index_t& adIndex, uint8_t index) {
+	const uint8_t* uuid = serviceUuidBytes(scanData, adIndex, UUID_16BIT_BYTE_LENGTH, index);
+	if (uuid == nullptr) {
+		return 0;
+	}
+	return ((uuid[1] << 8) | uuid[0]);
+}
+
+uuid16_t BleScan::serviceUuid(const uint8_t* scanData, uint8_t scanSize, uint8_t index) {
+	ble_ad_index_t adIndex;
+	buildIndex(scanData, scanSize, adIndex);
+	return serviceUuid(scanData, adIndex, index);
+}
+
+bool BleScan::nextAdvertisementDataType(
+		const uint8_t* scanData, const ble_ad_index_t& index, GapAdvType type, uint8_t& cursor, ble_ad_t* foundData) {
+	foundData->type = 0;
+	foundData->data = nullptr;
+	foundData->len  = 0;
+	for (; cursor < index.count; ++cursor) {
+		const uint8_t* field = &scanData[index.offsets[cursor]];
+		if (field[1] == type) {
+			foundData->data = &field[2];
+			foundData->len  = field[0] - 1;
+			foundData->type = (uint8_t)type;
+			cursor++;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Get the GAP ad types of the lists of service uuids of a given size.
+ *
+ * @return false for an invalid uuid size.
+ */
+static bool serviceUuidListTypes(uint8_t uuidLength, GapAdvType* listTypes) {
+	switch (uuidLength) {
+		case UUID_16BIT_BYTE_LENGTH: {
+			listTypes[0] = GapAdvType::IncompleteList16BitServiceUuids;
+			listTypes[1] = GapAdvType::CompleteList16BitServiceUuids;
+			return true;
+		}
+		case UUID_32BIT_BYTE_LENGTH: {
+			listTypes[0] = GapAdvType::IncompleteList32BitServiceUuids;
+			listTypes[1] = GapAdvType::CompleteList32BitServiceUuids;
+			return true;
+		}
+		case UUID_128BIT_BYTE_LENGTH: {
+			listTypes[0] = GapAdvType::IncompleteList128BitServiceUuids;
+			listTypes[1] = GapAdvType::CompleteList128BitServiceUuids;
+			return true;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+uint8_t BleScan::serviceUuidCount(const uint8_t* scanData, const ble_ad_index_t& index, uint8_t uuidLength) {
+	GapAdvType listTypes[2];
+	if (!serviceUuidListTypes(uuidLength, listTypes)) {
+		return 0;
+	}
 	ble_ad_t ad;
 	uint8_t count = 0;
-	for (uint8_t i = 0; i < sizeof(serviceUuidListTypes) / sizeof(serviceUuidListTypes[0]); i++) {
-		if (findAdvertisementDataType(scanData, scanSize, serviceUuidListTypes[i], &ad)) {
-			count += ad.len / UUID_16BIT_BYTE_LENGTH;
+	for (uint8_t i = 0; i < 2; i++) {
+		if (findAdvertisementDataType(scanData, index, listTypes[i], &ad)) {
+			count += ad.len / uuidLength;
 		}
 	}
 	return count;
 }
 
-uuid16_t BleScan::serviceUuid(const uint8_t* scanData, uint8_t scanSize, uint8_t index) {
-	GapAdvType serviceUuidListTypes[2] = {
-			GapAdvType::IncompleteList16BitServiceUuids,
-			GapAdvType::CompleteList16BitServiceUuids};
+const uint8_t* BleScan::serviceUuidBytes(
+		const uint8_t* scanData, const ble_ad_index_t& index, uint8_t uuidLength, uint8_t uuidIndex) {
+	GapAdvType listTypes[2];
+	if (!serviceUuidListTypes(uuidLength, listTypes)) {
+		return nullptr;
+	}
 	ble_ad_t ad;
-	uint8_t count = 0;
-	for (uint8_t i = 0; i < sizeof(serviceUuidListTypes) / sizeof(serviceUuidListTypes[0]); i++) {
-		if (findAdvertisementDataType(scanData, scanSize, serviceUuidListTypes[i], &ad)) {
-			for (uint8_t j = 0; j < ad.len; j += 2) {
-				if (count == index) {
-					return ((ad.data[j + 1] << 8) | ad.data[j]);
-				}
-				count++;
+	for (uint8_t i = 0; i < 2; i++) {
+		if (findAdvertisementDataType(scanData, index, listTypes[i], &ad)) {
+			uint8_t count = ad.len / uuidLength;
+			if (uuidIndex < count) {
+				return ad.data + uuidIndex * uuidLength;
 			}
+			uuidIndex -= count;
+		}
+	}
+	return nullptr;
+}
+
+bool BleScan::nextServiceData(
+		const uint8_t* scanData, const ble_ad_index_t& index, uint8_t& cursor, ble_service_data_t* foundData) {
+	*foundData = ble_service_data_t();
+	for (; cursor < index.count; ++cursor) {
+		const uint8_t* field = &scanData[index.offsets[cursor]];
+		uint8_t uuidLength;
+		switch (field[1]) {
+			case GapAdvType::ServiceData16BitUuid: uuidLength = UUID_16BIT_BYTE_LENGTH; break;
+			case GapAdvType::ServiceData32BitUuid: uuidLength = UUID_32BIT_BYTE_LENGTH; break;
+			case GapAdvType::ServiceData128BitUuid: uuidLength = UUID_128BIT_BYTE_LENGTH; break;
+			default: continue;
+		}
+		uint8_t len = field[0] - 1;
+		if (len < uuidLength) {
+			continue;
+		}
+		foundData->uuidLength = uuidLength;
+		foundData->uuid       = &field[2];
+		foundData->len        = len - uuidLength;
+		foundData->data       = &field[2 + uuidLength];
+		cursor++;
+		return true;
+	}
+	return false;
+}
+
+bool BleScan::findServiceData(
+		const uint8_t* scanData, const ble_ad_index_t& index, uuid16_t uuid, ble_service_data_t* foundData) {
+	uint8_t cursor = 0;
+	while (nextServiceData(scanData, index, cursor, foundData)) {
+		if (foundData->uuidLength == UUID_16BIT_BYTE_LENGTH && ((foundData->uuid[1] << 8) | foundData->uuid[0]) == uuid) {
+			return true;
 		}
 	}
-	return 0;
+	return false;
+}
+
+bool BleScan::nextManufacturerData(
+		const uint8_t* scanData, const ble_ad_index_t& index, uint8_t& cursor, ble_manufacturer_data_t* foundData) {
+	*foundData = ble_manufacturer_data_t();
+	ble_ad_t ad;
+	while (nextAdvertisementDataType(scanData, index, GapAdvType::ManufacturerSpecificData, cursor, &ad)) {
+		if (ad.len < sizeof(uint16_t)) {
+			continue;
+		}
+		foundData->companyId = (ad.data[1] << 8) | ad.data[0];
+		foundData->len       = ad.len - sizeof(uint16_t);
+		foundData->data      = ad.data + sizeof(uint16_t);
+		return true;
+	}
+	return false;
+}
+
+bool BleScan::findManufacturerData(
+		const uint8_t* scanData, const ble_ad_index_t& index, uint16_t companyId, ble_manufacturer_data_t* foundData) {
+	uint8_t cursor = 0;
+	while (nextManufacturerData(scanData, index, cursor, foundData)) {
+		if (foundData->companyId == companyId) {
+			return true;
+		}
+	}
+	return false;
 }
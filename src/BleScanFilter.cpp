@@ -0,0 +1,172 @@
+#include <BleScanFilter.h>
+
+/*
+ * Returns the size of the operation at code, including its operands.
+ */
+static uint8_t operationSize(const uint8_t* code) {
+	switch (code[0]) {
+		case BleScanFilterOpMacPrefix:
+		case BleScanFilterOpNamePrefix: return 2 + code[1];
+		case BleScanFilterOpMinRssi: return 2;
+		case BleScanFilterOpManufacturerId:
+		case BleScanFilterOpServiceDataUuid: return 1 + sizeof(uint16_t);
+		case BleScanFilterOpOr:
+		default: return 1;
+	}
+}
+
+BleScanFilter& BleScanFilter::append(BleScanFilterOp op, const uint8_t* operands, uint8_t size) {
+	if (_size + 1 + size > MAX_SCAN_FILTER_SIZE) {
+		_valid = false;
+		return *this;
+	}
+	_code[_size] = op;
+	memcpy(_code + _size + 1, operands, size);
+	_size += 1 + size;
+	return *this;
+}
+
+BleScanFilter& BleScanFilter::macPrefix(const char* prefix) {
+	uint8_t operands[1 + MAC_ADDRESS_LENGTH];
+	uint8_t length = strlen(prefix);
+	// Pairs of hex characters, separated by colons
+	if (length % 3 != 2 || length > MAC_ADDRESS_STRING_LENGTH) {
+		_valid = false;
+		return *this;
+	}
+	operands[0] = (length + 1) / 3;
+	for (uint8_t i = 0; i < operands[0]; ++i) {
+		if ((i > 0 && prefix[3 * i - 1] != ':') || !convertTwoHexCharsToByte(prefix + 3 * i, &operands[1 + i])) {
+			_valid = false;
+			return *this;
+		}
+	}
+	return append(BleScanFilterOpMacPrefix, operands, 1 + operands[0]);
+}
+
+BleScanFilter& BleScanFilter::minRssi(rssi_t rssi) {
+	uint8_t operand = (uint8_t)rssi;
+	return append(BleScanFilterOpMinRssi, &operand, sizeof(operand));
+}
+
+BleScanFilter& BleScanFilter::manufacturerId(uint16_t companyId) {
+	return append(BleScanFilterOpManufacturerId, (uint8_t*)&companyId, sizeof(companyId));
+}
+
+BleScanFilter& BleScanFilter::serviceDataUuid(uuid16_t uuid) {
+	return append(BleScanFilterOpServiceDataUuid, (uint8_t*)&uuid, sizeof(uuid));
+}
+
+BleScanFilter& BleScanFilter::namePrefix(const char* prefix) {
+	uint8_t operands[1 + MAX_BLE_ADV_DATA_LENGTH];
+	uint8_t length = strlen(prefix);
+	if (length > MAX_BLE_ADV_DATA_LENGTH) {
+		_valid = false;
+		return *this;
+	}
+	operands[0] = length;
+	memcpy(operands + 1, prefix, length);
+	return append(BleScanFilterOpNamePrefix, operands, 1 + length);
+}
+
+BleScanFilter& BleScanFilter::orElse() {
+	return append(BleScanFilterOpOr, nullptr, 0);
+}
+
+bool BleScanFilter::valid() const {
+	return _valid;
+}
+
+bool BleScanFilter::matches(const uint8_t* code, const microapp_sdk_ble_scan_event_t& scan, ble_ad_index_t& index) const {
+	if (code[0] == BleScanFilterOpMacPrefix) {
+		// The address from bluenet is in reverse order
+		for (uint8_t i = 0; i < code[1]; ++i) {
+			if (code[2 + i] != scan.address.address[MAC_ADDRESS_LENGTH - 1 - i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+	if (code[0] == BleScanFilterOpMinRssi) {
+		return scan.rssi >= (rssi_t)code[1];
+	}
+	// The other criteria are on the advertisement data, only index it when needed
+	if (index.count == AD_INDEX_NOT_BUILT) {
+		uint8_t size = (scan.size > MAX_BLE_SCAN_DATA_LENGTH) ? MAX_BLE_SCAN_DATA_LENGTH : scan.size;
+		BleScan::buildIndex(scan.data, size, index);
+	}
+	switch (code[0]) {
+		case BleScanFilterOpManufacturerId: {
+			ble_manufacturer_data_t manufacturerData;
+			return BleScan::findManufacturerData(scan.data, index, (code[2] << 8) | code[1], &manufacturerData);
+		}
+		case BleScanFilterOpServiceDataUuid: {
+			ble_service_data_t serviceData;
+			return BleScan::findServiceData(scan.data, index, (code[2] << 8) | code[1], &serviceData);
+		}
+		case BleScanFilterOpNamePrefix: {
+			ble_ad_t ad = BleScan::localName(scan.data, index);
+			return ad.len >= code[1] && memcmp(ad.data, code + 2, code[1]) == 0;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+bool BleScanFilter::matches(const microapp_sdk_ble_scan_event_t& scan) const {
+	if (!_valid) {
+		return false;
+	}
+	ble_ad_index_t index;
+	bool groupMatches = true;
+	for (uint8_t i = 0; i < _size; i += operationSize(_code + i)) {
+		if (_code[i] == BleScanFilterOpOr) {
+			if (groupMatches) {
+				return true;
+			}
+			groupMatches = true;
+			continue;
+		}
+		// Skip the rest of the group once a criterion does not match
+		if (groupMatches && !matches(_code + i, scan, index)) {
+			groupMatches = false;
+		}
+	}
+	return groupMatches;
+}
+
+void BleScanFilter::bluenetFilter(microapp_sdk_ble_scan_filter_t& filter) const {
+	filter.type                    = CS_MICROAPP_SDK_BLE_SCAN_FILTER_NONE;
+	const uint8_t* serviceDataUuid = nullptr;
+	for (uint8_t i = 0; i < _size; i += operationSize(_code + i)) {
+		switch (_code[i]) {
+			case BleScanFilterOpOr: {
+				// Bluenet filters on a single criterion only
+				filter.type = CS_MICROAPP_SDK_BLE_SCAN_FILTER_NONE;
+				return;
+			}
+			case BleScanFilterOpMacPrefix: {
+				// Only a complete address, which is the most selective
+				if (_code[i + 1] == MAC_ADDRESS_LENGTH) {
+					filter.type = CS_MICROAPP_SDK_BLE_SCAN_FILTER_MAC;
+					for (uint8_t j = 0; j < MAC_ADDRESS_LENGTH; ++j) {
+						filter.mac[MAC_ADDRESS_LENGTH - 1 - j] = _code[i + 2 + j];
+					}
+				}
+				break;
+			}
+			case BleScanFilterOpServiceDataUuid: {
+				if (serviceDataUuid == nullptr) {
+					serviceDataUuid = _code + i + 1;
+				}
+				break;
+			}
+			default: break;
+		}
+	}
+	if (filter.type == CS_MICROAPP_SDK_BLE_SCAN_FILTER_NONE && serviceDataUuid != nullptr) {
+		filter.type = CS_MICROAPP_SDK_BLE_SCAN_FILTER_SERVICE_16_BIT;
+		memcpy(&filter.service16bit, serviceDataUuid, sizeof(uuid16_t));
+	}
+}
@@ -0,0 +1,148 @@
+#include <BleScanMerger.h>
+
+static_assert(MAX_BLE_SCAN_DATA_LENGTH >= MAX_BLE_ADV_DATA_LENGTH,
+			  "MAX_BLE_SCAN_DATA_LENGTH should be at least MAX_BLE_ADV_DATA_LENGTH");
+
+/*
+ * Returns whether the scan data has an AD structure of a type.
+ */
+static bool hasAdType(const uint8_t* data, uint8_t size, uint8_t type) {
+	uint8_t offset = 0;
+	while (offset + 1 < size) {
+		uint8_t length = data[offset];
+		if (length == 0 || offset + 1 + length > size) {
+			return false;
+		}
+		if (data[offset + 1] == type) {
+			return true;
+		}
+		offset += 1 + length;
+	}
+	return false;
+}
+
+/*
+ * Returns the size of the scan data up to the end of the last valid AD structure, so that appended AD structures are
+ * not hidden behind padding or a malformed AD structure.
+ */
+static uint8_t validSize(const uint8_t* data, uint8_t size) {
+	uint8_t offset = 0;
+	while (offset + 1 < size) {
+		uint8_t length = data[offset];
+		if (length == 0 || offset + 1 + length > size) {
+			break;
+		}
+		offset += 1 + length;
+	}
+	return offset;
+}
+
+void BleScanMerger::release(ble_scan_merge_entry_t& entry, MergedScanHandler handler) {
+	// Copy first, so that the handler can add scans
+	ble_merged_scan_t merged = entry.merged;
+	entry.used               = false;
+	handler(merged.scan);
+}
+
+uint8_t BleScanMerger::merge(ble_scan_merge_entry_t& entry, const microapp_sdk_ble_scan_event_t& scan, bool append) {
+	microapp_sdk_ble_scan_event_t& merged = entry.merged.scan;
+	uint8_t size                          = (scan.size > MAX_BLE_ADV_DATA_LENGTH) ? MAX_BLE_ADV_DATA_LENGTH : scan.size;
+	// Only compare with the AD structures the entry had before appending
+	uint8_t mergedSize                    = merged.size;
+	uint8_t newTypes                      = 0;
+	uint8_t offset                        = 0;
+	if (append) {
+		merged.size = validSize(merged.data, merged.size);
+	}
+	while (offset + 1 < size) {
+		uint8_t length = scan.data[offset];
+		if (length == 0 || offset + 1 + length > size) {
+			break;
+		}
+		if (!hasAdType(merged.data, mergedSize, scan.data[offset + 1])) {
+			newTypes++;
+			if (append && merged.size + 1 + length <= MAX_BLE_SCAN_DATA_LENGTH) {
+				memcpy(merged.data + merged.size, scan.data + offset, 1 + length);
+				merged.size += 1 + length;
+			}
+		}
+		offset += 1 + length;
+	}
+	return newTypes;
+}
+
+void BleScanMerger::add(const microapp_sdk_ble_scan_event_t& scan, MergedScanHandler handler) {
+	flush(handler);
+	// Entry where the scan will wait
+	ble_scan_merge_entry_t* slot   = nullptr;
+	ble_scan_merge_entry_t* oldest = nullptr;
+	for (uint8_t i = 0; i < MAX_SCAN_MERGE_ENTRIES; ++i) {
+		ble_scan_merge_entry_t& entry = _entries[i];
+		if (!entry.used) {
+			if (slot == nullptr) {
+				slot = &entry;
+			}
+			continue;
+		}
+		if (memcmp(entry.merged.scan.address.address, scan.address.address, MAC_ADDRESS_LENGTH) == 0) {
+			if (merge(entry, scan, false) != 0) {
+				// The scan response of the waiting advertisement
+				merge(entry, scan, true);
+				_mergedCount++;
+				release(entry, handler);
+				return;
+			}
+			// Another advertisement, which takes the place of the waiting one
+			slot = &entry;
+			break;
+		}
+		if (oldest == nullptr || entry.tick < oldest->tick) {
+			oldest = &entry;
+		}
+	}
+	if (slot == nullptr) {
+		// Full: the scan that waited longest is passed on
+		slot = oldest;
+	}
+	// Let the scan wait before passing on the scan it replaces, as the handler may be interrupted by new scans
+	bool replaces              = slot->used;
+	ble_merged_scan_t replaced = slot->merged;
+	// Only copy the data of the scan: it may be a deferred interrupt, which holds no more than that
+	microapp_sdk_ble_scan_event_t& waiting = slot->merged.scan;
+	waiting.address                        = scan.address;
+	waiting.rssi                           = scan.rssi;
+	waiting.channel                        = scan.channel;
+	waiting.size                           = scan.size;
+	if (waiting.size > MAX_BLE_ADV_DATA_LENGTH) {
+		waiting.size = MAX_BLE_ADV_DATA_LENGTH;
+	}
+	memcpy(waiting.data, scan.data, waiting.size);
+	slot->tick = tickCount();
+	slot->used = true;
+	if (replaces) {
+		handler(replaced.scan);
+	}
+}
+
+void BleScanMerger::flush(MergedScanHandler handler, bool all) {
+	uint32_t now = tickCount();
+	for (uint8_t i = 0; i < MAX_SCAN_MERGE_ENTRIES; ++i) {
+		if (_entries[i].used && (all || now - _entries[i].tick > _windowTicks)) {
+			release(_entries[i], handler);
+		}
+	}
+}
+
+void BleScanMerger::clear() {
+	for (uint8_t i = 0; i < MAX_SCAN_MERGE_ENTRIES; ++i) {
+		_entries[i].used = false;
+	}
+}
+
+void BleScanMerger::configure(uint16_t windowTicks) {
+	_windowTicks = windowTicks;
+}
+
+uint32_t BleScanMerger::mergedCount() {
+	return _mergedCount;
+}
@@ -0,0 +1,77 @@
+#include <BleScanQueue.h>
+
+ble_scan_record_t& BleScanQueue::at(uint8_t index) {
+	return _records[(_start + index) % MAX_SCAN_QUEUE_SIZE];
+}
+
+void BleScanQueue::remove(uint8_t index) {
+	for (uint8_t i = index; i + 1 < _count; ++i) {
+		at(i) = at(i + 1);
+	}
+	_count--;
+}
+
+bool BleScanQueue::push(const microapp_sdk_ble_scan_event_t& scan) {
+	if (_count == MAX_SCAN_QUEUE_SIZE) {
+		_droppedCount++;
+		switch (_policy) {
+			case BleScanDropNewest: {
+				return false;
+			}
+			case BleScanKeepStrongest: {
+				uint8_t weakest = 0;
+				for (uint8_t i = 1; i < _count; ++i) {
+					if (at(i).rssi < at(weakest).rssi) {
+						weakest = i;
+					}
+				}
+				if (scan.rssi <= at(weakest).rssi) {
+					return false;
+				}
+				remove(weakest);
+				break;
+			}
+			case BleScanDropOldest:
+			default: {
+				_start = (_start + 1) % MAX_SCAN_QUEUE_SIZE;
+				_count--;
+				break;
+			}
+		}
+	}
+	ble_scan_record_t& record = at(_count);
+	memcpy(record.address, scan.address.address, MAC_ADDRESS_LENGTH);
+	record.addressType = scan.address.type;
+	record.rssi        = scan.rssi;
+	record.size        = (scan.size > MAX_BLE_SCAN_DATA_LENGTH) ? MAX_BLE_SCAN_DATA_LENGTH : scan.size;
+	memcpy(record.data, scan.data, record.size);
+	_count++;
+	return true;
+}
+
+bool BleScanQueue::pop(ble_scan_record_t& record) {
+	if (_count == 0) {
+		return false;
+	}
+	record = at(0);
+	_start = (_start + 1) % MAX_SCAN_QUEUE_SIZE;
+	_count--;
+	return true;
+}
+
+void BleScanQueue::clear() {
+	_start = 0;
+	_count = 0;
+}
+
+uint8_t BleScanQueue::size() {
+	return _count;
+}
+
+void BleScanQueue::setOverflowPolicy(BleScanOverflowPolicy policy) {
+	_policy = policy;
+}
+
+uint16_t BleScanQueue::droppedCount() {
+	return _droppedCount;
+}
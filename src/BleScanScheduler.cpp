@@ -0,0 +1,79 @@
+#include <BleScanScheduler.h>
+
+void BleScanScheduler::adapt(uint32_t received, uint32_t dropped) {
+	// Number of scans the budget allows per cycle, without overflow for long cycles
+	uint32_t cycleMs = (uint32_t)_intervalTicks * MICROAPP_LOOP_INTERVAL_MS;
+	uint32_t allowed = (uint32_t)_maxScansPerSecond * (cycleMs / 1000) + _maxScansPerSecond * (cycleMs % 1000) / 1000;
+	bool overBudget  = (_maxScansPerSecond != 0 && received > allowed);
+	if (dropped != 0 || overBudget) {
+		uint16_t window = _windowTicks / 2;
+		if (overBudget) {
+			// Scale the window to the budget, as the number of scans is about proportional to it
+			uint32_t scaled = _windowTicks * ((allowed > 0xFFFF) ? 0xFFFF : allowed) / received;
+			if (dropped == 0 || scaled < window) {
+				window = scaled;
+			}
+		}
+		_windowTicks = (window == 0) ? 1 : window;
+		_calmCycles  = 0;
+		return;
+	}
+	if (_windowTicks >= _maxWindowTicks) {
+		return;
+	}
+	if (++_calmCycles < SCAN_SCHEDULE_RECOVERY_CYCLES) {
+		return;
+	}
+	_calmCycles = 0;
+	if (_maxScansPerSecond != 0 && received + received / _windowTicks > allowed) {
+		// One more tick would exceed the budget
+		return;
+	}
+	_windowTicks++;
+}
+
+void BleScanScheduler::configure(uint16_t windowTicks, uint16_t intervalTicks, uint16_t maxScansPerSecond) {
+	clear();
+	if (intervalTicks == 0) {
+		return;
+	}
+	if (windowTicks > intervalTicks) {
+		windowTicks = intervalTicks;
+	}
+	_maxWindowTicks    = (windowTicks == 0) ? 1 : windowTicks;
+	_intervalTicks     = intervalTicks;
+	_maxScansPerSecond = maxScansPerSecond;
+	_windowTicks       = _maxWindowTicks;
+}
+
+void BleScanScheduler::clear() {
+	*this = BleScanScheduler();
+}
+
+bool BleScanScheduler::enabled() {
+	return _intervalTicks != 0;
+}
+
+bool BleScanScheduler::tick(uint32_t received, uint32_t dropped) {
+	if (!enabled()) {
+		return true;
+	}
+	if (_cycleTick == 0) {
+		// Unsigned subtraction, so that this works when the counters wrap around
+		if (_started) {
+			adapt(received - _cycleReceived, dropped - _cycleDropped);
+		}
+		_cycleReceived = received;
+		_cycleDropped  = dropped;
+		_started       = true;
+	}
+	bool scanning = (_cycleTick < _windowTicks);
+	if (++_cycleTick >= _intervalTicks) {
+		_cycleTick = 0;
+	}
+	return scanning;
+}
+
+uint16_t BleScanScheduler::windowTicks() {
+	return _windowTicks;
+}
@@ -0,0 +1,45 @@
+#include <BleScanStats.h>
+#include <Profiler.h>
+
+#ifdef MICROAPP_PROFILING
+void BleScanStats::recordHandler(uint32_t start) {
+	// Unsigned subtraction, so that this works when the ticks wrap around
+	uint32_t duration = profilerTicks() - start;
+	if (duration < _handlerMin) {
+		_handlerMin = duration;
+	}
+	if (duration > _handlerMax) {
+		_handlerMax = duration;
+	}
+	if (_handlerSum + duration < _handlerSum) {
+		// Keep the average, without 64-bit division
+		_handlerSum /= 2;
+		_handlerCount /= 2;
+	}
+	_handlerSum += duration;
+	_handlerCount++;
+}
+#endif
+
+void BleScanStats::get(ble_scan_stats_t& stats) {
+	stats.received     = _received;
+	stats.filtered     = _filtered;
+	stats.merged       = 0;
+	stats.deduplicated = _deduplicated;
+	stats.delivered    = _delivered;
+	stats.ticksPerUs   = profilerTicksPerUs();
+	stats.handlerMin   = 0;
+	stats.handlerAvg   = 0;
+	stats.handlerMax   = 0;
+#ifdef MICROAPP_PROFILING
+	if (_handlerCount != 0) {
+		stats.handlerMin = _handlerMin;
+		stats.handlerAvg = _handlerSum / _handlerCount;
+		stats.handlerMax = _handlerMax;
+	}
+#endif
+}
+
+void BleScanStats::reset() {
+	*this = BleScanStats();
+}
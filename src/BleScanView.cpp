@@ -0,0 +1,86 @@
+#include <ArduinoBLE.h>
+#include <BleScanView.h>
+
+const ble_ad_index_t& BleScanView::adIndex() {
+	if (_adIndex.count == AD_INDEX_NOT_BUILT) {
+		BleScan::buildIndex(_scan.data, size(), _adIndex);
+	}
+	return _adIndex;
+}
+
+String BleScanView::address() {
+	MacAddress address(_scan.address.address, MAC_ADDRESS_LENGTH, _scan.address.type);
+	return String(address.string());
+}
+
+const uint8_t* BleScanView::addressBytes() {
+	return _scan.address.address;
+}
+
+uint8_t BleScanView::addressType() {
+	return _scan.address.type;
+}
+
+int8_t BleScanView::rssi() {
+	return _scan.rssi;
+}
+
+const uint8_t* BleScanView::data() {
+	return _scan.data;
+}
+
+uint8_t BleScanView::size() {
+	return (_scan.size > MAX_BLE_SCAN_DATA_LENGTH) ? MAX_BLE_SCAN_DATA_LENGTH : _scan.size;
+}
+
+bool BleScanView::hasLocalName() {
+	return (BleScan::localName(_scan.data, adIndex()).len != 0);
+}
+
+ble_ad_t BleScanView::localName() {
+	return BleScan::localName(_scan.data, adIndex());
+}
+
+bool BleScanView::hasAdvertisedServiceUuid(uuid16_t uuid) {
+	return BleScan::hasServiceUuid(_scan.data, adIndex(), uuid);
+}
+
+uint8_t BleScanView::advertisedServiceUuidCount() {
+	return BleScan::serviceUuidCount(_scan.data, adIndex());
+}
+
+uuid16_t BleScanView::advertisedServiceUuid(uint8_t index) {
+	return BleScan::serviceUuid(_scan.data, adIndex(), index);
+}
+
+uint8_t BleScanView::advertisedServiceUuidCount(uint8_t uuidLength) {
+	return BleScan::serviceUuidCount(_scan.data, adIndex(), uuidLength);
+}
+
+const uint8_t* BleScanView::advertisedServiceUuidBytes(uint8_t uuidLength, uint8_t index) {
+	return BleScan::serviceUuidBytes(_scan.data, adIndex(), uuidLength, index);
+}
+
+bool BleScanView::findServiceData(uuid16_t uuid, ble_service_data_t* foundData) {
+	return BleScan::findServiceData(_scan.data, adIndex(), uuid, foundData);
+}
+
+bool BleScanView::nextServiceData(uint8_t& cursor, ble_service_data_t* foundData) {
+	return BleScan::nextServiceData(_scan.data, adIndex(), cursor, foundData);
+}
+
+bool BleScanView::findManufacturerData(uint16_t companyId, ble_manufacturer_data_t* foundData) {
+	return BleScan::findManufacturerData(_scan.data, adIndex(), companyId, foundData);
+}
+
+bool BleScanView::nextManufacturerData(uint8_t& cursor, ble_manufacturer_data_t* foundData) {
+	return BleScan::nextManufacturerData(_scan.data, adIndex(), cursor, foundData);
+}
+
+bool BleScanView::findAdvertisementDataType(GapAdvType type, ble_ad_t* foundData) {
+	return BleScan::findAdvertisementDataType(_scan.data, adIndex(), type, foundData);
+}
+
+BleDevice& BleScanView::device() {
+	return BLE.setPeripheral(_scan);
+}
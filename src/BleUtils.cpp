@@ -35,3 +35,12 @@ void convertByteToTwoHexChars(uint8_t byte, char* res) {
 		res++;
 	}
 }
+
+uint32_t hashBytes(const uint8_t* data, uint8_t size) {
+	uint32_t result = 2166136261u;
+	for (uint8_t i = 0; i < size; ++i) {
+		result ^= data[i];
+		result *= 16777619u;
+	}
+	return result;
+}
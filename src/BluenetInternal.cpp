@@ -11,6 +11,12 @@
 #include <cs_MicroappStructs.h>
 #include <stdint.h>
 
+/*
+ * Bluenet event interrupts, the id is the bluenet event message type.
+ */
+DEFINE_INTERRUPT_TABLE(
+		bluenetEventInterruptTable, microapp_sdk_bluenet_event_t, type, CS_MICROAPP_SDK_BLUENET_EVENT_EVENT + 1)
+
 BluenetInternalClass::BluenetInternalClass() {
 	for (unsigned int i = 0; i < MAX_SUBSCRIPTIONS; ++i) {
 		_subscribedTypes[i] = 0;
@@ -44,6 +50,7 @@ bool BluenetInternalClass::setEventHandler(BluenetEventHandler eventHandler) {
 		interrupt.type               = CS_MICROAPP_SDK_TYPE_BLUENET_EVENT;
 		interrupt.id                 = CS_MICROAPP_SDK_BLUENET_EVENT_EVENT;
 		interrupt.handler            = handleBluenetInternalInterrupt;
+		interrupt.table              = &bluenetEventInterruptTable;
 		microapp_sdk_result_t result = registerInterrupt(&interrupt);
 		if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
 			// No empty interrupt slots available on microapp side
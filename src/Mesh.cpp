@@ -1,6 +1,11 @@
 #include <Mesh.h>
 #include <Serial.h>
 
+/*
+ * Mesh interrupts, the id is the mesh type.
+ */
+DEFINE_INTERRUPT_TABLE(meshInterruptTable, microapp_sdk_mesh_t, type, CS_MICROAPP_SDK_MESH_READ + 1)
+
 microapp_sdk_result_t handleMeshInterrupt(void* buf) {
 	if (buf == nullptr) {
 		return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
@@ -15,9 +20,10 @@ MeshClass::MeshClass() : _registeredIncomingMeshMsgHandler(nullptr), _stoneId(0)
 bool MeshClass::listen() {
 	// Register soft interrupt locally
 	interrupt_registration_t interrupt;
-	interrupt.type          = CS_MICROAPP_SDK_TYPE_MESH;
-	interrupt.id          = CS_MICROAPP_SDK_MESH_READ;
-	interrupt.handler        = handleMeshInterrupt;
+	interrupt.type               = CS_MICROAPP_SDK_TYPE_MESH;
+	interrupt.id                 = CS_MICROAPP_SDK_MESH_READ;
+	interrupt.handler            = handleMeshInterrupt;
+	interrupt.table              = &meshInterruptTable;
 	microapp_sdk_result_t result = registerInterrupt(&interrupt);
 	if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
 		// No empty interrupt slots available
@@ -10,6 +10,11 @@
 #include <Message.h>
 #include <stdint.h>
 
+/*
+ * Message interrupts, the id is the message type.
+ */
+DEFINE_INTERRUPT_TABLE(messageInterruptTable, microapp_sdk_message_t, type, CS_MICROAPP_SDK_MSG_EVENT_RECEIVED_MSG + 1)
+
 MessageClass::MessageClass() {
 
 }
@@ -29,6 +34,7 @@ bool MessageClass::begin() {
 	interrupt.type               = CS_MICROAPP_SDK_TYPE_MESSAGE;
 	interrupt.id                 = CS_MICROAPP_SDK_MSG_EVENT_RECEIVED_MSG;
 	interrupt.handler            = handleMessageInterrupt;
+	interrupt.table              = &messageInterruptTable;
 	microapp_sdk_result_t result = registerInterrupt(&interrupt);
 	if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
 		// No empty interrupt slots available on microapp side
@@ -0,0 +1,126 @@
+#include <Message.h>
+#include <Profiler.h>
+
+#if !defined(__arm__)
+#include <time.h>
+#endif
+
+#if defined(__arm__)
+// The nRF52 runs at 64 MHz
+static const uint16_t TICKS_PER_US = 64;
+
+// Registers of the debug watchpoint and trace unit, see the ARMv7-M architecture reference manual
+static volatile uint32_t* const DEMCR      = (volatile uint32_t*)0xE000EDFC;
+static volatile uint32_t* const DWT_CTRL   = (volatile uint32_t*)0xE0001000;
+static volatile uint32_t* const DWT_CYCCNT = (volatile uint32_t*)0xE0001004;
+
+static const uint32_t DEMCR_TRCENA         = 1 << 24;
+static const uint32_t DWT_CTRL_CYCCNTENA   = 1 << 0;
+#else
+static const uint16_t TICKS_PER_US = 1000;
+#endif
+
+/*
+ * Histograms of calls and interrupts, indexed by type, and of the loop.
+ */
+struct profiler_t {
+	profiler_histogram_t calls[PROFILER_TYPES];
+	profiler_histogram_t interrupts[PROFILER_TYPES];
+	profiler_histogram_t loop;
+};
+
+static profiler_t profiler;
+
+uint32_t profilerTicks() {
+#if defined(__arm__)
+	if ((*DWT_CTRL & DWT_CTRL_CYCCNTENA) == 0) {
+		// Enable the cycle counter, unless a debugger already did
+		*DEMCR |= DEMCR_TRCENA;
+		*DWT_CYCCNT = 0;
+		*DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+	}
+	return *DWT_CYCCNT;
+#else
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+uint16_t profilerTicksPerUs() {
+	return TICKS_PER_US;
+}
+
+static profiler_histogram_t* getHistogram(ProfilerKind kind, uint8_t type) {
+	switch (kind) {
+		case PROFILER_CALL: return (type < PROFILER_TYPES) ? &profiler.calls[type] : nullptr;
+		case PROFILER_INTERRUPT: return (type < PROFILER_TYPES) ? &profiler.interrupts[type] : nullptr;
+		case PROFILER_LOOP: return (type == 0) ? &profiler.loop : nullptr;
+		default: return nullptr;
+	}
+}
+
+void profilerRecord(ProfilerKind kind, uint8_t type, uint32_t start) {
+	// Unsigned subtraction, so that this works when the ticks wrap around
+	uint32_t duration               = profilerTicks() - start;
+	profiler_histogram_t* histogram = getHistogram(kind, type);
+	if (histogram == nullptr) {
+		return;
+	}
+	// The bucket is given by the number of bits of the duration
+	uint8_t bits   = (duration == 0) ? 0 : 32 - __builtin_clz(duration);
+	uint8_t bucket = (bits <= PROFILER_FIRST_BUCKET_BITS) ? 0 : bits - PROFILER_FIRST_BUCKET_BITS;
+	if (bucket >= PROFILER_BUCKETS) {
+		bucket = PROFILER_BUCKETS - 1;
+	}
+	if (histogram->buckets[bucket] < 0xFFFF) {
+		histogram->buckets[bucket]++;
+	}
+	if (duration > histogram->max) {
+		histogram->max = duration;
+	}
+}
+
+const profiler_histogram_t* profilerHistogram(ProfilerKind kind, uint8_t type) {
+	return getHistogram(kind, type);
+}
+
+void profilerReset() {
+	memset(&profiler, 0, sizeof(profiler));
+}
+
+/*
+ * Send a report of the histogram, if it is not empty.
+ */
+static bool sendReport(ProfilerKind kind, uint8_t type) {
+	profiler_histogram_t* histogram = getHistogram(kind, type);
+	bool empty                      = true;
+	for (uint8_t i = 0; i < PROFILER_BUCKETS; ++i) {
+		if (histogram->buckets[i] != 0) {
+			empty = false;
+			break;
+		}
+	}
+	if (empty) {
+		return false;
+	}
+	profiler_report_t report;
+	report.kind            = kind;
+	report.type            = type;
+	report.ticksPerUs      = TICKS_PER_US;
+	report.bucketCount     = PROFILER_BUCKETS;
+	report.firstBucketBits = PROFILER_FIRST_BUCKET_BITS;
+	// Copy first, as sending the report is a call that is profiled as well
+	report.histogram       = *histogram;
+	return Message.write(&report, sizeof(report)) == sizeof(report);
+}
+
+uint8_t profilerDump() {
+	uint8_t count = 0;
+	for (uint8_t type = 0; type < PROFILER_TYPES; ++type) {
+		count += sendReport(PROFILER_CALL, type);
+		count += sendReport(PROFILER_INTERRUPT, type);
+	}
+	count += sendReport(PROFILER_LOOP, 0);
+	return count;
+}
@@ -0,0 +1,58 @@
+#include <Scheduler.h>
+
+void Task::sleep(uint32_t ms) {
+	// Round up, so that the task sleeps at least the given time
+	uint32_t ticks = (ms + MICROAPP_LOOP_INTERVAL_MS - 1) / MICROAPP_LOOP_INTERVAL_MS;
+	// The tick is incremented after the tasks ran, so this task is resumed after the given number of ticks
+	_wakeTick      = Scheduler._tick + ticks;
+}
+
+Task* SchedulerClass::add(TaskFunction function, void* arg) {
+	if (function == nullptr) {
+		return nullptr;
+	}
+	for (uint8_t i = 0; i < MAX_TASKS; ++i) {
+		Task& task = _tasks[i];
+		if (task._function == nullptr) {
+			task._function    = function;
+			task._arg         = arg;
+			task._resumePoint = 0;
+			task._wakeTick    = _tick;
+			return &task;
+		}
+	}
+	return nullptr;
+}
+
+bool SchedulerClass::remove(Task* task) {
+	if (task < _tasks || task >= _tasks + MAX_TASKS || task->_function == nullptr) {
+		return false;
+	}
+	task->end();
+	return true;
+}
+
+void SchedulerClass::run() {
+	for (uint8_t i = 0; i < MAX_TASKS; ++i) {
+		Task& task = _tasks[i];
+		if (task._function == nullptr) {
+			continue;
+		}
+		// Compare the difference, so that this keeps working when the tick overflows
+		if ((int32_t)(_tick - task._wakeTick) < 0) {
+			continue;
+		}
+		task._function(task);
+	}
+	_tick++;
+}
+
+uint8_t SchedulerClass::count() {
+	uint8_t result = 0;
+	for (uint8_t i = 0; i < MAX_TASKS; ++i) {
+		if (_tasks[i]._function != nullptr) {
+			result++;
+		}
+	}
+	return result;
+}
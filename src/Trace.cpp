@@ -0,0 +1,209 @@
+#include <Message.h>
+#include <Trace.h>
+
+/*
+ * Returns the size of a message, as far as it is used.
+ */
+static microapp_size_t messageSize(const uint8_t* payload) {
+	auto header          = reinterpret_cast<const microapp_sdk_header_t*>(payload);
+	microapp_size_t size = MICROAPP_SDK_MAX_PAYLOAD;
+	switch (header->messageType) {
+		case CS_MICROAPP_SDK_TYPE_LOG: {
+			auto log = reinterpret_cast<const microapp_sdk_log_header_t*>(payload);
+			size     = sizeof(microapp_sdk_log_header_t) + log->size;
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_PIN: size = sizeof(microapp_sdk_pin_t); break;
+		case CS_MICROAPP_SDK_TYPE_SWITCH: size = sizeof(microapp_sdk_switch_t); break;
+		case CS_MICROAPP_SDK_TYPE_SERVICE_DATA: {
+			auto serviceData = reinterpret_cast<const microapp_sdk_service_data_t*>(payload);
+			size             = (serviceData->data - payload) + serviceData->size;
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_BLE: {
+			auto ble = reinterpret_cast<const microapp_sdk_ble_t*>(payload);
+			if (ble->type == CS_MICROAPP_SDK_BLE_SCAN && ble->scan.type == CS_MICROAPP_SDK_BLE_SCAN_EVENT_SCAN) {
+				size = (ble->scan.eventScan.data - payload) + ble->scan.eventScan.size;
+				break;
+			}
+			size = sizeof(microapp_sdk_ble_t);
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_MESH: {
+			auto mesh = reinterpret_cast<const microapp_sdk_mesh_t*>(payload);
+			if (mesh->type == CS_MICROAPP_SDK_MESH_SEND || mesh->type == CS_MICROAPP_SDK_MESH_READ) {
+				size = (mesh->data - payload) + mesh->size;
+				break;
+			}
+			size = sizeof(microapp_sdk_mesh_t);
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_POWER_USAGE: size = sizeof(microapp_sdk_power_usage_t); break;
+		case CS_MICROAPP_SDK_TYPE_PRESENCE: size = sizeof(microapp_sdk_presence_t); break;
+		case CS_MICROAPP_SDK_TYPE_YIELD: size = sizeof(microapp_sdk_yield_t); break;
+		case CS_MICROAPP_SDK_TYPE_MESSAGE: {
+			auto message = reinterpret_cast<const microapp_sdk_message_t*>(payload);
+			if (message->type == CS_MICROAPP_SDK_MSG_REQUEST_SEND_MSG) {
+				size = (message->sendMessage.data - payload) + message->sendMessage.size;
+			}
+			else if (message->type == CS_MICROAPP_SDK_MSG_EVENT_RECEIVED_MSG) {
+				size = (message->receivedMessage.data - payload) + message->receivedMessage.size;
+			}
+			else {
+				size = (message->sendMessage.data - payload);
+			}
+			break;
+		}
+		case CS_MICROAPP_SDK_TYPE_BLUENET_EVENT: {
+			auto event = reinterpret_cast<const microapp_sdk_bluenet_event_t*>(payload);
+			size       = (event->event.data - payload) + event->event.size;
+			break;
+		}
+		case MICROAPP_SDK_TYPE_BATCH: {
+			auto batchHeader = reinterpret_cast<const microapp_sdk_batch_header_t*>(payload);
+			size             = sizeof(microapp_sdk_batch_header_t);
+			for (uint8_t i = 0; i < batchHeader->count && size < MICROAPP_SDK_MAX_PAYLOAD; ++i) {
+				size += 1 + payload[size];
+			}
+			break;
+		}
+		default: break;
+	}
+	return (size > MICROAPP_SDK_MAX_PAYLOAD) ? MICROAPP_SDK_MAX_PAYLOAD : size;
+}
+
+#ifndef MICROAPP_HOST
+/*
+ * Ring buffer of records. The oldest records are removed to make space for new ones.
+ */
+struct trace_buffer_t {
+	uint8_t data[TRACE_BUFFER_SIZE];
+	//! Offset of the oldest record.
+	uint16_t start   = 0;
+	//! Number of bytes in use.
+	uint16_t used    = 0;
+	//! Number of records that were removed to make space, or that did not fit at all.
+	uint16_t dropped = 0;
+};
+
+static trace_buffer_t traceBuffer;
+
+static void ringWrite(uint16_t offset, const uint8_t* data, uint16_t size) {
+	for (uint16_t i = 0; i < size; ++i) {
+		traceBuffer.data[(offset + i) % TRACE_BUFFER_SIZE] = data[i];
+	}
+}
+
+static void ringRead(uint16_t offset, uint8_t* data, uint16_t size) {
+	for (uint16_t i = 0; i < size; ++i) {
+		data[i] = traceBuffer.data[(offset + i) % TRACE_BUFFER_SIZE];
+	}
+}
+
+/*
+ * Returns the size of the oldest record, including its header.
+ */
+static uint16_t oldestRecordSize() {
+	trace_record_header_t header;
+	ringRead(traceBuffer.start, reinterpret_cast<uint8_t*>(&header), sizeof(header));
+	return sizeof(header) + header.size;
+}
+
+static void removeOldestRecord() {
+	uint16_t size     = oldestRecordSize();
+	traceBuffer.start = (traceBuffer.start + size) % TRACE_BUFFER_SIZE;
+	traceBuffer.used -= size;
+}
+#endif
+
+/*
+ * Number of yields so far.
+ */
+static uint16_t traceTick = 0;
+
+/*
+ * Number of requests and responses that are not to be recorded, so that the messages of a dump are not recorded.
+ * Interrupts that arrive during a dump are still recorded.
+ */
+static uint8_t traceSkip = 0;
+
+void traceRecord(TraceKind kind, const uint8_t* payload) {
+	if (traceSkip > 0 && (kind == TRACE_REQUEST || kind == TRACE_RESPONSE)) {
+		traceSkip--;
+		return;
+	}
+	auto messageHeader   = reinterpret_cast<const microapp_sdk_header_t*>(payload);
+	microapp_size_t size = (kind == TRACE_INTERRUPT_RESULT) ? sizeof(microapp_sdk_header_t) : messageSize(payload);
+	if (size > 0xFF) {
+		size = 0xFF;
+	}
+	trace_record_header_t header;
+	header.kind = kind;
+	header.size = size;
+	header.tick = traceTick;
+	if (kind == TRACE_REQUEST && messageHeader->messageType == CS_MICROAPP_SDK_TYPE_YIELD) {
+		// Records after this one are in the next tick
+		traceTick++;
+	}
+#ifdef MICROAPP_HOST
+	traceOutput(reinterpret_cast<uint8_t*>(&header), sizeof(header));
+	traceOutput(payload, size);
+#else
+	uint16_t recordSize = sizeof(header) + size;
+	if (recordSize > TRACE_BUFFER_SIZE) {
+		traceBuffer.dropped++;
+		return;
+	}
+	while (TRACE_BUFFER_SIZE - traceBuffer.used < recordSize) {
+		removeOldestRecord();
+		traceBuffer.dropped++;
+	}
+	uint16_t end = (traceBuffer.start + traceBuffer.used) % TRACE_BUFFER_SIZE;
+	ringWrite(end, reinterpret_cast<uint8_t*>(&header), sizeof(header));
+	ringWrite((end + sizeof(header)) % TRACE_BUFFER_SIZE, payload, size);
+	traceBuffer.used += recordSize;
+#endif
+}
+
+uint16_t traceRead(uint8_t* buffer, uint16_t size) {
+#ifdef MICROAPP_HOST
+	return 0;
+#else
+	uint16_t written = 0;
+	while (traceBuffer.used > 0) {
+		uint16_t recordSize = oldestRecordSize();
+		if (written + recordSize > size) {
+			break;
+		}
+		ringRead(traceBuffer.start, buffer + written, recordSize);
+		written += recordSize;
+		removeOldestRecord();
+	}
+	return written;
+#endif
+}
+
+uint16_t traceDroppedCount() {
+#ifdef MICROAPP_HOST
+	return 0;
+#else
+	return traceBuffer.dropped;
+#endif
+}
+
+uint8_t traceDump() {
+	uint8_t buffer[MICROAPP_SDK_MESSAGE_SEND_MSG_MAX_SIZE];
+	uint8_t count = 0;
+	uint16_t size;
+	while ((size = traceRead(buffer, sizeof(buffer))) > 0) {
+		// Skip the request of the write, and the response to it
+		traceSkip        = 2;
+		uint16_t written = Message.write(buffer, size);
+		traceSkip        = 0;
+		if (written != size) {
+			break;
+		}
+		count++;
+	}
+	return count;
+}
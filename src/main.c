@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <Profiler.h>
 #include <ipc/cs_IpcRamData.h>
 #include <microapp.h>
 
@@ -6,7 +7,7 @@
 extern "C" {
 #endif
 
-#if __SIZEOF_POINTER__ != 4
+#if __SIZEOF_POINTER__ != 4 && !defined(MICROAPP_HOST)
 #warning "Incorrect uintptr_t type"
 #endif
 
@@ -47,7 +48,13 @@ int __attribute__((optimize("O0"))) dummy_main() {
 	setup();
 	signalSetupEnd();
 	while (1) {
+#ifdef MICROAPP_PROFILING
+		uint32_t start = profilerTicks();
 		loop();
+		profilerRecord(PROFILER_LOOP, 0, start);
+#else
+		loop();
+#endif
 		signalLoopEnd();
 	}
 	// will not be reached
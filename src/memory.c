@@ -0,0 +1,159 @@
+#include <microapp.h>
+
+// Important: Do not include <string.h> / <cstring>. This bloats up the binary unnecessary.
+// On Arduino there is the String class. Roll your own functions like strlen, see below.
+
+// The functions below work a 32-bit word at a time where they can. The Cortex-M4 allows unaligned word access, but
+// aligned access is faster, so the destination is aligned first, and the bytes before and after are handled
+// separately.
+
+// Prevent the compiler from replacing the loops below with a call to memset or memcpy, which would call itself.
+#define NO_LIBRARY_CALLS __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+typedef uint32_t word_t;
+
+// Word of which the address does not have to be aligned. Only used where unaligned access is supported.
+struct __attribute__((packed)) unaligned_word_t {
+	word_t value;
+};
+
+static const microapp_size_t WORD_SIZE = sizeof(word_t);
+
+static inline bool isAligned(const void* ptr) {
+	return ((uintptr_t)ptr & (WORD_SIZE - 1)) == 0;
+}
+
+// Whether a word contains a zero byte, see https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
+static inline bool hasZeroByte(word_t word) {
+	return ((word - 0x01010101) & ~word & 0x80808080) != 0;
+}
+
+// returns size MAX_STRING_SIZE for strings that are too long, note that this can still not fit in the payload
+// the actually supported string length depends on the opcode
+// the limit here is just to prevent looping forever
+uint8_t strlen(const char* str) {
+	microapp_size_t i = 0;
+	for (; i < MAX_STRING_SIZE && !isAligned(str + i); ++i) {
+		if (str[i] == 0) {
+			return i;
+		}
+	}
+	// Reading a whole aligned word never crosses into another memory region, even when the string ends within it
+	for (; i + WORD_SIZE <= MAX_STRING_SIZE; i += WORD_SIZE) {
+		if (hasZeroByte(*(const word_t*)(str + i))) {
+			break;
+		}
+	}
+	for (; i < MAX_STRING_SIZE; ++i) {
+		if (str[i] == 0) {
+			return i;
+		}
+	}
+	return MAX_STRING_SIZE;
+}
+
+// compares two buffers of length num, ptr1 and ptr2
+// returns 0 if ptr1 and ptr2 are equal
+// returns -1 if for the first unmatching byte i we have ptr1[i] < ptr2[i]
+// returns 1 if for the first unmatching byte i we have ptr1[i] > ptr2[i]
+int memcmp(const void* ptr1, const void* ptr2, microapp_size_t num) {
+	const uint8_t* p = (const uint8_t*)ptr1;
+	const uint8_t* q = (const uint8_t*)ptr2;
+	if (ptr1 == ptr2) {  // point to the same address
+		return 0;
+	}
+	microapp_size_t i = 0;
+	if (((uintptr_t)p & (WORD_SIZE - 1)) == ((uintptr_t)q & (WORD_SIZE - 1))) {
+		for (; i < num && !isAligned(p + i); ++i) {
+			if (p[i] != q[i]) {
+				return (p[i] < q[i]) ? -1 : 1;
+			}
+		}
+		// Skip equal words, the byte loop below finds the unmatching byte
+		for (; i + WORD_SIZE <= num; i += WORD_SIZE) {
+			if (*(const word_t*)(p + i) != *(const word_t*)(q + i)) {
+				break;
+			}
+		}
+	}
+	for (; i < num; ++i) {
+		if (p[i] != q[i]) {
+			return (p[i] < q[i]) ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+NO_LIBRARY_CALLS void* memcpy(void* dest, const void* src, microapp_size_t num) {
+	const uint8_t* p = (const uint8_t*)src;
+	uint8_t* q       = (uint8_t*)dest;
+	microapp_size_t i = 0;
+	for (; i < num && !isAligned(q + i); ++i) {
+		q[i] = p[i];
+	}
+	if (isAligned(p + i)) {
+		// Unrolled, as most copies are of whole payloads
+		for (; i + 4 * WORD_SIZE <= num; i += 4 * WORD_SIZE) {
+			const word_t* from = (const word_t*)(p + i);
+			word_t* to         = (word_t*)(q + i);
+			to[0]              = from[0];
+			to[1]              = from[1];
+			to[2]              = from[2];
+			to[3]              = from[3];
+		}
+		for (; i + WORD_SIZE <= num; i += WORD_SIZE) {
+			*(word_t*)(q + i) = *(const word_t*)(p + i);
+		}
+	}
+#ifdef __ARM_FEATURE_UNALIGNED
+	else {
+		for (; i + WORD_SIZE <= num; i += WORD_SIZE) {
+			*(word_t*)(q + i) = ((const unaligned_word_t*)(p + i))->value;
+		}
+	}
+#endif
+	for (; i < num; ++i) {
+		q[i] = p[i];
+	}
+	return dest;
+}
+
+NO_LIBRARY_CALLS void* memset(void* dest, int value, microapp_size_t num) {
+	uint8_t* q        = (uint8_t*)dest;
+	uint8_t byte      = (uint8_t)value;
+	microapp_size_t i = 0;
+	for (; i < num && !isAligned(q + i); ++i) {
+		q[i] = byte;
+	}
+	word_t word = byte * (word_t)0x01010101;
+	for (; i + WORD_SIZE <= num; i += WORD_SIZE) {
+		*(word_t*)(q + i) = word;
+	}
+	for (; i < num; ++i) {
+		q[i] = byte;
+	}
+	return dest;
+}
+
+NO_LIBRARY_CALLS void* memmove(void* dest, const void* src, microapp_size_t num) {
+	const uint8_t* p = (const uint8_t*)src;
+	uint8_t* q       = (uint8_t*)dest;
+	if (q <= p || q >= p + num) {
+		// Copying forward only overwrites bytes that have already been read
+		return memcpy(dest, src, num);
+	}
+	// The destination overlaps the end of the source, so copy backward
+	microapp_size_t i = num;
+	for (; i > 0 && !isAligned(q + i); --i) {
+		q[i - 1] = p[i - 1];
+	}
+	if (isAligned(p + i)) {
+		for (; i >= WORD_SIZE; i -= WORD_SIZE) {
+			*(word_t*)(q + i - WORD_SIZE) = *(const word_t*)(p + i - WORD_SIZE);
+		}
+	}
+	for (; i > 0; --i) {
+		q[i - 1] = p[i - 1];
+	}
+	return dest;
+}
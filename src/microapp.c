@@ -1,64 +1,43 @@
+#include <Profiler.h>
+#include <Trace.h>
 #include <ipc/cs_IpcRamData.h>
 #include <microapp.h>
 
-// Define array with soft interrupts
-interrupt_registration_t interruptRegistrations[MAX_INTERRUPT_REGISTRATIONS];
+/*
+ * Number of SDK types that can have interrupts.
+ */
+static const uint8_t MAX_INTERRUPT_TYPES = CS_MICROAPP_SDK_TYPE_BLUENET_EVENT + 1;
+
+/*
+ * Interrupt tables, indexed by SDK type. Only set for types of which an interrupt has been registered.
+ */
+static interrupt_table_t* interruptTables[MAX_INTERRUPT_TYPES];
 
 // Incremental version apart from IPC struct
 const uint8_t MICROAPP_IPC_CURRENT_PROTOCOL_VERSION           = 1;
 
-// Important: Do not include <string.h> / <cstring>. This bloats up the binary unnecessary.
-// On Arduino there is the String class. Roll your own functions like strlen, see below.
-
-// returns size MAX_STRING_SIZE for strings that are too long, note that this can still not fit in the payload
-// the actually supported string length depends on the opcode
-// the limit here is just to prevent looping forever
-uint8_t strlen(const char* str) {
-	for (microapp_size_t i = 0; i < MAX_STRING_SIZE; ++i) {
-		if (str[i] == 0) {
-			return i;
-		}
-	}
-	return MAX_STRING_SIZE;
-}
+/*
+ * Defines how 'deep' nested interrupts can go.
+ * For each level, a set of io buffers is needed, so that the interrupt and the request of the level above are kept.
+ */
+static const uint8_t MAX_INTERRUPT_DEPTH = 3;
 
-// compares two buffers of length num, ptr1 and ptr2
-// returns 0 if ptr1 and ptr2 are equal
-// returns -1 if for the first unmatching byte i we have ptr1[i] < ptr2[i]
-// returns 1 if for the first unmatching byte i we have ptr1[i] > ptr2[i]
-int memcmp(const void* ptr1, const void* ptr2, microapp_size_t num) {
-	char* p = (char*)ptr1;
-	char* q = (char*)ptr2;
-	if (ptr1 == ptr2) {  // point to the same address
-		return 0;
-	}
-	for (microapp_size_t i = 0; i < num; ++i) {
-		if (*(p + i) < *(q + i)) {
-			return -1;
-		}
-		else if (*(p + i) > *(q + i)) {
-			return 1;
-		}
-	}
-	return 0;
-}
+/*
+ * Pool of io buffers, accessible by both bluenet and the microapp.
+ * Index 0 is used by the main context, index i by an interrupt at nesting depth i.
+ * Bluenet is pointed at the buffers of the current depth.
+ */
+static bluenet_io_buffers_t ioBuffers[MAX_INTERRUPT_DEPTH + 1];
 
-void* memcpy(void* dest, const void* src, microapp_size_t num) {
-	uint8_t* p = (uint8_t*)src;
-	uint8_t* q = (uint8_t*)dest;
-	for (microapp_size_t i = 0; i < num; ++i) {
-		*q = *p;
-		p++;
-		q++;
-	}
-	return dest;
-}
+/*
+ * Index in the pool of the io buffers bluenet currently points at. Equals the current interrupt nesting depth.
+ */
+static uint8_t ioBufferIndex = 0;
 
 /*
- * A global object for messages in and out.
- * Accessible by both bluenet and the microapp
+ * Highest value of ioBufferIndex since startup.
  */
-static bluenet_io_buffers_t shared_io_buffers;
+static uint8_t peakIoBufferIndex = 0;
 
 /*
  * A global object for ipc data as well.
@@ -66,48 +45,32 @@ static bluenet_io_buffers_t shared_io_buffers;
 static bluenet_ipc_data_cpp_t ipc_data;
 
 uint8_t* getOutgoingMessagePayload() {
-	return shared_io_buffers.microapp2bluenet.payload;
+	return ioBuffers[ioBufferIndex].microapp2bluenet.payload;
 }
 
 uint8_t* getIncomingMessagePayload() {
-	return shared_io_buffers.bluenet2microapp.payload;
+	return ioBuffers[ioBufferIndex].bluenet2microapp.payload;
 }
 
-/*
- * Struct that stores copies of the shared io buffer
- */
-struct stack_entry_t {
-	bluenet_io_buffers_t ioBuffer;
-	bool filled;
-};
-
-/*
- * Defines how 'deep' nested interrupts can go.
- * For each level, an interrupt buffer and a request buffer are needed to store the state of the level above.
- */
-static const uint8_t MAX_INTERRUPT_DEPTH = 3;
+// Cache whether the IPC ram data from bluenet is valid.
+static bool ipcValid = false;
 
 /*
- * Stack of io buffer copies. For each interrupt layer, the stack grows
+ * Point bluenet at the io buffers with the given index in the pool. This does not yield.
  */
-static stack_entry_t stack[MAX_INTERRUPT_DEPTH];
-
-static bool stack_initialized = false;
-
-// Cache whether the IPC ram data from bluenet is valid.
-static bool ipcValid = false;
+static microapp_sdk_result_t setIoBuffers(uint8_t index) {
+	ioBufferIndex                                    = index;
+	if (index > peakIoBufferIndex) {
+		peakIoBufferIndex = index;
+	}
+	microappCallbackFunc callbackFunctionIntoBluenet = ipc_data.bluenet2microappData.microappCallback;
+	return callbackFunctionIntoBluenet(CS_MICROAPP_CALLBACK_UPDATE_IO_BUFFER, &ioBuffers[index]);
+}
 
 /*
  * Function checkRamData is used in sendMessage.
  */
 microapp_sdk_result_t checkRamData(bool checkOnce) {
-	if (!stack_initialized) {
-		for (int8_t i = 0; i < MAX_INTERRUPT_DEPTH; ++i) {
-			stack[i].filled = false;
-		}
-		stack_initialized = true;
-	}
-
 	if (checkOnce) {
 		// If valid is set, we assume cached values are fine, otherwise load them.
 		if (ipcValid) {
@@ -140,8 +103,7 @@ microapp_sdk_result_t checkRamData(bool checkOnce) {
 
 	if (checkOnce) {
 		// Write the buffer only once
-		microappCallbackFunc callbackFunctionIntoBluenet = ipc_data.bluenet2microappData.microappCallback;
-		result = callbackFunctionIntoBluenet(CS_MICROAPP_CALLBACK_UPDATE_IO_BUFFER, &shared_io_buffers);
+		result = setIoBuffers(ioBufferIndex);
 	}
 	return result;
 }
@@ -150,24 +112,31 @@ microapp_sdk_result_t checkRamData(bool checkOnce) {
  * Returns the number of empty slots for bluenet.
  */
 uint8_t emptySlotsInStack() {
-	uint8_t totalEmpty = 0;
-	for (uint8_t i = 0; i < MAX_INTERRUPT_DEPTH; ++i) {
-		if (!stack[i].filled) {
-			totalEmpty++;
-		}
-	}
-	return totalEmpty;
+	return MAX_INTERRUPT_DEPTH - ioBufferIndex;
 }
 
-int8_t getNextEmptyStackSlot() {
-	for (uint8_t i = 0; i < MAX_INTERRUPT_DEPTH; ++i) {
-		if (!stack[i].filled) {
-			return i;
-		}
+uint8_t peakInterruptDepth() {
+	return peakIoBufferIndex;
+}
+
+/*
+ * Number of interrupts per type that were dropped because all interrupt slots were in use.
+ */
+static uint32_t busyInterrupts[MAX_INTERRUPT_TYPES];
+
+uint32_t busyInterruptCount(MicroappSdkType type) {
+	if (type >= MAX_INTERRUPT_TYPES) {
+		return 0;
 	}
-	return -1;
+	return busyInterrupts[type];
 }
 
+static microapp_sdk_result_t signalBluenet();
+static microapp_sdk_result_t callBluenet();
+#ifdef MICROAPP_DEFERRED_INTERRUPTS
+static bool queueInterrupt(microapp_sdk_header_t* header);
+#endif
+
 /*
  * Handle incoming interrupts from bluenet
  */
@@ -179,64 +148,83 @@ void handleBluenetInterrupt() {
 		// No request, so this is not an interrupt
 		return;
 	}
+#ifdef MICROAPP_TRACING
+	traceRecord(TRACE_INTERRUPT, incomingPayload);
+#endif
+#ifdef MICROAPP_DEFERRED_INTERRUPTS
+	// Interrupts of types that are deferred are only copied to the interrupt queue, this does not take a slot.
+	// Loop instead of recursing via callBluenet(), so that a burst of them does not grow the stack.
+	while (queueInterrupt(incomingHeader)) {
+#ifdef MICROAPP_TRACING
+		traceRecord(TRACE_INTERRUPT_RESULT, incomingPayload);
+#endif
+		signalBluenet();
+		if (incomingHeader->ack != CS_MICROAPP_SDK_ACK_REQUEST) {
+			return;
+		}
+#ifdef MICROAPP_TRACING
+		traceRecord(TRACE_INTERRUPT, incomingPayload);
+#endif
+	}
+#endif
 	// Check if we have the capacity to handle another interrupt
-	int8_t emptySlots = emptySlotsInStack();
-	if (emptySlots == 0) {
+	if (emptySlotsInStack() == 0) {
 		// Max depth has been reached, drop the interrupt and return
+		uint8_t type = incomingHeader->messageType;
+		if (type < MAX_INTERRUPT_TYPES) {
+			busyInterrupts[type]++;
+		}
 		incomingHeader->ack = CS_MICROAPP_SDK_ACK_ERR_BUSY;
+#ifdef MICROAPP_TRACING
+		traceRecord(TRACE_INTERRUPT_RESULT, incomingPayload);
+#endif
 		// Yield to bluenet, without writing in the outgoing buffer.
 		// Bluenet will check the written ack field
-		sendMessage();
+		callBluenet();
 		return;
 	}
-	// Get the index of the first empty stack slot
-	int8_t stackIndex = getNextEmptyStackSlot();
-	if (stackIndex < 0) {
-		// Apparently there was no space. Should not happen since we just checked
-		// In any case, let's just drop and return similarly to above
-		incomingHeader->ack = CS_MICROAPP_SDK_ACK_ERR_BUSY;
-		sendMessage();
-		return;
-	}
-	// Copy the shared buffers to the top of the stack
-	stack_entry_t* newStackEntry = &stack[stackIndex];
-	uint8_t* outgoingPayload     = getOutgoingMessagePayload();
-	// Copying the outgoing buffer is needed so that the outgoing buffer can be freely used
-	// for microapp requests during the interrupt handling
-	memcpy(newStackEntry->ioBuffer.microapp2bluenet.payload, outgoingPayload, MICROAPP_SDK_MAX_PAYLOAD);
-	// Copying the incoming buffer is needed so that the interrupt payload is preserved
-	// if bluenet generates another interrupt before finishing handling this one
-	memcpy(newStackEntry->ioBuffer.bluenet2microapp.payload, incomingPayload, MICROAPP_SDK_MAX_PAYLOAD);
-	newStackEntry->filled = true;
+	// Instead of copying the buffers to a stack, point bluenet at the next set of buffers in the pool.
+	// This leaves the outgoing buffer of this level untouched while the interrupt handler makes requests,
+	// and preserves the interrupt payload if bluenet generates another interrupt before finishing handling this one.
+	uint8_t index                       = ioBufferIndex;
+	microapp_sdk_header_t* nestedHeader =
+			reinterpret_cast<microapp_sdk_header_t*>(ioBuffers[index + 1].bluenet2microapp.payload);
+	*nestedHeader = *incomingHeader;
 
 	// Mark the incoming ack as 'in progress' so bluenet will keep calling
+	// Bluenet checks the ack in the buffers it points at, so set it in both
 	incomingHeader->ack = CS_MICROAPP_SDK_ACK_IN_PROGRESS;
+	nestedHeader->ack   = CS_MICROAPP_SDK_ACK_IN_PROGRESS;
+	setIoBuffers(index + 1);
 
 	// Now the interrupt will actually be handled
-	// Call the interrupt handler and pass a pointer to the copy of the interrupt buffer
 	// Note that new sendMessage calls may occur in the interrupt handler
-	microapp_sdk_header_t* stackEntryHeader =
-			reinterpret_cast<microapp_sdk_header_t*>(newStackEntry->ioBuffer.bluenet2microapp.payload);
-	microapp_sdk_result_t result = handleInterrupt(stackEntryHeader);
-
-	// When done with the interrupt handling, we can pop the buffers from the stack again
-	// Though really we only need the outgoing buffer, since we just finished dealing with the incoming buffer
-	memcpy(outgoingPayload, newStackEntry->ioBuffer.microapp2bluenet.payload, MICROAPP_SDK_MAX_PAYLOAD);
-	newStackEntry->filled = false;
-
-	// End with a sendMessage call which yields back to bluenet
+#ifdef MICROAPP_PROFILING
+	uint8_t type   = incomingHeader->messageType;
+	uint32_t start = profilerTicks();
+#endif
+	microapp_sdk_result_t result = handleInterrupt(incomingHeader);
+#ifdef MICROAPP_PROFILING
+	profilerRecord(PROFILER_INTERRUPT, type, start);
+#endif
+
+	// When done with the interrupt handling, point bluenet back at the buffers of the level above
+	setIoBuffers(index);
+
+	// End with a yield to bluenet
 	// Bluenet will see the acknowledge and not call again
 	incomingHeader->ack = result;
-	sendMessage();
+#ifdef MICROAPP_TRACING
+	traceRecord(TRACE_INTERRUPT_RESULT, incomingPayload);
+#endif
+	callBluenet();
 	return;
 }
 
 /*
- * Send the actual message to bluenet
- *
- * If there are no interrupts it will just return and at some later time be called again.
+ * Yield to bluenet with whatever is in the outgoing buffer, without handling interrupts.
  */
-microapp_sdk_result_t sendMessage() {
+static microapp_sdk_result_t signalBluenet() {
 	bool checkOnce           = true;
 	microapp_sdk_result_t result = checkRamData(checkOnce);
 	if (result != CS_MICROAPP_SDK_ACK_SUCCESS) {
@@ -246,7 +234,44 @@ microapp_sdk_result_t sendMessage() {
 	// The callback will yield control to bluenet.
 	microappCallbackFunc callbackFunctionIntoBluenet = ipc_data.bluenet2microappData.microappCallback;
 	uint8_t opcode = checkOnce ? CS_MICROAPP_CALLBACK_SIGNAL : CS_MICROAPP_CALLBACK_UPDATE_IO_BUFFER;
-	result         = callbackFunctionIntoBluenet(opcode, &shared_io_buffers);
+	return callbackFunctionIntoBluenet(opcode, &ioBuffers[ioBufferIndex]);
+}
+
+/*
+ * Yield to bluenet with whatever is in the outgoing buffer, and handle interrupts once bluenet hands back control.
+ */
+static microapp_sdk_result_t callBluenet() {
+#ifdef MICROAPP_PROFILING
+	// Only time new requests, not yields or acks of interrupts
+	microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(getOutgoingMessagePayload());
+	bool isRequest = header->ack == CS_MICROAPP_SDK_ACK_REQUEST && header->messageType != CS_MICROAPP_SDK_TYPE_YIELD;
+	uint8_t type   = header->messageType;
+	uint32_t start = profilerTicks();
+#endif
+#ifdef MICROAPP_TRACING
+	// Yields are recorded by sendMessage(), as the outgoing buffer still has the yield when acking an interrupt
+	uint8_t* outgoingPayload            = getOutgoingMessagePayload();
+	microapp_sdk_header_t* tracedHeader = reinterpret_cast<microapp_sdk_header_t*>(outgoingPayload);
+	bool isTraced                       = tracedHeader->ack == CS_MICROAPP_SDK_ACK_REQUEST
+					&& tracedHeader->messageType != CS_MICROAPP_SDK_TYPE_YIELD;
+	if (isTraced) {
+		traceRecord(TRACE_REQUEST, outgoingPayload);
+	}
+#endif
+	microapp_sdk_result_t result = signalBluenet();
+#ifdef MICROAPP_PROFILING
+	if (isRequest) {
+		profilerRecord(PROFILER_CALL, type, start);
+	}
+#endif
+#ifdef MICROAPP_TRACING
+	if (isTraced) {
+		traceRecord(TRACE_RESPONSE, outgoingPayload);
+	}
+#endif
+	if (!ipcValid) {
+		return result;
+	}
 
 	// Here the microapp resumes execution, check for incoming interrupts
 	handleBluenetInterrupt();
@@ -254,86 +279,710 @@ microapp_sdk_result_t sendMessage() {
 	return result;
 }
 
-microapp_sdk_result_t registerInterrupt(interrupt_registration_t* interrupt) {
-	for (int i = 0; i < MAX_INTERRUPT_REGISTRATIONS; ++i) {
-		if (!interruptRegistrations[i].registered) {
-			interruptRegistrations[i].registered = true;
-			interruptRegistrations[i].handler    = interrupt->handler;
-			interruptRegistrations[i].type       = interrupt->type;
-			interruptRegistrations[i].id         = interrupt->id;
-			return CS_MICROAPP_SDK_ACK_SUCCESS;
+#if defined(MICROAPP_BATCHING) || defined(MICROAPP_DEFERRED_CALLS)
+/*
+ * Requests that are queued to be sent later, in the format of a batch message.
+ */
+struct request_queue_t {
+	//! Number of queued requests.
+	uint8_t count = 0;
+	//! Number of bytes in the buffer, including the batch header.
+	microapp_size_t size = sizeof(microapp_sdk_batch_header_t);
+	uint8_t buffer[MICROAPP_SDK_MAX_PAYLOAD];
+};
+
+/*
+ * Cleared when bluenet turns out not to know the batch message type.
+ */
+static bool batchSupported = true;
+#endif
+
+#ifdef MICROAPP_BATCHING
+/*
+ * State of the request batch.
+ */
+struct batch_t {
+	//! Whether beginBatch() has been called, and commitBatch() not yet.
+	bool open = false;
+	//! Number of requests sent with the last committed batch.
+	uint8_t sentCount = 0;
+	//! Acks of the requests sent with the last committed batch.
+	microapp_sdk_result_t acks[MAX_BATCH_ENTRIES];
+	//! The queued requests.
+	request_queue_t queue;
+};
+
+static batch_t batch;
+#endif
+
+#ifdef MICROAPP_DEFERRED_CALLS
+/*
+ * Low priority requests that are deferred to the next tick.
+ */
+static request_queue_t deferredQueue;
+
+/*
+ * Number of calls per tick that are kept free for calls that are not low priority.
+ */
+static uint8_t callReserve = 0;
+#endif
+
+/*
+ * Number of calls made to bluenet in the current tick, from the main context.
+ */
+static uint8_t callsThisTick = 0;
+
+/*
+ * Number of ticks since startup.
+ */
+static uint32_t ticks = 0;
+
+/*
+ * Function that is called at the start of each tick, see setTickHandler().
+ */
+static tickFunction tickHandler = nullptr;
+
+/*
+ * Function of the SDK that is called at the start of each tick, see setInternalTickHandler().
+ */
+static tickFunction internalTickHandler = nullptr;
+
+/*
+ * Keep up a call to bluenet from the main context.
+ */
+static void countCall() {
+	if (callsThisTick >= MAX_CALLS_PER_TICK) {
+		// Bluenet pauses the microapp until the next tick before it handles this call
+		callsThisTick = 0;
+		ticks++;
+	}
+	callsThisTick++;
+}
+
+uint32_t tickCount() {
+	return ticks;
+}
+
+void setTickHandler(tickFunction handler) {
+	tickHandler = handler;
+}
+
+void setInternalTickHandler(tickFunction handler) {
+	internalTickHandler = handler;
+}
+
+uint8_t remainingCallsThisTick() {
+	if (callsThisTick >= MAX_CALLS_PER_TICK) {
+		return 0;
+	}
+	return MAX_CALLS_PER_TICK - callsThisTick;
+}
+
+#if defined(MICROAPP_BATCHING) || defined(MICROAPP_DEFERRED_CALLS)
+/*
+ * Returns the size of the request in the payload if it can be batched, and 0 otherwise.
+ * Only requests of which the caller does not need anything back from bluenet can be batched.
+ */
+static microapp_size_t batchEntrySize(uint8_t* payload) {
+	microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(payload);
+	if (header->ack != CS_MICROAPP_SDK_ACK_REQUEST) {
+		return 0;
+	}
+	switch (header->messageType) {
+		case CS_MICROAPP_SDK_TYPE_LOG: {
+			auto logRequest = reinterpret_cast<microapp_sdk_log_header_t*>(payload);
+			return sizeof(microapp_sdk_log_header_t) + logRequest->size;
+		}
+		case CS_MICROAPP_SDK_TYPE_PIN: {
+			auto pinRequest = reinterpret_cast<microapp_sdk_pin_t*>(payload);
+			if (pinRequest->type != CS_MICROAPP_SDK_PIN_ACTION || pinRequest->action != CS_MICROAPP_SDK_PIN_WRITE) {
+				return 0;
+			}
+			return sizeof(microapp_sdk_pin_t);
+		}
+		case CS_MICROAPP_SDK_TYPE_SWITCH: {
+			auto switchRequest = reinterpret_cast<microapp_sdk_switch_t*>(payload);
+			if (switchRequest->type != CS_MICROAPP_SDK_SWITCH_REQUEST_SET) {
+				return 0;
+			}
+			return sizeof(microapp_sdk_switch_t);
+		}
+		case CS_MICROAPP_SDK_TYPE_SERVICE_DATA: {
+			auto serviceData = reinterpret_cast<microapp_sdk_service_data_t*>(payload);
+			return (serviceData->data - payload) + serviceData->size;
+		}
+		case CS_MICROAPP_SDK_TYPE_MESH: {
+			auto meshRequest = reinterpret_cast<microapp_sdk_mesh_t*>(payload);
+			if (meshRequest->type != CS_MICROAPP_SDK_MESH_SEND) {
+				return 0;
+			}
+			return (meshRequest->data - payload) + meshRequest->size;
+		}
+		case CS_MICROAPP_SDK_TYPE_MESSAGE: {
+			auto messageRequest = reinterpret_cast<microapp_sdk_message_t*>(payload);
+			if (messageRequest->type != CS_MICROAPP_SDK_MSG_REQUEST_SEND_MSG) {
+				return 0;
+			}
+			return (messageRequest->sendMessage.data - payload) + messageRequest->sendMessage.size;
+		}
+		default: {
+			return 0;
 		}
 	}
-	return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
 }
+#endif
 
-microapp_sdk_result_t removeInterruptRegistration(MicroappSdkType type, uint8_t id) {
-	for (int i = 0; i < MAX_INTERRUPT_REGISTRATIONS; ++i) {
-		if (!interruptRegistrations[i].registered) {
-			continue;
+#ifdef MICROAPP_DEFERRED_CALLS
+/*
+ * Whether the request in the payload is of low priority: nothing depends on it being handled in this tick.
+ */
+static bool isLowPriority(uint8_t* payload) {
+	microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(payload);
+	switch (header->messageType) {
+		case CS_MICROAPP_SDK_TYPE_LOG:
+		case CS_MICROAPP_SDK_TYPE_SERVICE_DATA: return true;
+		default: return false;
+	}
+}
+#endif
+
+/*
+ * Whether the request in the payload is a yield, after which bluenet resumes the microapp in a new tick.
+ */
+static bool isYield(uint8_t* payload) {
+	microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(payload);
+	return header->messageType == CS_MICROAPP_SDK_TYPE_YIELD;
+}
+
+#if defined(MICROAPP_BATCHING) || defined(MICROAPP_DEFERRED_CALLS)
+/*
+ * Exchange the contents of two buffers.
+ */
+static void swapBuffers(uint8_t* a, uint8_t* b, microapp_size_t size) {
+	for (microapp_size_t i = 0; i < size; ++i) {
+		uint8_t tmp = a[i];
+		a[i]        = b[i];
+		b[i]        = tmp;
+	}
+}
+
+/*
+ * Send queued requests to bluenet, as a single batch message if bluenet supports it. When bluenet does not handle
+ * the batch, the requests are sent one by one.
+ *
+ * The queued requests are swapped with the start of the outgoing buffer instead of copied, so that a request that is
+ * still in the outgoing buffer is there again afterwards.
+ *
+ * @param[in] queue      The queue to send. Sent requests are removed from it.
+ * @param[out] acks      The ack of each sent request, or a null pointer.
+ * @param[in] maxCalls   When batches are not supported, the maximum number of requests to send one by one.
+ *                       The requests that were not sent stay queued.
+ */
+static microapp_sdk_result_t flushQueue(request_queue_t& queue, microapp_sdk_result_t* acks, uint8_t maxCalls) {
+	if (queue.count == 0) {
+		return CS_MICROAPP_SDK_ACK_SUCCESS;
+	}
+	uint8_t* outgoingPayload = getOutgoingMessagePayload();
+
+	microapp_sdk_batch_header_t* batchHeader = reinterpret_cast<microapp_sdk_batch_header_t*>(queue.buffer);
+	bool oneByOne                            = !batchSupported;
+	if (batchSupported) {
+		batchHeader->header.messageType = MICROAPP_SDK_TYPE_BATCH;
+		batchHeader->header.ack         = CS_MICROAPP_SDK_ACK_REQUEST;
+		batchHeader->count              = queue.count;
+		countCall();
+		swapBuffers(queue.buffer, outgoingPayload, queue.size);
+		callBluenet();
+		swapBuffers(queue.buffer, outgoingPayload, queue.size);
+		switch (batchHeader->header.ack) {
+			case CS_MICROAPP_SDK_ACK_SUCCESS: break;
+			case CS_MICROAPP_SDK_ACK_REQUEST:
+			case CS_MICROAPP_SDK_ACK_ERR_UNDEFINED:
+			case CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED: {
+				// Bluenet does not know batches, fall back to sending the requests one by one from now on
+				batchSupported = false;
+				oneByOne       = true;
+				break;
+			}
+			default: {
+				// Bluenet did not handle the batch, for example because it is busy: send the requests one by one instead
+				oneByOne = true;
+				break;
+			}
 		}
-		if (interruptRegistrations[i].type == type && interruptRegistrations[i].id == id) {
-			interruptRegistrations[i].registered = false;
-			return CS_MICROAPP_SDK_ACK_SUCCESS;
+	}
+
+	microapp_sdk_result_t result = CS_MICROAPP_SDK_ACK_SUCCESS;
+	microapp_size_t offset       = sizeof(microapp_sdk_batch_header_t);
+	uint8_t sent                 = 0;
+	for (; sent < queue.count; ++sent) {
+		microapp_size_t entrySize     = queue.buffer[offset];
+		uint8_t* entry                = &queue.buffer[offset + 1];
+		microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(entry);
+		if (oneByOne) {
+			if (sent >= maxCalls) {
+				break;
+			}
+			// Bluenet may have written an ack in the refused batch
+			header->ack = CS_MICROAPP_SDK_ACK_REQUEST;
+			countCall();
+			swapBuffers(entry, outgoingPayload, entrySize);
+			callBluenet();
+			swapBuffers(entry, outgoingPayload, entrySize);
+		}
+		microapp_sdk_result_t ack = (microapp_sdk_result_t)header->ack;
+		if (acks != nullptr) {
+			acks[sent] = ack;
 		}
+		if (result == CS_MICROAPP_SDK_ACK_SUCCESS && ack != CS_MICROAPP_SDK_ACK_SUCCESS) {
+			result = ack;
+		}
+		offset += 1 + entrySize;
+	}
+	// Keep the requests that were not sent
+	microapp_size_t remainingSize = queue.size - offset;
+	memmove(&queue.buffer[sizeof(microapp_sdk_batch_header_t)], &queue.buffer[offset], remainingSize);
+	queue.count -= sent;
+	queue.size = sizeof(microapp_sdk_batch_header_t) + remainingSize;
+	return result;
+}
+#endif
+
+#ifdef MICROAPP_BATCHING
+/*
+ * Send all queued requests of the batch to bluenet.
+ */
+static microapp_sdk_result_t flushBatch() {
+	batch.sentCount = batch.queue.count;
+	return flushQueue(batch.queue, batch.acks, MAX_BATCH_ENTRIES);
+}
+#endif
+
+#ifdef MICROAPP_DEFERRED_CALLS
+/*
+ * Send the deferred requests, as far as they fit in the calls of this tick that are not reserved.
+ */
+static void flushDeferred() {
+	uint8_t remaining = remainingCallsThisTick();
+	flushQueue(deferredQueue, nullptr, (remaining > callReserve) ? remaining - callReserve : 0);
+}
+#endif
+
+#if defined(MICROAPP_BATCHING) || defined(MICROAPP_DEFERRED_CALLS)
+/*
+ * Append the request in the outgoing buffer to a queue.
+ *
+ * @return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED if the request cannot be queued
+ * @return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE if the queue is full
+ */
+static microapp_sdk_result_t queueRequest(request_queue_t& queue) {
+	uint8_t* outgoingPayload  = getOutgoingMessagePayload();
+	microapp_size_t entrySize = batchEntrySize(outgoingPayload);
+	if (entrySize == 0) {
+		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+	}
+	if (queue.count >= MAX_BATCH_ENTRIES || queue.size + 1 + entrySize > MICROAPP_SDK_MAX_PAYLOAD) {
+		return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+	}
+	queue.buffer[queue.size] = entrySize;
+	memcpy(&queue.buffer[queue.size + 1], outgoingPayload, entrySize);
+	queue.size += 1 + entrySize;
+	queue.count++;
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+#endif
+
+#ifdef MICROAPP_BATCHING
+/*
+ * Append the request in the outgoing buffer to the batch.
+ */
+static microapp_sdk_result_t queueBatchEntry() {
+	microapp_sdk_result_t result = queueRequest(batch.queue);
+	if (result == CS_MICROAPP_SDK_ACK_ERR_NO_SPACE) {
+		// The batch is full, send it and start a new one
+		flushBatch();
+		result = queueRequest(batch.queue);
+	}
+	return result;
+}
+
+microapp_sdk_result_t beginBatch() {
+	if (batch.open) {
+		return CS_MICROAPP_SDK_ACK_ERR_ALREADY_EXISTS;
+	}
+	batch.open = true;
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+microapp_sdk_result_t commitBatch() {
+	if (!batch.open) {
+		return CS_MICROAPP_SDK_ACK_ERR_EMPTY;
+	}
+	batch.open = false;
+	return flushBatch();
+}
+
+uint8_t batchSize() {
+	return batch.sentCount;
+}
+
+microapp_sdk_result_t batchResult(uint8_t index) {
+	if (index >= batch.sentCount) {
+		return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
 	}
+	return batch.acks[index];
+}
+#else
+microapp_sdk_result_t beginBatch() {
+	return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED;
+}
+
+microapp_sdk_result_t commitBatch() {
+	return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED;
+}
+
+uint8_t batchSize() {
+	return 0;
+}
+
+microapp_sdk_result_t batchResult(uint8_t index) {
 	return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
 }
+#endif
 
-microapp_sdk_result_t callInterrupt(MicroappSdkType type, uint8_t id, microapp_sdk_header_t* interruptHeader) {
-	for (int i = 0; i < MAX_INTERRUPT_REGISTRATIONS; ++i) {
-		if (!interruptRegistrations[i].registered) {
-			continue;
+#ifdef MICROAPP_DEFERRED_CALLS
+microapp_sdk_result_t reserveCallsPerTick(uint8_t count) {
+	if (count >= MAX_CALLS_PER_TICK) {
+		return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+	}
+	callReserve = count;
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+uint8_t deferredCallCount() {
+	return deferredQueue.count;
+}
+#else
+microapp_sdk_result_t reserveCallsPerTick(uint8_t count) {
+	return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED;
+}
+
+uint8_t deferredCallCount() {
+	return 0;
+}
+#endif
+
+/*
+ * Send the actual message to bluenet
+ *
+ * If there are no interrupts it will just return and at some later time be called again.
+ * While a batch is open, requests that can be batched are queued instead.
+ * Low priority requests are deferred to the next tick when they would use a reserved call.
+ */
+microapp_sdk_result_t sendMessage() {
+	if (emptySlotsInStack() != MAX_INTERRUPT_DEPTH) {
+		// Requests from interrupt handlers are sent right away
+		bool yield = isYield(getOutgoingMessagePayload());
+#ifdef MICROAPP_TRACING
+		if (yield) {
+			traceRecord(TRACE_REQUEST, getOutgoingMessagePayload());
 		}
-		if (interruptRegistrations[i].type != type) {
-			continue;
+#endif
+		microapp_sdk_result_t result = callBluenet();
+		if (yield) {
+			// Bluenet resumed the microapp in a new tick
+			ticks++;
 		}
-		if (interruptRegistrations[i].id == id) {
-			if (interruptRegistrations[i].handler) {
-				return interruptRegistrations[i].handler(interruptHeader);
-			}
-			// Handler does not exist
-			return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
+		return result;
+	}
+#ifdef MICROAPP_BATCHING
+	if (batch.open) {
+		if (queueBatchEntry() == CS_MICROAPP_SDK_ACK_SUCCESS) {
+			return CS_MICROAPP_SDK_ACK_SUCCESS;
 		}
+		// This request needs its result right away, so send what has been queued before it first
+		flushBatch();
 	}
-	// No soft interrupt of this type with this id registered
-	return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
+#endif
+	uint8_t* outgoingPayload = getOutgoingMessagePayload();
+	if (isYield(outgoingPayload)) {
+#ifdef MICROAPP_TRACING
+		traceRecord(TRACE_REQUEST, outgoingPayload);
+#endif
+		microapp_sdk_result_t result = callBluenet();
+		// Bluenet resumed the microapp in a new tick, start with the requests and interrupts that were deferred
+		callsThisTick = 0;
+		ticks++;
+#ifdef MICROAPP_DEFERRED_CALLS
+		flushDeferred();
+#endif
+		drainInterrupts();
+		if (internalTickHandler != nullptr) {
+			internalTickHandler();
+		}
+		if (tickHandler != nullptr) {
+			tickHandler();
+		}
+		return result;
+	}
+#ifdef MICROAPP_DEFERRED_CALLS
+	if (callReserve > 0 && isLowPriority(outgoingPayload) && remainingCallsThisTick() <= callReserve) {
+		if (queueRequest(deferredQueue) == CS_MICROAPP_SDK_ACK_SUCCESS) {
+			return CS_MICROAPP_SDK_ACK_SUCCESS;
+		}
+		// The deferred queue is full, send it right away after all
+	}
+#endif
+	countCall();
+	return callBluenet();
+}
+
+microapp_sdk_result_t registerInterrupt(interrupt_registration_t* interrupt) {
+	if (interrupt->type >= MAX_INTERRUPT_TYPES || interrupt->table == nullptr) {
+		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+	}
+	if (interruptTables[interrupt->type] == nullptr) {
+		interruptTables[interrupt->type] = interrupt->table;
+	}
+	interrupt_table_t* table = interruptTables[interrupt->type];
+	if (table != interrupt->table) {
+		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+	}
+	if (interrupt->id >= table->size) {
+		return CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+	}
+	if (table->handlers[interrupt->id] != nullptr) {
+		return CS_MICROAPP_SDK_ACK_ERR_ALREADY_EXISTS;
+	}
+	table->handlers[interrupt->id] = interrupt->handler;
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+/*
+ * Get the interrupt table of a type, or a null pointer if no interrupt of this type has ever been registered.
+ */
+static interrupt_table_t* getInterruptTable(uint8_t type) {
+	if (type >= MAX_INTERRUPT_TYPES) {
+		return nullptr;
+	}
+	return interruptTables[type];
+}
+
+microapp_sdk_result_t removeInterruptRegistration(MicroappSdkType type, uint8_t id) {
+	interrupt_table_t* table = getInterruptTable(type);
+	if (table == nullptr || id >= table->size || table->handlers[id] == nullptr) {
+		return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
+	}
+	table->handlers[id] = nullptr;
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
 }
 
 microapp_sdk_result_t handleInterrupt(microapp_sdk_header_t* interruptHeader) {
-	// For all possible interrupt types, get the id from the incoming message
-	uint8_t id;
-	switch (interruptHeader->messageType) {
+	if (interruptHeader->messageType >= MAX_INTERRUPT_TYPES) {
+		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+	}
+	interrupt_table_t* table = getInterruptTable(interruptHeader->messageType);
+	if (table == nullptr) {
+		// No soft interrupt of this type registered
+		return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
+	}
+	// The table knows where the id is in messages of its type
+	uint8_t id = reinterpret_cast<uint8_t*>(interruptHeader)[table->idOffset];
+	if (id >= table->size || table->handlers[id] == nullptr) {
+		// No soft interrupt of this type with this id registered
+		return CS_MICROAPP_SDK_ACK_ERR_NOT_FOUND;
+	}
+	return table->handlers[id](interruptHeader);
+}
+
+#ifdef MICROAPP_DEFERRED_INTERRUPTS
+/*
+ * Queue of deferred interrupts.
+ *
+ * Each entry is a size byte followed by the interrupt message. Entries are never split over the end of the buffer:
+ * when an entry does not fit before the end, the rest of the buffer is skipped, marked with a size of 0.
+ */
+struct interrupt_queue_t {
+	uint8_t buffer[INTERRUPT_QUEUE_SIZE];
+	//! Index of the first entry.
+	microapp_size_t head = 0;
+	//! Index where the next entry will be written.
+	microapp_size_t tail = 0;
+	//! Number of bytes in use, including skipped bytes.
+	microapp_size_t used = 0;
+	//! Maximum number of queued interrupts per type, 0 when interrupts of that type are not deferred.
+	uint8_t quota[MAX_INTERRUPT_TYPES];
+	//! Number of queued interrupts per type.
+	uint8_t count[MAX_INTERRUPT_TYPES];
+	//! Number of dropped interrupts per type, wraps around.
+	uint32_t dropped[MAX_INTERRUPT_TYPES];
+	//! Set while the queue is being drained.
+	bool draining = false;
+};
+
+static interrupt_queue_t interruptQueue;
+
+/*
+ * Returns the size of the interrupt message if it can be deferred, and 0 otherwise.
+ * Interrupts that point to data of bluenet can not be deferred, as that data is only valid during the interrupt.
+ */
+static microapp_size_t interruptSize(microapp_sdk_header_t* header) {
+	uint8_t* payload     = reinterpret_cast<uint8_t*>(header);
+	microapp_size_t size = 0;
+	switch (header->messageType) {
 		case CS_MICROAPP_SDK_TYPE_PIN: {
-			microapp_sdk_pin_t* pinInterrupt = reinterpret_cast<microapp_sdk_pin_t*>(interruptHeader);
-			id                            = pinInterrupt->pin;
+			size = sizeof(microapp_sdk_pin_t);
 			break;
 		}
 		case CS_MICROAPP_SDK_TYPE_BLE: {
-			microapp_sdk_ble_t* bleInterrupt = reinterpret_cast<microapp_sdk_ble_t*>(interruptHeader);
-			id                            = bleInterrupt->type;
+			auto ble = reinterpret_cast<microapp_sdk_ble_t*>(payload);
+			if (ble->type == CS_MICROAPP_SDK_BLE_SCAN && ble->scan.type == CS_MICROAPP_SDK_BLE_SCAN_EVENT_SCAN) {
+				size = (ble->scan.eventScan.data - payload) + ble->scan.eventScan.size;
+				break;
+			}
+			if (ble->type == CS_MICROAPP_SDK_BLE_CENTRAL && (ble->central.type == CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_READ ||
+				ble->central.type == CS_MICROAPP_SDK_BLE_CENTRAL_EVENT_NOTIFICATION)) {
+				return 0;
+			}
+			size = sizeof(microapp_sdk_ble_t);
 			break;
 		}
 		case CS_MICROAPP_SDK_TYPE_MESH: {
-			microapp_sdk_mesh_t* meshInterrupt = reinterpret_cast<microapp_sdk_mesh_t*>(interruptHeader);
-			id                              = meshInterrupt->type;
+			auto mesh = reinterpret_cast<microapp_sdk_mesh_t*>(payload);
+			size      = (mesh->data - payload) + mesh->size;
 			break;
 		}
 		case CS_MICROAPP_SDK_TYPE_MESSAGE: {
-			auto messageInterrupt = reinterpret_cast<microapp_sdk_message_t*>(interruptHeader);
-			id                    = messageInterrupt->type;
+			auto message = reinterpret_cast<microapp_sdk_message_t*>(payload);
+			size         = (message->receivedMessage.data - payload) + message->receivedMessage.size;
 			break;
 		}
 		case CS_MICROAPP_SDK_TYPE_BLUENET_EVENT: {
-			auto eventInterrupt = reinterpret_cast<microapp_sdk_bluenet_event_t*>(interruptHeader);
-			id                  = eventInterrupt->type;
+			auto event = reinterpret_cast<microapp_sdk_bluenet_event_t*>(payload);
+			size       = (event->event.data - payload) + event->event.size;
 			break;
 		}
 		default: {
-			return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+			return 0;
 		}
 	}
-	// Call the interrupt
-	MicroappSdkType type = (MicroappSdkType)interruptHeader->messageType;
-	return callInterrupt(type, id, interruptHeader);
+	// The size has to fit in the size byte of an entry
+	if (size > 0xFF || size > MICROAPP_SDK_MAX_PAYLOAD) {
+		return 0;
+	}
+	return size;
+}
+
+/*
+ * Copy an interrupt to the queue, and set its ack, if interrupts of its type are deferred.
+ *
+ * @return true if the interrupt has been handled, either queued or dropped.
+ * @return false if the interrupt should be handled right away.
+ */
+static bool queueInterrupt(microapp_sdk_header_t* header) {
+	uint8_t type = header->messageType;
+	if (type >= MAX_INTERRUPT_TYPES || interruptQueue.quota[type] == 0) {
+		return false;
+	}
+	microapp_size_t size = interruptSize(header);
+	if (size == 0) {
+		return false;
+	}
+	interrupt_queue_t& queue   = interruptQueue;
+	microapp_size_t entrySize  = 1 + size;
+	microapp_size_t spaceToEnd = INTERRUPT_QUEUE_SIZE - queue.tail;
+	microapp_size_t skip       = (entrySize > spaceToEnd) ? spaceToEnd : 0;
+	if (queue.count[type] >= queue.quota[type] || queue.used + skip + entrySize > INTERRUPT_QUEUE_SIZE) {
+		queue.dropped[type]++;
+		header->ack = CS_MICROAPP_SDK_ACK_ERR_NO_SPACE;
+		return true;
+	}
+	if (skip > 0) {
+		queue.buffer[queue.tail] = 0;
+		queue.used += skip;
+		queue.tail = 0;
+	}
+	queue.buffer[queue.tail] = size;
+	memcpy(&queue.buffer[queue.tail + 1], header, size);
+	queue.tail = (queue.tail + entrySize) % INTERRUPT_QUEUE_SIZE;
+	queue.used += entrySize;
+	queue.count[type]++;
+	header->ack = CS_MICROAPP_SDK_ACK_SUCCESS;
+	return true;
+}
+
+microapp_sdk_result_t deferInterrupts(MicroappSdkType type, uint8_t quota) {
+	if (type >= MAX_INTERRUPT_TYPES) {
+		return CS_MICROAPP_SDK_ACK_ERR_UNDEFINED;
+	}
+	interruptQueue.quota[type] = quota;
+	return CS_MICROAPP_SDK_ACK_SUCCESS;
+}
+
+microapp_size_t drainInterrupts() {
+	interrupt_queue_t& queue = interruptQueue;
+	if (queue.draining || emptySlotsInStack() != MAX_INTERRUPT_DEPTH) {
+		return 0;
+	}
+	queue.draining = true;
+	// Only handle the interrupts that are queued now, so that a flood of new ones can not keep this busy forever
+	microapp_size_t total = 0;
+	for (uint8_t type = 0; type < MAX_INTERRUPT_TYPES; ++type) {
+		total += queue.count[type];
+	}
+	microapp_size_t handled = 0;
+	for (; handled < total; ++handled) {
+		if (queue.buffer[queue.head] == 0) {
+			// Skipped bytes at the end of the buffer
+			queue.used -= INTERRUPT_QUEUE_SIZE - queue.head;
+			queue.head = 0;
+		}
+		microapp_size_t entrySize     = 1 + queue.buffer[queue.head];
+		microapp_sdk_header_t* header = reinterpret_cast<microapp_sdk_header_t*>(&queue.buffer[queue.head + 1]);
+		uint8_t type                  = header->messageType;
+		// The entry stays in the queue until the handler returns, new interrupts are queued after it
+#ifdef MICROAPP_PROFILING
+		uint32_t start = profilerTicks();
+#endif
+		handleInterrupt(header);
+#ifdef MICROAPP_PROFILING
+		profilerRecord(PROFILER_INTERRUPT, type, start);
+#endif
+		queue.count[type]--;
+		queue.head = (queue.head + entrySize) % INTERRUPT_QUEUE_SIZE;
+		queue.used -= entrySize;
+	}
+	queue.draining = false;
+	return handled;
+}
+
+uint8_t queuedInterruptCount(MicroappSdkType type) {
+	if (type >= MAX_INTERRUPT_TYPES) {
+		return 0;
+	}
+	return interruptQueue.count[type];
+}
+
+uint32_t droppedInterruptCount(MicroappSdkType type) {
+	if (type >= MAX_INTERRUPT_TYPES) {
+		return 0;
+	}
+	return interruptQueue.dropped[type];
+}
+#else
+microapp_sdk_result_t deferInterrupts(MicroappSdkType type, uint8_t quota) {
+	return CS_MICROAPP_SDK_ACK_ERR_NOT_IMPLEMENTED;
+}
+
+microapp_size_t drainInterrupts() {
+	return 0;
+}
+
+uint8_t queuedInterruptCount(MicroappSdkType type) {
+	return 0;
+}
+
+uint32_t droppedInterruptCount(MicroappSdkType type) {
+	return 0;
 }
+#endif
@@ -0,0 +1,58 @@
+#include <microapp.h>
+
+// The stack grows down from __StackTop to __StackLimit, as defined in the linker script.
+// At startup, the part below the stack pointer is painted with STACK_PAINT_PATTERN (see startup.S). The peak usage is
+// found by looking for the lowest word that no longer has the pattern.
+
+#if defined(__arm__)
+extern uint32_t __StackTop;
+extern uint32_t __StackLimit;
+
+static inline uintptr_t stackTop() {
+	return (uintptr_t)&__StackTop;
+}
+
+static inline uintptr_t stackLimit() {
+	return (uintptr_t)&__StackLimit;
+}
+
+static inline uintptr_t stackPointer() {
+	uintptr_t sp;
+	asm volatile("mov %0, sp" : "=r"(sp));
+	return sp;
+}
+#else
+// There is no painted stack on the host
+static inline uintptr_t stackTop() {
+	return 0;
+}
+
+static inline uintptr_t stackLimit() {
+	return 0;
+}
+
+static inline uintptr_t stackPointer() {
+	return 0;
+}
+#endif
+
+microapp_size_t stackSize() {
+	return stackTop() - stackLimit();
+}
+
+microapp_size_t stackFree() {
+	uintptr_t sp = stackPointer();
+	if (sp <= stackLimit()) {
+		return 0;
+	}
+	return sp - stackLimit();
+}
+
+microapp_size_t stackPeakUsage() {
+	const uint32_t* word = (const uint32_t*)stackLimit();
+	const uint32_t* top  = (const uint32_t*)stackTop();
+	while (word < top && *word == STACK_PAINT_PATTERN) {
+		word++;
+	}
+	return (uintptr_t)top - (uintptr_t)word;
+}